@@ -33,11 +33,25 @@ typedef enum {
  */
 typedef enum { GSSK_METHOD_EULER, GSSK_METHOD_RK4 } GSSK_Method;
 
+/**
+ * @brief Scale on which a calibrated k is searched.
+ */
+typedef enum {
+  GSSK_SCALE_LINEAR, /**< Uniform over [min, max] */
+  GSSK_SCALE_LOG     /**< Uniform in log k (min > 0), for rates spanning
+                          orders of magnitude */
+} GSSK_ParamScale;
+
 /**
  * @brief Opaque handle to a GSSK instance.
  */
 typedef struct GSSK_Instance GSSK_Instance;
 
+/**
+ * @brief Opaque handle to reusable scratch memory (see GSSK_WorkspaceCreate).
+ */
+typedef struct GSSK_Workspace GSSK_Workspace;
+
 /**
  * @brief Error codes returned by the kernel.
  */
@@ -47,7 +61,10 @@ typedef enum {
   GSSK_ERR_MALLOC_FAILED,
   GSSK_ERR_SCHEMA_VIOLATION,
   GSSK_ERR_DIVERGENCE, /**< Numerical instability detected (NaN/Inf) */
-  GSSK_ERR_UNKNOWN
+  GSSK_ERR_UNKNOWN,
+  GSSK_ERR_NOT_CONVERGED, /**< Budget exhausted before reaching tolerance */
+  GSSK_ERR_CANCELLED /**< Stopped by a GSSK_Control block; partial results
+                          were kept */
 } GSSK_Status;
 
 /**
@@ -63,6 +80,19 @@ typedef enum {
  */
 GSSK_Status GSSK_Init(const char *json_data, GSSK_Instance **out_inst);
 
+/**
+ * @brief Create an independent deep copy of an instance.
+ *
+ * The copy shares nothing with the source (topology, parameters, initial
+ * values and current state are duplicated), so it can be stepped on another
+ * thread. The caller must call GSSK_Free on the copy.
+ *
+ * @param src Instance to copy.
+ * @param out_inst Receives the new instance, or NULL on failure.
+ * @return GSSK_Status GSSK_SUCCESS or GSSK_ERR_MALLOC_FAILED.
+ */
+GSSK_Status GSSK_Clone(GSSK_Instance *src, GSSK_Instance **out_inst);
+
 /**
  * @brief Get a detailed error description from the last operation.
  *
@@ -160,6 +190,31 @@ double GSSK_GetEdgeK(GSSK_Instance *inst, size_t index);
  */
 void GSSK_SetEdgeK(GSSK_Instance *inst, size_t index, double k);
 
+/**
+ * @brief Get the calibration range of an edge's k (params.calibrate in the
+ *        model JSON).
+ *
+ * @param inst Pointer to the GSSK instance.
+ * @param index Edge index.
+ * @param k_min Receives the lower bound (may be NULL).
+ * @param k_max Receives the upper bound (may be NULL).
+ * @param scale Receives the search scale (may be NULL).
+ * @return bool true if the edge is marked calibratable.
+ */
+bool GSSK_GetEdgeCalibration(GSSK_Instance *inst, size_t index, double *k_min,
+                             double *k_max, GSSK_ParamScale *scale);
+
+/**
+ * @brief Get the initial value of a node (as loaded from the model 'value').
+ */
+double GSSK_GetInitialValue(GSSK_Instance *inst, size_t index);
+
+/**
+ * @brief Set the initial value of a node. Takes effect on the next
+ *        GSSK_Reset.
+ */
+void GSSK_SetInitialValue(GSSK_Instance *inst, size_t index, double value);
+
 /**
  * @brief Single observation point for calibration.
  */
@@ -186,6 +241,12 @@ typedef struct {
   double *mean_envelope; /**< Size: node_count * step_count */
   size_t node_count;
   size_t step_count;
+  double *lower_band; /**< Lower quantile band, NULL unless requested */
+  double *upper_band; /**< Upper quantile band, NULL unless requested */
+  size_t runs;        /**< Number of members accumulated */
+  double *std_envelope; /**< Standard deviation, NULL unless provided */
+  double *covariance;   /**< Per-step node covariance, step_count *
+                             node_count * node_count, NULL unless requested */
 } GSSK_EnsembleResult;
 
 /**
@@ -199,14 +260,860 @@ typedef struct {
 GSSK_EnsembleResult *GSSK_EnsembleForecast(GSSK_Instance *inst, size_t runs,
                                            double perturbation);
 
+/**
+ * @brief Strategies for drawing ensemble perturbations.
+ */
+typedef enum {
+  GSSK_SAMPLING_RANDOM, /**< Independent pseudo-random draws (Monte Carlo) */
+  GSSK_SAMPLING_LHS,    /**< Latin hypercube design over the parameters */
+  GSSK_SAMPLING_SOBOL   /**< Scrambled Sobol low-discrepancy sequence */
+} GSSK_Sampling;
+
+/**
+ * @brief Distribution of the multiplicative perturbation factor.
+ */
+typedef enum {
+  GSSK_DIST_UNIFORM,  /**< Factor uniform in [1 - p, 1 + p] */
+  GSSK_DIST_NORMAL,   /**< Factor ~ N(1, p^2), truncated at 0 */
+  GSSK_DIST_LOGNORMAL /**< Factor = exp(p * Z - p^2 / 2), unit mean */
+} GSSK_Distribution;
+
+/**
+ * @brief Create a workspace for repeated ensemble and calibration calls.
+ *
+ * Calls given a workspace (through their options) take all scratch memory
+ * from it instead of the heap and hand it back when they return; only
+ * results are allocated separately. Its first block is sized from the
+ * model and it grows to the largest request seen, so repeating a call with
+ * the same options performs no scratch allocation at all. A workspace
+ * serves one call at a time; ensemble sessions created on one must be freed
+ * in reverse order of creation.
+ *
+ * @param inst Model used to size the initial block (may be NULL).
+ * @return GSSK_Workspace* New workspace, or NULL on allocation failure.
+ */
+GSSK_Workspace *GSSK_WorkspaceCreate(GSSK_Instance *inst);
+
+/**
+ * @brief Free a workspace and all its memory.
+ */
+void GSSK_WorkspaceFree(GSSK_Workspace *ws);
+
+/**
+ * @brief Snapshot of a long-running call, passed to its progress callback.
+ */
+typedef struct {
+  size_t done;          /**< Fitness evaluations (calibration) or members
+                             (ensembles) completed */
+  size_t total;         /**< Evaluations or members planned */
+  double elapsed;       /**< Wall-clock seconds since the call started */
+  double best_fitness;  /**< Best mean squared error so far; NAN for
+                             ensembles */
+  const double *best_k; /**< k of every edge at best_fitness, valid during
+                             the callback only; NULL for ensembles */
+} GSSK_Progress;
+
+typedef void (*GSSK_ProgressCallback)(const GSSK_Progress *progress,
+                                      void *user_data);
+
+/**
+ * @brief Progress reporting, cancellation and time budget for a
+ *        long-running call (ensembles and GSSK_CalibrateEx).
+ *
+ * The cancel flag and the clock are polled between blocks of work, so a
+ * call winds down within one block of being asked to. It keeps what it
+ * has: calibrators apply the best k's found and return
+ * GSSK_ERR_CANCELLED, ensembles return the envelopes of the members
+ * completed (result->runs tells how many).
+ */
+typedef struct {
+  GSSK_ProgressCallback progress; /**< Called on the calling thread, NULL
+                                       for none */
+  void *user_data;                /**< Passed to 'progress' */
+  size_t progress_interval;       /**< Evaluations or members between
+                                       callbacks, 0 for every generation
+                                       or member */
+  const volatile int *cancel;     /**< Stop once *cancel is nonzero, NULL
+                                       for no flag */
+  double time_budget;             /**< Wall-clock seconds, 0 for no
+                                       limit */
+} GSSK_Control;
+
+/**
+ * @brief Options for GSSK_EnsembleForecastEx.
+ *
+ * Initialize with GSSK_InitEnsembleOptions before overriding fields.
+ */
+typedef struct {
+  size_t runs;                    /**< Number of ensemble members */
+  GSSK_Sampling sampling;         /**< Design used to draw the members */
+  GSSK_Distribution distribution; /**< Shape of each perturbation factor */
+  double perturbation;            /**< Spread 'p' applied to every edge k */
+  double value_perturbation;      /**< Spread applied to initial node values
+                                       (0 disables) */
+  unsigned int seed;              /**< Sampler seed, 0 draws one from rand() */
+  bool antithetic;                /**< Pair every member with its mirrored
+                                       draw (u -> 1 - u); runs is rounded
+                                       up to an even number */
+  double band_quantile;           /**< Tail probability q of the quantile
+                                       bands [q, 1 - q], e.g. 0.05 for a 90%
+                                       band. 0 disables bands */
+  GSSK_Workspace *workspace;      /**< Scratch memory source, NULL to use
+                                       the heap */
+  const GSSK_Control *control;    /**< Progress and cancellation, NULL for
+                                       none */
+} GSSK_EnsembleOptions;
+
+/**
+ * @brief Fill an options block with the defaults used by
+ *        GSSK_EnsembleForecast (random uniform sampling of edge k only).
+ */
+void GSSK_InitEnsembleOptions(GSSK_EnsembleOptions *opts);
+
+/**
+ * @brief Run ensemble forecasting with an explicit sampling design.
+ *
+ * Quasi-random designs (LHS, Sobol) cover the perturbation space evenly and
+ * reach a given envelope accuracy with far fewer members than plain random
+ * sampling. The instance parameters are restored before returning.
+ *
+ * @param inst Base model instance.
+ * @param opts Ensemble options.
+ * @return GSSK_EnsembleResult* Result containing the envelopes, or NULL on
+ *         invalid input, allocation failure or cancellation before the
+ *         first member. Caller must free.
+ */
+GSSK_EnsembleResult *GSSK_EnsembleForecastEx(GSSK_Instance *inst,
+                                             const GSSK_EnsembleOptions *opts);
+
 /**
  * @brief Free ensemble results.
  */
 void GSSK_FreeEnsembleResult(GSSK_EnsembleResult *res);
 
+/**
+ * @brief Opaque handle to an incrementally extendable ensemble.
+ *
+ * A session keeps its running accumulators (min, max, moments and streaming
+ * quantile markers), so members can be added later without rerunning the
+ * ones already simulated.
+ */
+typedef struct GSSK_EnsembleSession GSSK_EnsembleSession;
+
+/**
+ * @brief Create an ensemble session.
+ *
+ * @param inst Base model instance. Must outlive the session; its parameters
+ *        are snapshotted now and restored after every batch.
+ * @param opts Ensemble options. opts->runs is the batch size used by
+ *        GSSK_EnsembleSessionRunUntilConverged (and the LHS replicate size).
+ * @return GSSK_EnsembleSession* New session, or NULL on invalid input or
+ *         allocation failure.
+ */
+GSSK_EnsembleSession *GSSK_EnsembleSessionCreate(
+    GSSK_Instance *inst, const GSSK_EnsembleOptions *opts);
+
+/**
+ * @brief Simulate and accumulate additional members.
+ *
+ * @return GSSK_Status GSSK_ERR_CANCELLED if the options' control block
+ *         stopped the batch; the members completed are kept.
+ */
+GSSK_Status GSSK_EnsembleSessionAdd(GSSK_EnsembleSession *session,
+                                    size_t members);
+
+/**
+ * @brief Add batches until the estimate converges or a budget runs out.
+ *
+ * Converged means the standard error of the mean, and the change of the
+ * quantile bands over the last batch, are within tolerance relative to each
+ * node's peak mean magnitude.
+ *
+ * @param session Ensemble session.
+ * @param tolerance Relative tolerance (e.g. 0.01).
+ * @param max_members Member cap, 0 for no cap.
+ * @param time_budget Wall-clock budget in seconds, 0 for no limit.
+ * @param out_error Optional, receives the final convergence measure.
+ * @return GSSK_Status GSSK_SUCCESS when converged, GSSK_ERR_NOT_CONVERGED
+ *         when a budget was exhausted first.
+ */
+GSSK_Status GSSK_EnsembleSessionRunUntilConverged(
+    GSSK_EnsembleSession *session, double tolerance, size_t max_members,
+    double time_budget, double *out_error);
+
+/**
+ * @brief Number of members accumulated so far.
+ */
+size_t GSSK_EnsembleSessionGetMembers(GSSK_EnsembleSession *session);
+
+/**
+ * @brief Snapshot the current envelopes. Caller must free the result.
+ */
+GSSK_EnsembleResult *GSSK_EnsembleSessionGetResult(
+    GSSK_EnsembleSession *session);
+
+/**
+ * @brief Free an ensemble session.
+ */
+void GSSK_EnsembleSessionFree(GSSK_EnsembleSession *session);
+
+/**
+ * @brief Result of a paired scenario comparison.
+ */
+typedef struct {
+  double *mean_delta;   /**< Mean of (scenario - baseline),
+                             size: node_count * step_count */
+  double *stderr_delta; /**< Standard error of mean_delta */
+  size_t node_count;
+  size_t step_count;
+  double variance_reduction; /**< Variance of the delta estimate with
+                                  independent draws per scenario divided by
+                                  the variance achieved, pooled over cells */
+} GSSK_ScenarioDelta;
+
+/**
+ * @brief Compare two scenarios using common random numbers.
+ *
+ * Every ensemble member applies the same perturbation draw to both
+ * instances, so the sampling noise shared by the scenarios cancels in the
+ * delta. Combine with opts->antithetic for a further reduction. Both
+ * instances must share node count, edge count and time grid.
+ *
+ * @param baseline Reference scenario.
+ * @param scenario Alternative scenario.
+ * @param opts Ensemble options (at least two independent members).
+ * @return GSSK_ScenarioDelta* Delta statistics, or NULL on invalid input or
+ *         allocation failure. Caller must free.
+ */
+GSSK_ScenarioDelta *GSSK_EnsembleCompare(GSSK_Instance *baseline,
+                                         GSSK_Instance *scenario,
+                                         const GSSK_EnsembleOptions *opts);
+
+/**
+ * @brief Free scenario comparison results.
+ */
+void GSSK_FreeScenarioDelta(GSSK_ScenarioDelta *res);
+
+/**
+ * @brief Options for GSSK_EnKFCreate.
+ *
+ * Initialize with GSSK_InitEnKFOptions before overriding fields.
+ */
+typedef struct {
+  GSSK_EnsembleOptions ensemble; /**< Members (runs) and the prior spread
+                                      of their k's and initial values.
+                                      band_quantile, workspace and control
+                                      are not used */
+  bool estimate_k;           /**< Augment the state with edge k's, so the
+                                  updates correct them too */
+  const size_t *edges;       /**< Edges whose k's are estimated, NULL for
+                                  all */
+  size_t param_count;        /**< Length of 'edges' (ignored when NULL) */
+  double obs_error;          /**< Absolute standard deviation of the
+                                  observation noise */
+  double obs_relative_error; /**< Further standard deviation, as a fraction
+                                  of each observed value */
+  double inflation;          /**< Factor applied to the forecast spread
+                                  before each update, 1 for none */
+  size_t threads;            /**< Worker threads, 0 for all cores */
+} GSSK_EnKFOptions;
+
+/**
+ * @brief Fill an options block with defaults (100 random members, k and
+ *        initial values uniform +/- 10%, states only, 5% observation
+ *        error, no inflation).
+ */
+void GSSK_InitEnKFOptions(GSSK_EnKFOptions *opts);
+
+/**
+ * @brief Opaque handle to an ensemble Kalman filter.
+ *
+ * The filter keeps every member's state (and estimated k's) at its current
+ * time, so observations can be assimilated as they arrive instead of
+ * recalibrating from the start.
+ */
+typedef struct GSSK_EnKF GSSK_EnKF;
+
+/**
+ * @brief Create a filter whose members start at the model's t_start.
+ *
+ * @param inst Model instance. Must outlive the filter; its k's and initial
+ *        values are the prior means, and it is not modified.
+ * @param opts Filter options.
+ * @return GSSK_EnKF* New filter, or NULL on invalid input or allocation
+ *         failure.
+ */
+GSSK_EnKF *GSSK_EnKFCreate(GSSK_Instance *inst, const GSSK_EnKFOptions *opts);
+
+/**
+ * @brief Advance every member to time t (rounded to the nearest step).
+ *
+ * The filter is not bounded by the model's t_end.
+ *
+ * @return GSSK_Status GSSK_ERR_UNKNOWN if t lies before the filter time,
+ *         GSSK_ERR_DIVERGENCE if a member blew up.
+ */
+GSSK_Status GSSK_EnKFAdvance(GSSK_EnKF *filter, double t);
+
+/**
+ * @brief Assimilate a batch of observations.
+ *
+ * Observations are grouped by output step. For each step in turn the
+ * members are advanced to it and updated together on every observation at
+ * that step (stochastic EnKF with perturbed observations), in parallel
+ * over blocks of members. States are clamped at zero as in GSSK_Step, and
+ * estimated k's likewise.
+ *
+ * @param filter Filter.
+ * @param obs Observations per node; their times must not lie before the
+ *        filter time.
+ * @param obs_count Number of entries in 'obs'.
+ * @return GSSK_Status GSSK_ERR_UNKNOWN for an unknown node or an
+ *         observation in the past (nothing is assimilated then), or for a
+ *         step without ensemble spread or observation error;
+ *         GSSK_ERR_DIVERGENCE if a member blew up. The steps before a
+ *         failing one stay assimilated.
+ */
+GSSK_Status GSSK_EnKFAssimilate(GSSK_EnKF *filter,
+                                const GSSK_NodeObservations *obs,
+                                size_t obs_count);
+
+/**
+ * @brief Current filter time.
+ */
+double GSSK_EnKFGetTime(GSSK_EnKF *filter);
+
+/**
+ * @brief Ensemble mean and standard deviation of every node's state.
+ *
+ * @param filter Filter.
+ * @param mean Receives node_count values.
+ * @param sd Receives node_count values, may be NULL.
+ */
+void GSSK_EnKFGetState(GSSK_EnKF *filter, double *mean, double *sd);
+
+/**
+ * @brief Ensemble mean and standard deviation of every edge k.
+ *
+ * @param filter Filter.
+ * @param mean Receives edge_count values.
+ * @param sd Receives edge_count values, may be NULL.
+ */
+void GSSK_EnKFGetK(GSSK_EnKF *filter, double *mean, double *sd);
+
+/**
+ * @brief Free a filter.
+ */
+void GSSK_EnKFFree(GSSK_EnKF *filter);
+
+/**
+ * @brief Options for GSSK_UnscentedForecast.
+ *
+ * Initialize with GSSK_InitUnscentedOptions before overriding fields.
+ */
+typedef struct {
+  const size_t *edges;  /**< Indices of the perturbed edge k's, NULL for all */
+  size_t param_count;   /**< Length of 'edges' (ignored when NULL) */
+  GSSK_Distribution distribution; /**< Perturbation distribution of each k */
+  double perturbation;  /**< Spread of each k factor, as for ensembles */
+  double alpha;         /**< Sigma-point spread (scaled UT), > 0 */
+  double beta;          /**< Prior knowledge of the distribution (2 is
+                             optimal for Gaussian parameters) */
+  double kappa;         /**< Secondary scaling parameter */
+  double sigma_scale;   /**< Envelope half-width in standard deviations */
+  bool covariance;      /**< Also return the per-step node covariance */
+  size_t threads;       /**< Worker threads, 0 for all cores */
+} GSSK_UnscentedOptions;
+
+/**
+ * @brief Fill an options block with defaults (all edges, uniform +/- 10%,
+ *        alpha = 1, beta = 0, kappa = 0, mean +/- 1 sigma envelopes).
+ */
+void GSSK_InitUnscentedOptions(GSSK_UnscentedOptions *opts);
+
+/**
+ * @brief Sigma-point (unscented transform) uncertainty propagation.
+ *
+ * Integrates 2p + 1 sigma points over the p perturbed edge coefficients in
+ * one parallel batch and reconstructs the mean and variance per node and
+ * output step. min/max_envelope hold mean -/+ sigma_scale standard
+ * deviations, std_envelope the standard deviation.
+ *
+ * @param inst Base model instance (left unchanged).
+ * @param opts Unscented transform options.
+ * @return GSSK_EnsembleResult* Result, or NULL on invalid input or
+ *         allocation failure. Caller must free with GSSK_FreeEnsembleResult.
+ */
+GSSK_EnsembleResult *GSSK_UnscentedForecast(GSSK_Instance *inst,
+                                            const GSSK_UnscentedOptions *opts);
+
+/**
+ * @brief Options for GSSK_IntervalForecast.
+ *
+ * Initialize with GSSK_InitIntervalOptions before overriding fields.
+ */
+typedef struct {
+  const size_t *edges;   /**< Indices of the uncertain edge k's, NULL for all */
+  size_t param_count;    /**< Length of 'edges' (ignored when NULL) */
+  double perturbation;   /**< Each k ranges over [k(1 - p), k(1 + p)] */
+  const double *k_lower; /**< Optional explicit lower bounds, one per
+                              uncertain edge (overrides perturbation) */
+  const double *k_upper; /**< Optional explicit upper bounds, likewise */
+} GSSK_IntervalOptions;
+
+/**
+ * @brief Fill an options block with defaults (all edges, +/- 10%).
+ */
+void GSSK_InitIntervalOptions(GSSK_IntervalOptions *opts);
+
+/**
+ * @brief Guaranteed trajectory bounds for interval-valued coefficients.
+ *
+ * Integrates a lower/upper bounding system in a single pass instead of
+ * sampling. Each flow primitive is k times a factor that is monotone in the
+ * node quantities, so the flow over a box of states is enclosed by interval
+ * arithmetic, and each bound advances with the extreme net flow on its own
+ * face of the box. The resulting min/max_envelope enclose every trajectory
+ * whose k's lie in the given intervals (up to the integrator's own
+ * truncation error; with Euler, dt must be small enough that no outflow
+ * empties a node in one step). mean_envelope holds the nominal trajectory
+ * and runs is 0. Bounds widen over time for strongly coupled models.
+ *
+ * @param inst Model instance (its state is reset).
+ * @param opts Interval options.
+ * @return GSSK_EnsembleResult* Result, or NULL on invalid input, divergence
+ *         of the bounds, or allocation failure. Caller must free with
+ *         GSSK_FreeEnsembleResult.
+ */
+GSSK_EnsembleResult *GSSK_IntervalForecast(GSSK_Instance *inst,
+                                           const GSSK_IntervalOptions *opts);
+
+/**
+ * @brief Options for GSSK_PCEBuild.
+ *
+ * Initialize with GSSK_InitPCEOptions before overriding fields.
+ */
+typedef struct {
+  const size_t *edges;  /**< Indices of the uncertain edge k's, NULL for all */
+  size_t param_count;   /**< Length of 'edges' (ignored when NULL) */
+  GSSK_Distribution distribution; /**< Uniform uses a Legendre basis, normal
+                                       and lognormal a Hermite basis */
+  double perturbation;  /**< Spread of each k factor, as for ensembles */
+  unsigned int order;   /**< Maximum total polynomial degree */
+  double q_norm;        /**< Hyperbolic truncation in (0, 1]; values below 1
+                             drop high-order interaction terms */
+  size_t samples;       /**< Collocation runs, 0 for twice the basis size */
+  unsigned int seed;    /**< Seed of the scrambled Sobol collocation design */
+  size_t threads;       /**< Worker threads, 0 for all cores */
+} GSSK_PCEOptions;
+
+/**
+ * @brief Polynomial chaos surrogate of every node trajectory.
+ *
+ * Each output cell (step * node_count + node) is expanded on an orthonormal
+ * basis in the germ variables xi, with k_i = nominal_k[i] * factor(xi_i).
+ */
+typedef struct {
+  size_t param_count;
+  size_t term_count;
+  size_t node_count;
+  size_t step_count;
+  unsigned int order;
+  GSSK_Distribution distribution;
+  double perturbation;
+  size_t *edges;             /**< Uncertain edge indices, param_count */
+  double *nominal_k;         /**< Nominal k of each uncertain edge */
+  unsigned int *multi_indices; /**< Degrees per term,
+                                    term_count * param_count */
+  double *coefficients;      /**< cell * term_count + term */
+  double *mean;              /**< Size: node_count * step_count */
+  double *variance;          /**< Size: node_count * step_count */
+  double *sobol_first;       /**< First-order indices,
+                                  cell * param_count + i */
+  double *sobol_total;       /**< Total-effect indices,
+                                  cell * param_count + i */
+} GSSK_PCEResult;
+
+/**
+ * @brief Fill an options block with defaults (all edges, uniform +/- 10%,
+ *        total degree 3).
+ */
+void GSSK_InitPCEOptions(GSSK_PCEOptions *opts);
+
+/**
+ * @brief Fit a non-intrusive polynomial chaos expansion.
+ *
+ * Collocation runs are simulated in parallel on private copies of the
+ * instance and the coefficients are fitted by least squares. Means,
+ * variances and Sobol indices then follow analytically.
+ *
+ * @param inst Base model instance (left unchanged).
+ * @param opts PCE options.
+ * @param out_pce Receives the expansion. Caller must free.
+ * @return GSSK_Status GSSK_ERR_DIVERGENCE if a collocation run blew up.
+ */
+GSSK_Status GSSK_PCEBuild(GSSK_Instance *inst, const GSSK_PCEOptions *opts,
+                          GSSK_PCEResult **out_pce);
+
+/**
+ * @brief Evaluate the surrogate for new parameter values.
+ *
+ * @param pce Fitted expansion.
+ * @param k_values k of each uncertain edge (param_count values).
+ * @param out Receives node_count * step_count values (step-major).
+ */
+GSSK_Status GSSK_PCEEvaluate(const GSSK_PCEResult *pce, const double *k_values,
+                             double *out);
+
+/**
+ * @brief Free a polynomial chaos expansion.
+ */
+void GSSK_FreePCEResult(GSSK_PCEResult *pce);
+
+/**
+ * @brief Trajectory of every node and its derivatives with respect to a
+ *        set of edge coefficients.
+ */
+typedef struct {
+  size_t node_count;
+  size_t step_count;
+  size_t param_count;
+  size_t *edges;        /**< Edge index of each parameter, param_count */
+  double *state;        /**< Size: node_count * step_count (step-major) */
+  double *sensitivity;  /**< dQ/dk: (step * node_count + node) *
+                             param_count + i */
+} GSSK_SensitivityResult;
+
+/**
+ * @brief Forward sensitivity analysis of the model trajectory.
+ *
+ * Integrates the state together with its tangent dQ/dk_i, obtained by
+ * differentiating every step of the configured integrator with the analytic
+ * partials of the flow primitives, so the sensitivities are exact for the
+ * discrete trajectory (the one GSSK_Step produces). A threshold flow is
+ * treated as constant in its origin quantity, and a node held at zero by
+ * the non-negativity clamp has zero sensitivity.
+ *
+ * @param inst Model instance (left unchanged).
+ * @param edges Indices of the edges to differentiate by, NULL for all.
+ * @param param_count Length of 'edges' (ignored when NULL).
+ * @param out_res Receives the result. Caller must free with
+ *        GSSK_FreeSensitivityResult.
+ * @return GSSK_Status GSSK_ERR_DIVERGENCE if the trajectory blew up.
+ */
+GSSK_Status GSSK_Sensitivities(GSSK_Instance *inst, const size_t *edges,
+                               size_t param_count,
+                               GSSK_SensitivityResult **out_res);
+
+/**
+ * @brief Free a sensitivity result.
+ */
+void GSSK_FreeSensitivityResult(GSSK_SensitivityResult *res);
+
+/**
+ * @brief Global sensitivity method used by GSSK_GlobalSensitivities.
+ */
+typedef enum {
+  GSSK_GSA_MORRIS, /**< Elementary effects along one-at-a-time trajectories
+                        (screening, (p + 1) runs per trajectory) */
+  GSSK_GSA_SOBOL   /**< Variance-based first-order and total indices
+                        (Saltelli design with Jansen estimators, (p + 2)
+                        runs per base sample) */
+} GSSK_GSAMethod;
+
+/**
+ * @brief Options for GSSK_GlobalSensitivities.
+ *
+ * Initialize with GSSK_InitGlobalSensitivityOptions before overriding
+ * fields. Every selected k is varied over the perturbation distribution of
+ * the ensembles, k_i = nominal_k[i] * factor(u_i).
+ */
+typedef struct {
+  const size_t *edges;  /**< Indices of the edges to rank, NULL for all */
+  size_t param_count;   /**< Length of 'edges' (ignored when NULL) */
+  const size_t *nodes;  /**< Output node indices, NULL for every node */
+  size_t node_count;    /**< Length of 'nodes' (ignored when NULL) */
+  const double *times;  /**< Output times, NULL for every output step */
+  size_t time_count;    /**< Length of 'times' (ignored when NULL) */
+  GSSK_GSAMethod method;
+  GSSK_Distribution distribution; /**< Shape of each k factor */
+  double perturbation;  /**< Spread of each k factor, as for ensembles */
+  size_t samples;       /**< Morris trajectories, or Sobol base samples */
+  unsigned int levels;  /**< Morris grid levels, even and at least 2 */
+  size_t bootstrap;     /**< Bootstrap resamples for the confidence
+                             intervals, 0 for none */
+  double confidence;    /**< Confidence level of the intervals, in (0, 1) */
+  unsigned int seed;    /**< Design and bootstrap seed, 0 draws one from
+                             rand() */
+  size_t threads;       /**< Worker threads, 0 for all cores */
+} GSSK_GlobalSensitivityOptions;
+
+/**
+ * @brief Global sensitivity of selected outputs to a set of edge k's.
+ *
+ * Index arrays are laid out (time * output_count + output) * param_count
+ * + i. Arrays of the other method, and the interval bounds without
+ * bootstrap, are NULL.
+ */
+typedef struct {
+  GSSK_GSAMethod method;
+  size_t param_count;
+  size_t output_count;  /**< Output nodes */
+  size_t time_count;    /**< Output times */
+  size_t *edges;        /**< Edge of each parameter, param_count */
+  size_t *nodes;        /**< Node of each output, output_count */
+  double *times;        /**< Time of each output step, time_count */
+  size_t evaluations;   /**< Simulations run */
+  double *peak;         /**< Largest mu_star (Morris) or total index
+                             (Sobol) of each parameter over all outputs,
+                             param_count */
+  double *mu_star;      /**< Morris: mean absolute elementary effect */
+  double *mu_star_lo;   /**< Morris: confidence interval of mu_star */
+  double *mu_star_hi;
+  double *mu;           /**< Morris: mean elementary effect */
+  double *sigma;        /**< Morris: standard deviation of the effects */
+  double *first;        /**< Sobol: first-order indices */
+  double *first_lo;     /**< Sobol: confidence interval of 'first' */
+  double *first_hi;
+  double *total;        /**< Sobol: total-effect indices */
+  double *total_lo;     /**< Sobol: confidence interval of 'total' */
+  double *total_hi;
+  double *variance;     /**< Sobol: output variance, one per output cell */
+} GSSK_GlobalSensitivityResult;
+
+/**
+ * @brief Fill an options block with defaults (all edges and outputs, Morris
+ *        with 20 trajectories on 4 levels, uniform +/- 10%, 100 bootstrap
+ *        resamples for 95% intervals).
+ */
+void GSSK_InitGlobalSensitivityOptions(GSSK_GlobalSensitivityOptions *opts);
+
+/**
+ * @brief Rank edge k's by their influence on the model outputs.
+ *
+ * Morris screening costs (p + 1) simulations per trajectory and separates
+ * the k's that matter (large mu_star) from those that do not, and flags
+ * nonlinear or interacting ones (large sigma). Elementary effects are taken
+ * in the unit design space, over half its range. Sobol indices apportion
+ * the output variance: 'first' is the share due to k_i alone, 'total'
+ * includes all its interactions, so a total index near zero means the k can
+ * be fixed. The design is simulated in lockstep batches on worker threads;
+ * intervals are percentiles over bootstrap resamples of the trajectories or
+ * base samples. Memory grows with the runs times the selected outputs, so
+ * select nodes and times for large models.
+ *
+ * @param inst Model instance (left unchanged).
+ * @param opts Analysis options.
+ * @param out_res Receives the result. Caller must free with
+ *        GSSK_FreeGlobalSensitivityResult.
+ * @return GSSK_Status GSSK_ERR_DIVERGENCE if a design run blew up,
+ *         GSSK_ERR_UNKNOWN for an invalid edge, node or time.
+ */
+GSSK_Status
+GSSK_GlobalSensitivities(GSSK_Instance *inst,
+                         const GSSK_GlobalSensitivityOptions *opts,
+                         GSSK_GlobalSensitivityResult **out_res);
+
+/**
+ * @brief Free a global sensitivity result.
+ */
+void GSSK_FreeGlobalSensitivityResult(GSSK_GlobalSensitivityResult *res);
+
+/**
+ * @brief Options for GSSK_Gradient.
+ *
+ * Initialize with GSSK_InitGradientOptions before overriding fields.
+ */
+typedef struct {
+  size_t checkpoints;    /**< States kept by the forward pass, 0 for about
+                              sqrt(steps) */
+  GSSK_Workspace *workspace; /**< Scratch memory source, NULL to use the
+                                  heap */
+} GSSK_GradientOptions;
+
+/**
+ * @brief Fill an options block with defaults (sqrt(steps) checkpoints).
+ */
+void GSSK_InitGradientOptions(GSSK_GradientOptions *opts);
+
+/**
+ * @brief Gradient of the calibration objective with respect to every k.
+ *
+ * Computes the mean squared error of the observations (the fitness the
+ * calibrators minimize) and its gradient by a discrete adjoint of the
+ * configured integrator, exact for the simulated trajectory. The forward
+ * pass keeps checkpointed states; the backward sweep recomputes one segment
+ * at a time and pulls the adjoint back through every step, so the cost is
+ * about three simulations whatever the number of edges.
+ *
+ * @param inst Model instance (left unchanged).
+ * @param obs Array of node observations.
+ * @param obs_count Number of nodes with observations.
+ * @param opts Gradient options, NULL for the defaults.
+ * @param objective Receives the mean squared error.
+ * @param gradient Receives d(objective)/dk for every edge (edge count
+ *        values).
+ * @return GSSK_Status GSSK_ERR_DIVERGENCE if the trajectory blew up.
+ */
+GSSK_Status GSSK_Gradient(GSSK_Instance *inst,
+                          const GSSK_NodeObservations *obs, size_t obs_count,
+                          const GSSK_GradientOptions *opts, double *objective,
+                          double *gradient);
+
+/**
+ * @brief Search strategy used by GSSK_CalibrateEx.
+ */
+typedef enum {
+  GSSK_OPTIMIZER_DE,    /**< Differential evolution (F, CR, population) */
+  GSSK_OPTIMIZER_CMAES, /**< CMA-ES with increasing-population restarts */
+  GSSK_OPTIMIZER_SHADE, /**< Success-history adaptive DE with linear
+                             population reduction (L-SHADE) */
+  GSSK_OPTIMIZER_BAYES  /**< Bayesian optimization on a Gaussian process
+                             surrogate, for expensive models */
+} GSSK_Optimizer;
+
+/**
+ * @brief Options for GSSK_CalibrateEx.
+ *
+ * Initialize with GSSK_InitCalibrationOptions before overriding fields.
+ */
+typedef struct {
+  int iterations;        /**< Number of DE generations; every optimizer
+                              gets population * (iterations + 1) fitness
+                              evaluations */
+  size_t population;     /**< DE population size, at least 4 (initial
+                              size for SHADE) */
+  double F;              /**< Differential weight (SHADE: initial history) */
+  double CR;             /**< Crossover probability (SHADE: initial
+                              history) */
+  double k_min;          /**< Lower bound on every k without a calibration
+                              range (trials are clamped) */
+  double k_max;          /**< Upper end of their initial population range */
+  unsigned int seed;     /**< Optimizer seed, 0 draws one from rand() */
+  size_t threads;        /**< Worker threads, 0 for all cores */
+  GSSK_Workspace *workspace; /**< Scratch memory source, NULL to use the
+                                  heap */
+  GSSK_Optimizer optimizer; /**< Search strategy */
+  int restarts;          /**< CMA-ES restarts, each doubling the
+                              population */
+  size_t screen_factor;  /**< Multi-fidelity DE/SHADE: screen trials with
+                              Euler at this multiple of dt before a full
+                              evaluation, 0 or 1 to evaluate every trial */
+  double screen_horizon; /**< Fraction of the horizon screened, (0, 1] */
+  double screen_promote; /**< Fraction of each generation, by screen rank,
+                              evaluated in full even if not predicted to
+                              win, [0, 1] */
+  double screen_correlation; /**< Screen-to-full rank correlation below
+                                  which screening is dropped */
+  size_t cache_size;     /**< Fitness memo entries, 0 to simulate every
+                              candidate; repeats of a remembered vector
+                              are answered without a simulation (not used
+                              by calibration sessions) */
+  double cache_tolerance; /**< Memo key resolution in the optimizer's
+                               coordinates (k, or the fraction of a
+                               calibration range); vectors within it share
+                               a fitness, 0 for exact repeats only */
+  const GSSK_Control *control; /**< Progress and cancellation, NULL for
+                                    none */
+} GSSK_CalibrationOptions;
+
+/**
+ * @brief Summary of a calibration run.
+ *
+ * A model without edges has nothing to calibrate: the calibrators then
+ * return GSSK_SUCCESS with the report zeroed and best_fitness INFINITY.
+ */
+typedef struct {
+  double best_fitness;   /**< Mean squared error of the returned k's */
+  size_t evaluations;    /**< Fitness evaluations performed */
+  size_t generations;    /**< Optimizer generations completed */
+  size_t early_aborts;   /**< Evaluations stopped once rejection was
+                              certain */
+  size_t screened;       /**< Cheap screening evaluations (not counted in
+                              'evaluations') */
+  size_t screen_dropped; /**< Generation in which screening was dropped
+                              for poor rank agreement, 0 if never */
+  size_t cache_hits;     /**< Evaluations answered by the fitness memo
+                              (counted in 'evaluations') */
+} GSSK_CalibrationReport;
+
+/**
+ * @brief Fill an options block with the defaults used by GSSK_Calibrate
+ *        (differential evolution, 100 generations of 20 members, F = 0.8,
+ *        CR = 0.9, k in [0, 10]; up to 9 restarts for CMA-ES; no
+ *        screening or fitness memo).
+ */
+void GSSK_InitCalibrationOptions(GSSK_CalibrationOptions *opts);
+
+/**
+ * @brief Fit edge k's to the observations by differential evolution
+ *        (fixed or self-adaptive), CMA-ES or Bayesian optimization.
+ *
+ * Only the edges the model marks calibratable (params.calibrate) are
+ * fitted, each searched over its own range on a linear or log scale; the
+ * other k's keep their values. A model that marks none has every k fitted
+ * over [k_min, k_max]. Each generation's candidates are evaluated as one
+ * batch, concurrently, each worker thread simulating on a private clone of
+ * the model, and then ranked or selected in member order. The result
+ * depends only on the seed, not on the number of threads. A DE trial whose
+ * partial squared error already rules out replacing its target member is
+ * abandoned early without changing the outcome.
+ *
+ * CMA-ES adapts a full covariance over the normalized search box, which
+ * suits correlated parameters; a run that converges or stalls is restarted
+ * from a random mean with twice the population (IPOP), until the
+ * evaluation budget or opts->restarts is used up.
+ *
+ * SHADE draws F and CR per trial around a history of the values that
+ * produced improvements, mutates towards one of the best members
+ * (current-to-pbest/1, with an archive of replaced members), and shrinks
+ * the population linearly to 4 as the budget is spent.
+ *
+ * With screen_factor > 1, DE and SHADE trials are first scored on a cheap
+ * variant of the model (Euler at screen_factor * dt, over screen_horizon
+ * of the run). Only the trials predicted to beat their target, plus the
+ * screen_promote fraction ranked best, are simulated at full fidelity; the
+ * others are rejected. Once the Spearman correlation between screen and
+ * full scores of the promoted trials falls below screen_correlation,
+ * screening stops and every later trial is evaluated in full. SHADE
+ * charges screens against its budget at their relative cost.
+ *
+ * Bayesian optimization suits models where each simulation is expensive
+ * and the budget is a few hundred evaluations (set population and
+ * iterations accordingly). It starts from a Latin hypercube of 'population'
+ * points, then each generation fits a Gaussian process (Matern 5/2 over a
+ * quadratic trend, length scales by maximum likelihood) to the log misfit
+ * of the best 256 points so far and picks a batch of 'population'
+ * candidates by expected improvement, which are simulated in parallel.
+ * Parameters without a calibration range are searched over [k_min, k_max].
+ * The best k's found are written back to the instance.
+ *
+ * With opts->control, progress is reported between generations once
+ * progress_interval evaluations have passed since the last report; once
+ * cancelled or out of time, workers start no further block of candidates
+ * and the run ends after the current generation.
+ *
+ * @param inst Model instance to calibrate.
+ * @param obs Array of node observations.
+ * @param obs_count Number of nodes with observations.
+ * @param opts Optimizer options.
+ * @param report Optional summary, may be NULL.
+ * @return GSSK_Status Optimization status; GSSK_ERR_CANCELLED if the
+ *         control block stopped the run (the best k's so far are applied
+ *         and the report filled).
+ */
+GSSK_Status GSSK_CalibrateEx(GSSK_Instance *inst,
+                             const GSSK_NodeObservations *obs,
+                             size_t obs_count,
+                             const GSSK_CalibrationOptions *opts,
+                             GSSK_CalibrationReport *report);
+
 /**
  * @brief Run parameter calibration.
  *
+ * Equivalent to GSSK_CalibrateEx with default options and the given number
+ * of iterations.
+ *
  * @param inst Base model instance.
  * @param obs Array of node observations.
  * @param obs_count Number of nodes with observations.
@@ -216,6 +1123,304 @@ void GSSK_FreeEnsembleResult(GSSK_EnsembleResult *res);
 GSSK_Status GSSK_Calibrate(GSSK_Instance *inst, GSSK_NodeObservations *obs,
                            size_t obs_count, int iterations);
 
+/**
+ * @brief One data set for GSSK_CalibrateExperiments: observations of the
+ *        model run from its own initial state.
+ */
+typedef struct {
+  const char *const *node_ids;  /**< Nodes whose initial value differs from
+                                     the model's */
+  const double *initial_values; /**< Initial value of each node_ids entry */
+  size_t override_count;        /**< Length of node_ids and initial_values */
+  const GSSK_NodeObservations *obs; /**< Observations of this experiment */
+  size_t obs_count;             /**< Number of nodes with observations */
+} GSSK_Experiment;
+
+/**
+ * @brief Fit one set of edge k's to several experiments at once.
+ *
+ * As GSSK_CalibrateEx, but each candidate is simulated from every
+ * experiment's initial state and scored on the pooled residuals: the
+ * fitness is the mean squared error over the observations of all
+ * experiments. A generation's candidates and experiments are evaluated as
+ * one batch, concurrently, so calibrating against N experiments costs N
+ * times the simulations of one but not N times the wall time on N cores.
+ * A trial is abandoned as soon as one experiment alone rules it out.
+ * GSSK_CalibrateEx is the case of one experiment without overrides.
+ *
+ * @param inst Model instance to calibrate (its initial values are not
+ *             modified).
+ * @param experiments Array of experiments.
+ * @param experiment_count Number of experiments.
+ * @param opts Optimizer options.
+ * @param report Optional summary, may be NULL.
+ * @return GSSK_Status GSSK_ERR_UNKNOWN for an unknown override node or an
+ *         experiment without observations.
+ */
+GSSK_Status GSSK_CalibrateExperiments(GSSK_Instance *inst,
+                                      const GSSK_Experiment *experiments,
+                                      size_t experiment_count,
+                                      const GSSK_CalibrationOptions *opts,
+                                      GSSK_CalibrationReport *report);
+
+/**
+ * @brief Opaque handle to a calibration that is resumed as observations
+ *        arrive.
+ *
+ * A session keeps its DE population, each member's squared error and its
+ * state at the last observed step, and the best k's, so new observations
+ * can be appended and the optimization continued for a few generations
+ * instead of starting over.
+ */
+typedef struct GSSK_CalibrationSession GSSK_CalibrationSession;
+
+/**
+ * @brief Create a calibration session.
+ *
+ * @param inst Model instance to calibrate. Must outlive the session; its
+ *        non-calibrated k's are snapshotted now, and every run writes the
+ *        best k's found back to it. Observations later than its t_end are
+ *        ignored, so set t_end to cover the data expected.
+ * @param opts Optimizer options; the optimizer must be DE, without
+ *        screening. opts->iterations is not used.
+ * @return GSSK_CalibrationSession* New session, or NULL on invalid input or
+ *         allocation failure.
+ */
+GSSK_CalibrationSession *
+GSSK_CalibrationSessionCreate(GSSK_Instance *inst,
+                              const GSSK_CalibrationOptions *opts);
+
+/**
+ * @brief Append observations (copied), to be fitted from the next run on.
+ *
+ * @return GSSK_Status GSSK_ERR_UNKNOWN for an unknown node id.
+ */
+GSSK_Status
+GSSK_CalibrationSessionAddObservations(GSSK_CalibrationSession *session,
+                                       const GSSK_NodeObservations *obs,
+                                       size_t obs_count);
+
+/**
+ * @brief Continue the calibration for a number of DE generations.
+ *
+ * The first run draws and scores the initial population. After
+ * observations were added, the population is first rescored on all of
+ * them: when the new ones all lie after the previous last observation,
+ * each member resumes from its saved state and only the new time window is
+ * simulated; otherwise the members are simulated again from the start. The
+ * best k's are written back to the instance.
+ *
+ * @param session Calibration session.
+ * @param generations DE generations to run, 0 to only rescore.
+ * @param report Optional summary of this run (evaluations and generations
+ *        of this call only), may be NULL.
+ * @return GSSK_Status GSSK_ERR_UNKNOWN if there are no observations yet,
+ *         GSSK_ERR_CANCELLED if the options' control block stopped the run
+ *         after a generation (the population is kept for the next run).
+ */
+GSSK_Status GSSK_CalibrationSessionRun(GSSK_CalibrationSession *session,
+                                       int generations,
+                                       GSSK_CalibrationReport *report);
+
+/**
+ * @brief Free a calibration session.
+ */
+void GSSK_CalibrationSessionFree(GSSK_CalibrationSession *session);
+
+/**
+ * @brief Options for GSSK_CalibrateLM (Levenberg-Marquardt).
+ *
+ * Initialize with GSSK_InitLMOptions before overriding fields.
+ */
+typedef struct {
+  const size_t *edges;   /**< Indices of the fitted edge k's, NULL for the
+                              model's calibratable edges (all if none) */
+  size_t param_count;    /**< Length of 'edges' (ignored when NULL) */
+  int iterations;        /**< Maximum number of trial steps */
+  double lambda;         /**< Initial damping, > 0 */
+  double tolerance;      /**< Stop when a step lowers the squared error by
+                              less than this fraction, or moves k by less
+                              than this fraction of |k| */
+  double k_min;          /**< Lower bound on fitted k's without a
+                              calibration range */
+  GSSK_Workspace *workspace; /**< Scratch memory source, NULL to use the
+                                  heap */
+} GSSK_LMOptions;
+
+/**
+ * @brief Fill an options block with defaults (all edges, 100 steps,
+ *        lambda = 1e-3, tolerance 1e-10, k >= 0).
+ */
+void GSSK_InitLMOptions(GSSK_LMOptions *opts);
+
+/**
+ * @brief Fit edge k's to the observations by Levenberg-Marquardt.
+ *
+ * A local least-squares method starting from the instance's current k's.
+ * The Jacobian of the residuals comes from forward sensitivities (see
+ * GSSK_Sensitivities), so each iteration costs one augmented integration
+ * instead of one run per parameter. Converges in a few iterations from a
+ * reasonable start, where GSSK_CalibrateEx needs thousands of runs; use
+ * the latter (or its result as a start) when no good guess is available.
+ * Edges with a calibration range are fitted within it, on its scale.
+ * The best k's found are written back to the instance. In the report,
+ * generations counts trial steps and evaluations model integrations.
+ *
+ * @param inst Model instance to calibrate.
+ * @param obs Array of node observations.
+ * @param obs_count Number of nodes with observations.
+ * @param opts Optimizer options.
+ * @param report Optional summary, may be NULL.
+ * @return GSSK_Status GSSK_ERR_NOT_CONVERGED if the iterations ran out
+ *         first, GSSK_ERR_DIVERGENCE if the starting point diverges.
+ */
+GSSK_Status GSSK_CalibrateLM(GSSK_Instance *inst,
+                             const GSSK_NodeObservations *obs,
+                             size_t obs_count, const GSSK_LMOptions *opts,
+                             GSSK_CalibrationReport *report);
+
+/**
+ * @brief Options for GSSK_CalibrateLBFGS.
+ *
+ * Initialize with GSSK_InitLBFGSOptions before overriding fields.
+ */
+typedef struct {
+  const size_t *edges;   /**< Indices of the fitted edge k's, NULL for the
+                              model's calibratable edges (all if none) */
+  size_t param_count;    /**< Length of 'edges' (ignored when NULL) */
+  int iterations;        /**< Maximum number of iterations */
+  size_t memory;         /**< Correction pairs kept, at least 1 */
+  double tolerance;      /**< Stop when a step lowers the squared error by
+                              less than this fraction */
+  double k_min;          /**< Lower bound on fitted k's without a
+                              calibration range */
+  size_t checkpoints;    /**< As GSSK_GradientOptions.checkpoints */
+  GSSK_Workspace *workspace; /**< Scratch memory source, NULL to use the
+                                  heap */
+} GSSK_LBFGSOptions;
+
+/**
+ * @brief Fill an options block with defaults (all edges, 200 steps, 8
+ *        pairs, tolerance 1e-10, k >= 0).
+ */
+void GSSK_InitLBFGSOptions(GSSK_LBFGSOptions *opts);
+
+/**
+ * @brief Fit edge k's to the observations by projected L-BFGS.
+ *
+ * A local method for models with many coefficients, starting from the
+ * instance's current k's. Each gradient comes from the adjoint (see
+ * GSSK_Gradient), so an iteration costs a few simulations however many
+ * k's are fitted. Steps are projected onto the calibration ranges (or
+ * k >= k_min) with a backtracking line search. The best k's found are
+ * written back to the instance. In the report, generations counts
+ * iterations and evaluations gradient computations.
+ *
+ * @param inst Model instance to calibrate.
+ * @param obs Array of node observations.
+ * @param obs_count Number of nodes with observations.
+ * @param opts Optimizer options.
+ * @param report Optional summary, may be NULL.
+ * @return GSSK_Status GSSK_ERR_NOT_CONVERGED if the iterations ran out
+ *         first, GSSK_ERR_DIVERGENCE if the starting point diverges.
+ */
+GSSK_Status GSSK_CalibrateLBFGS(GSSK_Instance *inst,
+                                const GSSK_NodeObservations *obs,
+                                size_t obs_count,
+                                const GSSK_LBFGSOptions *opts,
+                                GSSK_CalibrationReport *report);
+
+/**
+ * @brief Options for GSSK_CalibrateMCMC (parallel tempering).
+ *
+ * Initialize with GSSK_InitMCMCOptions before overriding fields.
+ */
+typedef struct {
+  const size_t *edges;   /**< Indices of the sampled edge k's, NULL for the
+                              model's calibratable edges (all if none) */
+  size_t param_count;    /**< Length of 'edges' (ignored when NULL) */
+  double noise;          /**< Standard deviation of the observation errors,
+                              > 0 */
+  size_t chains;         /**< Tempered chains, at least 1; chain 0 samples
+                              the posterior */
+  double max_temperature; /**< Temperature of the hottest chain, >= 1; the
+                               others are spaced geometrically */
+  size_t burn_in;        /**< Steps per chain before sampling starts */
+  size_t thin;           /**< Steps per stored sample, at least 1 */
+  size_t swap_interval;  /**< Steps between swap rounds, at least 1 */
+  double step;           /**< Initial proposal scale, as a fraction of each
+                              calibration range (or of |k| without one) */
+  double k_min;          /**< Lower bound on sampled k's without a
+                              calibration range */
+  unsigned int seed;     /**< Sampler seed, 0 draws one from rand() */
+  size_t threads;        /**< Worker threads, 0 for all cores */
+  GSSK_Workspace *workspace; /**< Scratch memory source, NULL to use the
+                                  heap */
+} GSSK_MCMCOptions;
+
+/**
+ * @brief Summary of a GSSK_CalibrateMCMC run.
+ *
+ * As for the calibrators, a model without edges has nothing to sample:
+ * GSSK_CalibrateMCMC returns GSSK_SUCCESS without writing samples, with
+ * the report zeroed and best_fitness INFINITY.
+ */
+typedef struct {
+  size_t samples;        /**< Samples written */
+  size_t evaluations;    /**< Likelihood evaluations, all chains */
+  size_t early_aborts;   /**< Evaluations stopped once rejection was
+                              certain */
+  double acceptance;     /**< Move acceptance rate of chain 0 after
+                              burn-in */
+  double swap_rate;      /**< Fraction of proposed swaps accepted */
+  double best_fitness;   /**< Lowest mean squared error visited */
+} GSSK_MCMCReport;
+
+/**
+ * @brief Fill an options block with defaults (all edges, noise 1, 4 chains
+ *        up to temperature 10, 1000 burn-in steps, no thinning, swaps every
+ *        10 steps, step 0.1, k >= 0).
+ */
+void GSSK_InitMCMCOptions(GSSK_MCMCOptions *opts);
+
+/**
+ * @brief Sample the posterior of edge k's given noisy observations by
+ *        parallel-tempering MCMC.
+ *
+ * The likelihood treats each observation as the simulated value plus
+ * Gaussian noise of standard deviation opts->noise, with residuals computed
+ * exactly as for GSSK_CalibrateEx. The prior is flat on each calibration
+ * range, on its scale (so log-uniform on a log range), and flat on
+ * k >= k_min for edges without one.
+ *
+ * Every chain starts from the instance's current k's and runs a Gaussian
+ * random walk on the tempered posterior (likelihood raised to 1 / T), its
+ * proposal scale tuned during burn-in towards a 23% acceptance rate. The
+ * chains advance concurrently, one task per chain on the worker threads,
+ * and every swap_interval steps adjacent chains offer to exchange states,
+ * which lets the cold chain escape local modes. A proposal is abandoned as
+ * soon as its partial squared error rules out acceptance. The samples
+ * depend only on the seed, not on the number of threads.
+ *
+ * After burn-in, every thin-th state of chain 0 is written to 'samples'
+ * as k values, sample_count rows of param_count (the sampled edges in
+ * order). The instance's k's are left unchanged.
+ *
+ * @param inst Model instance.
+ * @param obs Array of node observations.
+ * @param obs_count Number of nodes with observations.
+ * @param opts Sampler options.
+ * @param samples Output, sample_count * param_count k values.
+ * @param sample_count Number of samples to draw.
+ * @param report Optional summary, may be NULL.
+ * @return GSSK_Status GSSK_ERR_DIVERGENCE if the starting point diverges.
+ */
+GSSK_Status GSSK_CalibrateMCMC(GSSK_Instance *inst,
+                               const GSSK_NodeObservations *obs,
+                               size_t obs_count, const GSSK_MCMCOptions *opts,
+                               double *samples, size_t sample_count,
+                               GSSK_MCMCReport *report);
+
 /**
  * @brief Free all memory associated with an instance.
  *
@@ -1,22 +1,10 @@
 #include "gssk.h"
+#include "gssk_internal.h"
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
-// --- Helper Functions ---
-
-static double get_random_double(double min, double max) {
-  return min + ((double)rand() / RAND_MAX) * (max - min);
-}
-
-static double interpolate(double t, double t1, double v1, double t2, double v2) {
-  if (fabs(t2 - t1) < 1e-9)
-    return v1;
-  double alpha = (t - t1) / (t2 - t1);
-  return v1 + alpha * (v2 - v1);
-}
-
 // --- Ensemble Forecasting ---
 
 void GSSK_FreeEnsembleResult(GSSK_EnsembleResult *res) {
@@ -24,21 +12,31 @@ void GSSK_FreeEnsembleResult(GSSK_EnsembleResult *res) {
     free(res->min_envelope);
     free(res->max_envelope);
     free(res->mean_envelope);
+    free(res->lower_band);
+    free(res->upper_band);
+    free(res->std_envelope);
+    free(res->covariance);
     free(res);
   }
 }
 
-GSSK_EnsembleResult *GSSK_EnsembleForecast(GSSK_Instance *inst, size_t runs,
-                                           double perturbation) {
-  if (!inst || runs == 0)
-    return NULL;
-
-  size_t node_count = GSSK_GetStateSize(inst);
-  double t_start = GSSK_GetTStart(inst);
-  double t_end = GSSK_GetTEnd(inst);
-  double dt = GSSK_GetDt(inst);
-  size_t step_count = (size_t)((t_end - t_start) / dt) + 1;
+void GSSK_InitEnsembleOptions(GSSK_EnsembleOptions *opts) {
+  if (!opts)
+    return;
+  opts->runs = 100;
+  opts->sampling = GSSK_SAMPLING_RANDOM;
+  opts->distribution = GSSK_DIST_UNIFORM;
+  opts->perturbation = 0.1;
+  opts->value_perturbation = 0.0;
+  opts->seed = 0;
+  opts->antithetic = false;
+  opts->band_quantile = 0.0;
+  opts->workspace = NULL;
+  opts->control = NULL;
+}
 
+static GSSK_EnsembleResult *alloc_ensemble_result(size_t node_count,
+                                                  size_t step_count) {
   GSSK_EnsembleResult *res = calloc(1, sizeof(GSSK_EnsembleResult));
   if (!res)
     return NULL;
@@ -60,210 +58,1128 @@ GSSK_EnsembleResult *GSSK_EnsembleForecast(GSSK_Instance *inst, size_t runs,
     res->max_envelope[i] = -INFINITY;
     res->mean_envelope[i] = 0.0;
   }
+  return res;
+}
+
+size_t gssk_output_steps(GSSK_Instance *inst) {
+  double t_start = GSSK_GetTStart(inst);
+  double t_end = GSSK_GetTEnd(inst);
+  double dt = GSSK_GetDt(inst);
+  return (size_t)((t_end - t_start) / dt) + 1;
+}
+
+GSSK_Status gssk_simulate_trajectory(GSSK_Instance *inst, size_t step_count,
+                                     double *out) {
+  size_t node_count = GSSK_GetStateSize(inst);
+  double dt = GSSK_GetDt(inst);
+  GSSK_Status status = GSSK_SUCCESS;
+  GSSK_Reset(inst);
+  for (size_t s = 0; s < step_count; s++) {
+    memcpy(&out[s * node_count], GSSK_GetState(inst),
+           node_count * sizeof(double));
+    if (s + 1 < step_count && status == GSSK_SUCCESS)
+      status = GSSK_Step(inst, dt);
+  }
+  return status;
+}
+
+GSSK_Instance **gssk_clone_workers(GSSK_Instance *inst, size_t count) {
+  GSSK_Instance **workers = calloc(count, sizeof(GSSK_Instance *));
+  if (!workers)
+    return NULL;
+  for (size_t w = 0; w < count; w++) {
+    if (GSSK_Clone(inst, &workers[w]) != GSSK_SUCCESS) {
+      gssk_free_workers(workers, count);
+      return NULL;
+    }
+  }
+  return workers;
+}
+
+void gssk_free_workers(GSSK_Instance **workers, size_t count) {
+  if (!workers)
+    return;
+  for (size_t w = 0; w < count; w++)
+    GSSK_Free(workers[w]);
+  free(workers);
+}
+
+// Number of members actually simulated (antithetic runs come in pairs)
+static size_t ensemble_member_count(const GSSK_EnsembleOptions *opts) {
+  if (opts->antithetic)
+    return opts->runs + (opts->runs & 1);
+  return opts->runs;
+}
+
+// Perturbation draws for one ensemble, shared by every instance it is applied
+// to so that scenarios see common random numbers.
+typedef struct {
+  const GSSK_EnsembleOptions *opts;
+  gssk_sampler sampler;
+  size_t edge_count;
+  size_t node_count;
+  bool perturb_values;
+  double *u;
+} EnsembleDraws;
+
+static GSSK_Status draws_init(EnsembleDraws *d, GSSK_Instance *inst,
+                              const GSSK_EnsembleOptions *opts) {
+  memset(d, 0, sizeof(*d));
+  d->opts = opts;
+  d->edge_count = GSSK_GetEdgeCount(inst);
+  d->node_count = GSSK_GetStateSize(inst);
+
+  // Design dimensions: one per edge k, then one per node value if enabled
+  d->perturb_values = opts->value_perturbation > 0.0;
+  size_t dim = d->edge_count + (d->perturb_values ? d->node_count : 0);
+
+  d->u = gssk_ws_alloc(opts->workspace, dim * sizeof(double));
+  if (!d->u)
+    return GSSK_ERR_MALLOC_FAILED;
+
+  uint64_t seed = gssk_resolve_seed(opts->seed);
+
+  size_t designs = ensemble_member_count(opts) / (opts->antithetic ? 2 : 1);
+  GSSK_Status status =
+      gssk_sampler_init(&d->sampler, opts->sampling, dim, designs, seed,
+                        opts->workspace);
+  if (status != GSSK_SUCCESS) {
+    gssk_ws_free(opts->workspace, d->u);
+    d->u = NULL;
+  }
+  return status;
+}
+
+// Advance to member r. Odd members of an antithetic pair reflect the draw of
+// their partner (u -> 1 - u) instead of consuming a new design point.
+static void draws_next(EnsembleDraws *d, size_t r) {
+  size_t dim = d->edge_count + (d->perturb_values ? d->node_count : 0);
+  if (d->opts->antithetic && (r & 1)) {
+    for (size_t j = 0; j < dim; j++)
+      d->u[j] = 1.0 - d->u[j];
+  } else {
+    gssk_sampler_next(&d->sampler, d->u);
+  }
+}
+
+static void draws_apply(const EnsembleDraws *d, GSSK_Instance *inst,
+                        const double *base_ks, const double *base_values) {
+  const GSSK_EnsembleOptions *opts = d->opts;
+  for (size_t i = 0; i < d->edge_count; i++) {
+    double p = gssk_perturbation_factor(opts->distribution, opts->perturbation,
+                                        d->u[i]);
+    GSSK_SetEdgeK(inst, i, base_ks[i] * p);
+  }
+  if (d->perturb_values) {
+    for (size_t n = 0; n < d->node_count; n++) {
+      double p =
+          gssk_perturbation_factor(opts->distribution, opts->value_perturbation,
+                                   d->u[d->edge_count + n]);
+      GSSK_SetInitialValue(inst, n, base_values[n] * p);
+    }
+  }
+}
+
+static void draws_free(EnsembleDraws *d) {
+  gssk_sampler_free(&d->sampler);
+  gssk_ws_free(d->opts->workspace, d->u);
+  d->u = NULL;
+}
+
+// Snapshot of the parameters an ensemble perturbs
+typedef struct {
+  double *ks;
+  double *values;
+  GSSK_Workspace *ws;
+} BaseParams;
 
+static GSSK_Status base_params_save(BaseParams *b, GSSK_Instance *inst,
+                                    GSSK_Workspace *ws) {
   size_t edge_count = GSSK_GetEdgeCount(inst);
-  double *original_ks = malloc(edge_count * sizeof(double));
-  for (size_t i = 0; i < edge_count; i++) {
-    original_ks[i] = GSSK_GetEdgeK(inst, i);
+  size_t node_count = GSSK_GetStateSize(inst);
+  b->ws = ws;
+  b->ks = gssk_ws_alloc(ws, edge_count * sizeof(double));
+  b->values = gssk_ws_alloc(ws, node_count * sizeof(double));
+  if (!b->ks || !b->values) {
+    gssk_ws_free(ws, b->ks);
+    gssk_ws_free(ws, b->values);
+    b->ks = b->values = NULL;
+    return GSSK_ERR_MALLOC_FAILED;
   }
+  for (size_t i = 0; i < edge_count; i++)
+    b->ks[i] = GSSK_GetEdgeK(inst, i);
+  for (size_t n = 0; n < node_count; n++)
+    b->values[n] = GSSK_GetInitialValue(inst, n);
+  return GSSK_SUCCESS;
+}
 
-  // srand is handled at higher level or by system in WASM
+static void base_params_restore(const BaseParams *b, GSSK_Instance *inst) {
+  if (!b->ks)
+    return;
+  for (size_t i = 0; i < GSSK_GetEdgeCount(inst); i++)
+    GSSK_SetEdgeK(inst, i, b->ks[i]);
+  for (size_t n = 0; n < GSSK_GetStateSize(inst); n++)
+    GSSK_SetInitialValue(inst, n, b->values[n]);
+  GSSK_Reset(inst);
+}
 
-  for (size_t r = 0; r < runs; r++) {
-    // Perturb parameters
-    for (size_t i = 0; i < edge_count; i++) {
-      double p = get_random_double(1.0 - perturbation, 1.0 + perturbation);
-      GSSK_SetEdgeK(inst, i, original_ks[i] * p);
+static void base_params_free(BaseParams *b) {
+  gssk_ws_free(b->ws, b->ks);
+  gssk_ws_free(b->ws, b->values);
+  b->ks = b->values = NULL;
+}
+
+// --- Ensemble Sessions ---
+
+// P-square streaming quantile estimator (Jain & Chlamtac). The desired marker
+// positions depend only on the observation count, which every cell of a
+// session shares, so each cell stores just the marker heights and positions.
+typedef struct {
+  double q[5];
+  double n[5];
+} P2Cell;
+
+static void p2_add(P2Cell *c, double p, size_t count, double x) {
+  // count is the number of observations including x
+  if (count <= 5) {
+    size_t i = count - 1;
+    while (i > 0 && c->q[i - 1] > x) {
+      c->q[i] = c->q[i - 1];
+      i--;
     }
+    c->q[i] = x;
+    c->n[count - 1] = (double)count;
+    return;
+  }
+
+  int k;
+  if (x < c->q[0]) {
+    c->q[0] = x;
+    k = 0;
+  } else if (x >= c->q[4]) {
+    c->q[4] = x;
+    k = 3;
+  } else {
+    k = 0;
+    while (k < 3 && x >= c->q[k + 1])
+      k++;
+  }
+  for (int i = k + 1; i < 5; i++)
+    c->n[i] += 1.0;
+
+  const double dn[5] = {0.0, p / 2.0, p, (1.0 + p) / 2.0, 1.0};
+  for (int i = 1; i < 4; i++) {
+    double desired = 1.0 + (double)(count - 1) * dn[i];
+    double d = desired - c->n[i];
+    if ((d >= 1.0 && c->n[i + 1] - c->n[i] > 1.0) ||
+        (d <= -1.0 && c->n[i - 1] - c->n[i] < -1.0)) {
+      int sd = d > 0.0 ? 1 : -1;
+      double qp = c->q[i] + sd / (c->n[i + 1] - c->n[i - 1]) *
+                                ((c->n[i] - c->n[i - 1] + sd) *
+                                     (c->q[i + 1] - c->q[i]) /
+                                     (c->n[i + 1] - c->n[i]) +
+                                 (c->n[i + 1] - c->n[i] - sd) *
+                                     (c->q[i] - c->q[i - 1]) /
+                                     (c->n[i] - c->n[i - 1]));
+      if (c->q[i - 1] < qp && qp < c->q[i + 1])
+        c->q[i] = qp;
+      else
+        c->q[i] += sd * (c->q[i + sd] - c->q[i]) / (c->n[i + sd] - c->n[i]);
+      c->n[i] += sd;
+    }
+  }
+}
+
+static double p2_estimate(const P2Cell *c, double p, size_t count) {
+  if (count == 0)
+    return NAN;
+  if (count <= 5) {
+    // Markers still hold the sorted raw observations
+    size_t rank = (size_t)(p * (double)(count - 1) + 0.5);
+    return c->q[rank];
+  }
+  return c->q[2];
+}
+
+struct GSSK_EnsembleSession {
+  GSSK_Instance *inst;
+  GSSK_EnsembleOptions opts;
+  GSSK_Workspace *ws;  /**< Owner of this session's memory, NULL for heap */
+  gssk_ws_mark mark;   /**< Workspace position before the session */
+  EnsembleDraws draws;
+  BaseParams base;
+
+  size_t node_count;
+  size_t step_count;
+  size_t members;
+
+  double *min;
+  double *max;
+  double *sum;
+  double *sum_sq;
+  P2Cell *lower; /**< Quantile markers, NULL when bands are disabled */
+  P2Cell *upper;
+
+  // Snapshot after the previous batch, for convergence checks
+  double *prev_lower;
+  double *prev_upper;
+  bool has_prev;
+};
+
+void GSSK_EnsembleSessionFree(GSSK_EnsembleSession *session) {
+  if (session) {
+    GSSK_Workspace *ws = session->ws;
+    gssk_ws_mark mark = session->mark;
+    if (session->draws.opts)
+      draws_free(&session->draws);
+    base_params_free(&session->base);
+    gssk_ws_free(ws, session->min);
+    gssk_ws_free(ws, session->max);
+    gssk_ws_free(ws, session->sum);
+    gssk_ws_free(ws, session->sum_sq);
+    gssk_ws_free(ws, session->lower);
+    gssk_ws_free(ws, session->upper);
+    gssk_ws_free(ws, session->prev_lower);
+    gssk_ws_free(ws, session->prev_upper);
+    gssk_ws_free(ws, session);
+    gssk_ws_release(ws, mark);
+  }
+}
+
+GSSK_EnsembleSession *GSSK_EnsembleSessionCreate(
+    GSSK_Instance *inst, const GSSK_EnsembleOptions *opts) {
+  if (!inst || !opts || opts->band_quantile < 0.0 ||
+      opts->band_quantile >= 0.5)
+    return NULL;
+
+  GSSK_Workspace *ws = opts->workspace;
+  gssk_ws_mark mark = gssk_ws_get_mark(ws);
+  GSSK_EnsembleSession *session =
+      gssk_ws_calloc(ws, 1, sizeof(GSSK_EnsembleSession));
+  if (!session)
+    return NULL;
+
+  session->inst = inst;
+  session->opts = *opts;
+  session->ws = ws;
+  session->mark = mark;
+  session->node_count = GSSK_GetStateSize(inst);
+  session->step_count = gssk_output_steps(inst);
+
+  size_t cells = session->node_count * session->step_count;
+  session->min = gssk_ws_alloc(ws, cells * sizeof(double));
+  session->max = gssk_ws_alloc(ws, cells * sizeof(double));
+  session->sum = gssk_ws_calloc(ws, cells, sizeof(double));
+  session->sum_sq = gssk_ws_calloc(ws, cells, sizeof(double));
+  bool ok = session->min && session->max && session->sum && session->sum_sq;
+
+  if (ok && opts->band_quantile > 0.0) {
+    session->lower = gssk_ws_calloc(ws, cells, sizeof(P2Cell));
+    session->upper = gssk_ws_calloc(ws, cells, sizeof(P2Cell));
+    session->prev_lower = gssk_ws_alloc(ws, cells * sizeof(double));
+    session->prev_upper = gssk_ws_alloc(ws, cells * sizeof(double));
+    ok = session->lower && session->upper && session->prev_lower &&
+         session->prev_upper;
+  }
+
+  // The sampler is sized per batch of 'runs' members
+  if (ok)
+    ok = base_params_save(&session->base, inst, ws) == GSSK_SUCCESS &&
+         draws_init(&session->draws, inst, &session->opts) == GSSK_SUCCESS;
+
+  if (!ok) {
+    GSSK_EnsembleSessionFree(session);
+    return NULL;
+  }
+
+  for (size_t i = 0; i < cells; i++) {
+    session->min[i] = INFINITY;
+    session->max[i] = -INFINITY;
+  }
+  return session;
+}
+
+GSSK_Status GSSK_EnsembleSessionAdd(GSSK_EnsembleSession *session,
+                                    size_t members) {
+  if (!session)
+    return GSSK_ERR_UNKNOWN;
+  if (session->opts.antithetic)
+    members += members & 1;
+
+  GSSK_Instance *inst = session->inst;
+  size_t node_count = session->node_count;
+  double dt = GSSK_GetDt(inst);
+  double q_lo = session->opts.band_quantile;
+  double q_hi = 1.0 - q_lo;
+  gssk_monitor monitor;
+  gssk_monitor_init(&monitor, session->opts.control);
+
+  for (size_t m = 0; m < members; m++) {
+    // Antithetic pairs are never split
+    if ((!session->opts.antithetic || m % 2 == 0) &&
+        gssk_monitor_check(&monitor))
+      break;
+    size_t r = session->members++;
+
+    // Perturb parameters
+    draws_next(&session->draws, r);
+    draws_apply(&session->draws, inst, session->base.ks,
+                session->base.values);
 
     GSSK_Reset(inst);
-    double t = t_start;
-    for (size_t s = 0; s < step_count; s++) {
+    for (size_t s = 0; s < session->step_count; s++) {
       const double *state = GSSK_GetState(inst);
       for (size_t n = 0; n < node_count; n++) {
         double val = state[n];
         size_t idx = s * node_count + n;
-        if (val < res->min_envelope[idx])
-          res->min_envelope[idx] = val;
-        if (val > res->max_envelope[idx])
-          res->max_envelope[idx] = val;
-        res->mean_envelope[idx] += val;
+        if (val < session->min[idx])
+          session->min[idx] = val;
+        if (val > session->max[idx])
+          session->max[idx] = val;
+        session->sum[idx] += val;
+        session->sum_sq[idx] += val * val;
+        if (session->lower) {
+          p2_add(&session->lower[idx], q_lo, session->members, val);
+          p2_add(&session->upper[idx], q_hi, session->members, val);
+        }
       }
       GSSK_Step(inst, dt);
-      t += dt;
     }
+    if (gssk_monitor_due(&monitor, m + 1))
+      gssk_monitor_report(&monitor, m + 1, members, NAN, NULL);
   }
 
-  // Finalize mean
-  for (size_t i = 0; i < node_count * step_count; i++) {
-    res->mean_envelope[i] /= (double)runs;
+  base_params_restore(&session->base, inst);
+  return monitor.stopped ? GSSK_ERR_CANCELLED : GSSK_SUCCESS;
+}
+
+size_t GSSK_EnsembleSessionGetMembers(GSSK_EnsembleSession *session) {
+  return session ? session->members : 0;
+}
+
+// Largest normalized uncertainty of the current estimate: the standard error
+// of the mean, and the movement of the bands since the previous batch, both
+// relative to the node's overall magnitude.
+static double session_convergence_error(GSSK_EnsembleSession *session) {
+  size_t n_nodes = session->node_count;
+  size_t members = session->members;
+  if (members < 2)
+    return INFINITY;
+
+  double worst = 0.0;
+  for (size_t n = 0; n < n_nodes; n++) {
+    double scale = 0.0;
+    for (size_t s = 0; s < session->step_count; s++) {
+      size_t idx = s * n_nodes + n;
+      double m = fabs(session->sum[idx] / (double)members);
+      if (m > scale)
+        scale = m;
+    }
+    if (scale < 1e-12)
+      scale = 1e-12;
+
+    for (size_t s = 0; s < session->step_count; s++) {
+      size_t idx = s * n_nodes + n;
+      double mean = session->sum[idx] / (double)members;
+      double var = (session->sum_sq[idx] - members * mean * mean) /
+                   (double)(members - 1);
+      double se = var > 0.0 ? sqrt(var / (double)members) : 0.0;
+      if (se / scale > worst)
+        worst = se / scale;
+
+      if (session->lower) {
+        if (!session->has_prev)
+          return INFINITY;
+        double q_lo = session->opts.band_quantile;
+        double lo = p2_estimate(&session->lower[idx], q_lo, members);
+        double hi = p2_estimate(&session->upper[idx], 1.0 - q_lo, members);
+        double d_lo = fabs(lo - session->prev_lower[idx]) / scale;
+        double d_hi = fabs(hi - session->prev_upper[idx]) / scale;
+        if (d_lo > worst)
+          worst = d_lo;
+        if (d_hi > worst)
+          worst = d_hi;
+      }
+    }
   }
+  return worst;
+}
+
+// Bands of an empty session are NAN and cannot be compared against, so
+// has_prev stays false until a snapshot holds finite bands
+static void session_snapshot_bands(GSSK_EnsembleSession *session) {
+  if (!session->lower || session->members == 0)
+    return;
+  size_t cells = session->node_count * session->step_count;
+  double q_lo = session->opts.band_quantile;
+  bool finite = true;
+  for (size_t i = 0; i < cells; i++) {
+    session->prev_lower[i] =
+        p2_estimate(&session->lower[i], q_lo, session->members);
+    session->prev_upper[i] =
+        p2_estimate(&session->upper[i], 1.0 - q_lo, session->members);
+    finite = finite && isfinite(session->prev_lower[i]) &&
+             isfinite(session->prev_upper[i]);
+  }
+  session->has_prev = finite;
+}
+
+GSSK_Status GSSK_EnsembleSessionRunUntilConverged(
+    GSSK_EnsembleSession *session, double tolerance, size_t max_members,
+    double time_budget, double *out_error) {
+  if (!session || tolerance <= 0.0)
+    return GSSK_ERR_UNKNOWN;
+
+  size_t batch = session->opts.runs > 0 ? session->opts.runs : 1;
+  double t0 = gssk_wall_time();
+  double error = INFINITY;
+  GSSK_Status status = GSSK_ERR_NOT_CONVERGED;
+
+  for (;;) {
+    if (session->members > 0) {
+      error = session_convergence_error(session);
+      if (error <= tolerance) {
+        status = GSSK_SUCCESS;
+        break;
+      }
+    }
+    if (max_members > 0 && session->members + batch > max_members)
+      break;
+    if (time_budget > 0.0 && gssk_wall_time() - t0 >= time_budget)
+      break;
 
-  // Restore original parameters
-  for (size_t i = 0; i < edge_count; i++) {
-    GSSK_SetEdgeK(inst, i, original_ks[i]);
+    session_snapshot_bands(session);
+    GSSK_Status add_status = GSSK_EnsembleSessionAdd(session, batch);
+    if (add_status != GSSK_SUCCESS) {
+      status = add_status;
+      break;
+    }
   }
-  free(original_ks);
 
+  if (out_error)
+    *out_error = error;
+  return status;
+}
+
+GSSK_EnsembleResult *GSSK_EnsembleSessionGetResult(
+    GSSK_EnsembleSession *session) {
+  if (!session || session->members == 0)
+    return NULL;
+
+  size_t cells = session->node_count * session->step_count;
+  GSSK_EnsembleResult *res =
+      alloc_ensemble_result(session->node_count, session->step_count);
+  if (!res)
+    return NULL;
+  res->runs = session->members;
+
+  memcpy(res->min_envelope, session->min, cells * sizeof(double));
+  memcpy(res->max_envelope, session->max, cells * sizeof(double));
+  for (size_t i = 0; i < cells; i++) {
+    res->mean_envelope[i] = session->sum[i] / (double)session->members;
+  }
+
+  if (session->lower) {
+    res->lower_band = malloc(cells * sizeof(double));
+    res->upper_band = malloc(cells * sizeof(double));
+    if (!res->lower_band || !res->upper_band) {
+      GSSK_FreeEnsembleResult(res);
+      return NULL;
+    }
+    double q_lo = session->opts.band_quantile;
+    for (size_t i = 0; i < cells; i++) {
+      res->lower_band[i] =
+          p2_estimate(&session->lower[i], q_lo, session->members);
+      res->upper_band[i] =
+          p2_estimate(&session->upper[i], 1.0 - q_lo, session->members);
+    }
+  }
   return res;
 }
 
-// --- Parameter Calibration ---
+GSSK_EnsembleResult *GSSK_EnsembleForecastEx(GSSK_Instance *inst,
+                                             const GSSK_EnsembleOptions *opts) {
+  if (!inst || !opts || opts->runs == 0)
+    return NULL;
 
-typedef struct {
-  GSSK_Instance *inst;
-  GSSK_NodeObservations *obs;
-  size_t obs_count;
-  int *node_indices;
-  size_t param_count;
-  double *best_params;
-  double best_fitness;
-} OptimizerContext;
-
-static double calculate_fitness(OptimizerContext *ctx, double *params) {
-  for (size_t i = 0; i < ctx->param_count; i++) {
-    GSSK_SetEdgeK(ctx->inst, i, params[i]);
-  }
-
-  GSSK_Reset(ctx->inst);
-  double t_start = GSSK_GetTStart(ctx->inst);
-  double t_end = GSSK_GetTEnd(ctx->inst);
-  double dt = GSSK_GetDt(ctx->inst);
-
-  double total_mse = 0.0;
-  size_t total_points = 0;
-
-  double t = t_start;
-  double *prev_state = malloc(GSSK_GetStateSize(ctx->inst) * sizeof(double));
-  memcpy(prev_state, GSSK_GetState(ctx->inst),
-         GSSK_GetStateSize(ctx->inst) * sizeof(double));
-  double prev_t = t;
-
-  while (t <= t_end + (dt * 0.01)) {
-    // Check observations for this time window [prev_t, t]
-    for (size_t o = 0; o < ctx->obs_count; o++) {
-      int node_idx = ctx->node_indices[o];
-      if (node_idx == -1)
-        continue;
-
-      for (size_t i = 0; i < ctx->obs[o].count; i++) {
-        double obs_t = ctx->obs[o].data[i].time;
-        if (obs_t > prev_t && obs_t <= t) {
-          double sim_val = interpolate(obs_t, prev_t, prev_state[node_idx], t,
-                                       GSSK_GetState(ctx->inst)[node_idx]);
-          double diff = sim_val - ctx->obs[o].data[i].value;
-          total_mse += diff * diff;
-          total_points++;
+  GSSK_EnsembleSession *session = GSSK_EnsembleSessionCreate(inst, opts);
+  if (!session)
+    return NULL;
+
+  // A cancelled forecast still returns the members it completed
+  GSSK_EnsembleResult *res = NULL;
+  GSSK_Status status = GSSK_EnsembleSessionAdd(session, opts->runs);
+  if (status == GSSK_SUCCESS || status == GSSK_ERR_CANCELLED)
+    res = GSSK_EnsembleSessionGetResult(session);
+
+  GSSK_EnsembleSessionFree(session);
+  return res;
+}
+
+// --- Scenario Comparison (Common Random Numbers) ---
+
+void GSSK_FreeScenarioDelta(GSSK_ScenarioDelta *res) {
+  if (res) {
+    free(res->mean_delta);
+    free(res->stderr_delta);
+    free(res);
+  }
+}
+
+GSSK_ScenarioDelta *GSSK_EnsembleCompare(GSSK_Instance *baseline,
+                                         GSSK_Instance *scenario,
+                                         const GSSK_EnsembleOptions *opts) {
+  if (!baseline || !scenario || !opts || opts->runs == 0)
+    return NULL;
+
+  // Common random numbers need a one-to-one mapping of perturbed parameters
+  size_t node_count = GSSK_GetStateSize(baseline);
+  size_t step_count = gssk_output_steps(baseline);
+  if (GSSK_GetStateSize(scenario) != node_count ||
+      GSSK_GetEdgeCount(scenario) != GSSK_GetEdgeCount(baseline) ||
+      gssk_output_steps(scenario) != step_count)
+    return NULL;
+
+  size_t cells = node_count * step_count;
+  size_t members = ensemble_member_count(opts);
+  size_t units = opts->antithetic ? members / 2 : members;
+  if (units < 2)
+    return NULL;
+
+  GSSK_ScenarioDelta *res = calloc(1, sizeof(GSSK_ScenarioDelta));
+  if (!res)
+    return NULL;
+  res->node_count = node_count;
+  res->step_count = step_count;
+  res->mean_delta = calloc(cells, sizeof(double));
+  res->stderr_delta = calloc(cells, sizeof(double));
+
+  // Member-level moments of each scenario (for the independent-sampling
+  // reference) and unit-level moments of the paired delta.
+  GSSK_Workspace *ws = opts->workspace;
+  gssk_ws_mark mark = gssk_ws_get_mark(ws);
+  double *traj_b = gssk_ws_alloc(ws, cells * sizeof(double));
+  double *traj_s = gssk_ws_alloc(ws, cells * sizeof(double));
+  double *pending = gssk_ws_calloc(ws, cells, sizeof(double));
+  double *sum_b = gssk_ws_calloc(ws, cells, sizeof(double));
+  double *sq_b = gssk_ws_calloc(ws, cells, sizeof(double));
+  double *sum_s = gssk_ws_calloc(ws, cells, sizeof(double));
+  double *sq_s = gssk_ws_calloc(ws, cells, sizeof(double));
+  double *sq_d = gssk_ws_calloc(ws, cells, sizeof(double));
+
+  BaseParams base_b = {NULL, NULL, NULL}, base_s = {NULL, NULL, NULL};
+  EnsembleDraws draws;
+  bool ok = res->mean_delta && res->stderr_delta && traj_b && traj_s &&
+            pending && sum_b && sq_b && sum_s && sq_s && sq_d &&
+            base_params_save(&base_b, baseline, ws) == GSSK_SUCCESS &&
+            base_params_save(&base_s, scenario, ws) == GSSK_SUCCESS;
+  bool draws_ready = ok && draws_init(&draws, baseline, opts) == GSSK_SUCCESS;
+
+  if (draws_ready) {
+    for (size_t r = 0; r < members; r++) {
+      draws_next(&draws, r);
+      draws_apply(&draws, baseline, base_b.ks, base_b.values);
+      draws_apply(&draws, scenario, base_s.ks, base_s.values);
+      gssk_simulate_trajectory(baseline, step_count, traj_b);
+      gssk_simulate_trajectory(scenario, step_count, traj_s);
+
+      bool unit_done = !opts->antithetic || (r & 1);
+      for (size_t i = 0; i < cells; i++) {
+        sum_b[i] += traj_b[i];
+        sq_b[i] += traj_b[i] * traj_b[i];
+        sum_s[i] += traj_s[i];
+        sq_s[i] += traj_s[i] * traj_s[i];
+
+        double d = traj_s[i] - traj_b[i];
+        if (opts->antithetic) {
+          pending[i] += 0.5 * d;
+          d = pending[i];
+        }
+        if (unit_done) {
+          res->mean_delta[i] += d;
+          sq_d[i] += d * d;
+          pending[i] = 0.0;
         }
       }
     }
 
-    if (t >= t_end)
-      break;
+    // Pool the variances over all cells so flat cells do not dominate
+    double var_independent = 0.0, var_achieved = 0.0;
+    for (size_t i = 0; i < cells; i++) {
+      double m = res->mean_delta[i] / (double)units;
+      double var_d = (sq_d[i] - units * m * m) / (double)(units - 1);
+      if (var_d < 0.0)
+        var_d = 0.0;
+      res->mean_delta[i] = m;
+      res->stderr_delta[i] = sqrt(var_d / (double)units);
+      var_achieved += var_d / (double)units;
 
-    memcpy(prev_state, GSSK_GetState(ctx->inst),
-           GSSK_GetStateSize(ctx->inst) * sizeof(double));
-    prev_t = t;
-    if (GSSK_Step(ctx->inst, dt) != GSSK_SUCCESS)
-      break;
-    t += dt;
+      double mb = sum_b[i] / (double)members;
+      double ms = sum_s[i] / (double)members;
+      double var_b = (sq_b[i] - members * mb * mb) / (double)(members - 1);
+      double var_s = (sq_s[i] - members * ms * ms) / (double)(members - 1);
+      var_independent += ((var_b > 0.0 ? var_b : 0.0) +
+                          (var_s > 0.0 ? var_s : 0.0)) /
+                         (double)members;
+    }
+    if (var_achieved > 0.0)
+      res->variance_reduction = var_independent / var_achieved;
+    else
+      res->variance_reduction = var_independent > 0.0 ? INFINITY : 1.0;
+
+    draws_free(&draws);
   }
 
-  free(prev_state);
-  return total_points > 0 ? total_mse / total_points : INFINITY;
+  base_params_restore(&base_b, baseline);
+  base_params_restore(&base_s, scenario);
+  base_params_free(&base_b);
+  base_params_free(&base_s);
+  gssk_ws_free(ws, traj_b);
+  gssk_ws_free(ws, traj_s);
+  gssk_ws_free(ws, pending);
+  gssk_ws_free(ws, sum_b);
+  gssk_ws_free(ws, sq_b);
+  gssk_ws_free(ws, sum_s);
+  gssk_ws_free(ws, sq_s);
+  gssk_ws_free(ws, sq_d);
+  gssk_ws_release(ws, mark);
+
+  if (!draws_ready) {
+    GSSK_FreeScenarioDelta(res);
+    return NULL;
+  }
+  return res;
 }
 
-GSSK_Status GSSK_Calibrate(GSSK_Instance *inst, GSSK_NodeObservations *obs,
-                           size_t obs_count, int iterations) {
-  if (!inst || !obs || obs_count == 0)
-    return GSSK_ERR_UNKNOWN;
+GSSK_EnsembleResult *GSSK_EnsembleForecast(GSSK_Instance *inst, size_t runs,
+                                           double perturbation) {
+  GSSK_EnsembleOptions opts;
+  GSSK_InitEnsembleOptions(&opts);
+  opts.runs = runs;
+  opts.perturbation = perturbation;
+  return GSSK_EnsembleForecastEx(inst, &opts);
+}
+
+// --- Data Assimilation (Ensemble Kalman Filter) ---
+
+// Members are integrated in lockstep blocks of this many lanes, one task
+// per block
+#define ENKF_LANES 8
+
+struct GSSK_EnKF {
+  GSSK_Instance *inst;
+  GSSK_EnKFOptions opts;
+  size_t node_count;
+  size_t edge_count;
+  size_t members;
+  size_t param_count;  /**< Estimated k's, 0 without estimate_k */
+  size_t *edges;       /**< Edge of each estimated k */
+  size_t step;         /**< Steps since t_start */
+  size_t workers;
+  size_t block_count;
+  gssk_batch *blocks;  /**< Member m lives in lane m % ENKF_LANES of block
+                            m / ENKF_LANES */
+  gssk_rng rng;        /**< Observation perturbations */
+
+  // Analysis scratch, grown to the largest observation group seen
+  size_t capacity;
+  double *mean;        /**< Augmented state mean, node_count + param_count */
+  double *hx;          /**< Observed members, capacity * members */
+  double *innov;       /**< Perturbed innovations, then gain weights,
+                            members * capacity */
+  double *pyy;         /**< Innovation covariance, capacity^2 */
+  double *gain;        /**< Cross covariance, (node_count + param_count) *
+                            capacity */
+};
+
+void GSSK_InitEnKFOptions(GSSK_EnKFOptions *opts) {
+  if (!opts)
+    return;
+  GSSK_InitEnsembleOptions(&opts->ensemble);
+  opts->ensemble.value_perturbation = 0.1;
+  opts->estimate_k = false;
+  opts->edges = NULL;
+  opts->param_count = 0;
+  opts->obs_error = 0.0;
+  opts->obs_relative_error = 0.05;
+  opts->inflation = 1.0;
+  opts->threads = 0;
+}
+
+void GSSK_EnKFFree(GSSK_EnKF *filter) {
+  if (!filter)
+    return;
+  for (size_t b = 0; filter->blocks && b < filter->block_count; b++)
+    gssk_batch_free(&filter->blocks[b]);
+  free(filter->blocks);
+  free(filter->edges);
+  free(filter->mean);
+  free(filter->hx);
+  free(filter->innov);
+  free(filter->pyy);
+  free(filter->gain);
+  free(filter);
+}
+
+// Augmented state entry i (node values, then estimated k's) of a lane
+static double *enkf_entry(const GSSK_EnKF *f, gssk_batch *b, size_t i,
+                          size_t lane) {
+  if (i < f->node_count)
+    return &b->state[i * ENKF_LANES + lane];
+  return &b->k[f->edges[i - f->node_count] * ENKF_LANES + lane];
+}
+
+GSSK_EnKF *GSSK_EnKFCreate(GSSK_Instance *inst, const GSSK_EnKFOptions *opts) {
+  if (!inst || !opts || opts->ensemble.runs < 2 || opts->obs_error < 0.0 ||
+      opts->obs_relative_error < 0.0 || !(opts->inflation > 0.0))
+    return NULL;
+
+  GSSK_EnKF *f = calloc(1, sizeof(GSSK_EnKF));
+  if (!f)
+    return NULL;
+  f->inst = inst;
+  f->opts = *opts;
+  f->opts.ensemble.workspace = NULL;
+  f->opts.edges = NULL;
+  f->node_count = GSSK_GetStateSize(inst);
+  f->edge_count = GSSK_GetEdgeCount(inst);
+  f->members = ensemble_member_count(&opts->ensemble);
+  if (opts->estimate_k) {
+    f->param_count = opts->param_count;
+    if (gssk_resolve_edges(inst, opts->edges, &f->param_count, &f->edges) !=
+        GSSK_SUCCESS) {
+      GSSK_EnKFFree(f);
+      return NULL;
+    }
+  }
 
-  OptimizerContext ctx;
-  ctx.inst = inst;
-  ctx.obs = obs;
-  ctx.obs_count = obs_count;
-  ctx.node_indices = malloc(obs_count * sizeof(int));
-  for (size_t i = 0; i < obs_count; i++) {
-    ctx.node_indices[i] = GSSK_FindNodeIdx(inst, obs[i].node_id);
+  // Pin the design seed, so the observation noise stream can be derived
+  // from the same one
+  while (f->opts.ensemble.seed == 0)
+    f->opts.ensemble.seed = (unsigned int)gssk_resolve_seed(0);
+  gssk_rng_seed(&f->rng, (uint64_t)f->opts.ensemble.seed ^
+                             0x9E3779B97F4A7C15ULL);
+
+  f->block_count = (f->members + ENKF_LANES - 1) / ENKF_LANES;
+  f->workers = gssk_worker_count(opts->threads, f->block_count);
+  f->blocks = calloc(f->block_count, sizeof(gssk_batch));
+  f->mean = malloc((f->node_count + f->param_count) * sizeof(double));
+  if (!f->blocks || !f->mean) {
+    GSSK_EnKFFree(f);
+    return NULL;
+  }
+  for (size_t b = 0; b < f->block_count; b++) {
+    if (gssk_batch_init(&f->blocks[b], inst, ENKF_LANES, NULL) !=
+        GSSK_SUCCESS) {
+      GSSK_EnKFFree(f);
+      return NULL;
+    }
   }
 
-  ctx.param_count = GSSK_GetEdgeCount(inst);
-  if (ctx.param_count == 0) {
-    free(ctx.node_indices);
-    return GSSK_SUCCESS;
+  // Draw the prior members exactly as an ensemble forecast would
+  BaseParams base;
+  EnsembleDraws draws;
+  memset(&base, 0, sizeof(base));
+  if (base_params_save(&base, inst, NULL) != GSSK_SUCCESS ||
+      draws_init(&draws, inst, &f->opts.ensemble) != GSSK_SUCCESS) {
+    base_params_free(&base);
+    GSSK_EnKFFree(f);
+    return NULL;
+  }
+  const GSSK_EnsembleOptions *eopts = &f->opts.ensemble;
+  for (size_t m = 0; m < f->members; m++) {
+    gssk_batch *b = &f->blocks[m / ENKF_LANES];
+    size_t lane = m % ENKF_LANES;
+    if (lane == 0)
+      gssk_batch_reset(b, f->members - m < ENKF_LANES ? f->members - m
+                                                      : ENKF_LANES,
+                       base.values);
+    draws_next(&draws, m);
+    for (size_t e = 0; e < f->edge_count; e++)
+      b->k[e * ENKF_LANES + lane] =
+          base.ks[e] * gssk_perturbation_factor(eopts->distribution,
+                                                eopts->perturbation,
+                                                draws.u[e]);
+    for (size_t n = 0; draws.perturb_values && n < f->node_count; n++)
+      b->state[n * ENKF_LANES + lane] =
+          base.values[n] *
+          gssk_perturbation_factor(eopts->distribution,
+                                   eopts->value_perturbation,
+                                   draws.u[f->edge_count + n]);
+  }
+  draws_free(&draws);
+  base_params_free(&base);
+  return f;
+}
+
+typedef struct {
+  GSSK_EnKF *filter;
+  size_t steps;
+} EnKFAdvance;
+
+static void enkf_advance_task(void *arg, size_t block, size_t worker) {
+  (void)worker;
+  EnKFAdvance *a = arg;
+  double dt = GSSK_GetDt(a->filter->inst);
+  for (size_t s = 0; s < a->steps; s++)
+    gssk_batch_step(&a->filter->blocks[block], dt);
+}
+
+static GSSK_Status enkf_advance_to(GSSK_EnKF *f, size_t step) {
+  if (step > f->step) {
+    EnKFAdvance a = {f, step - f->step};
+    gssk_parallel_for(f->block_count, f->workers, enkf_advance_task, &a);
+    f->step = step;
   }
+  for (size_t b = 0; b < f->block_count; b++) {
+    for (size_t m = 0; m < f->blocks[b].members; m++) {
+      if (f->blocks[b].diverged[m])
+        return GSSK_ERR_DIVERGENCE;
+    }
+  }
+  return GSSK_SUCCESS;
+}
 
-  // Differential Evolution Parameters
-  const int pop_size = 20;
-  const double F = 0.8;
-  const double CR = 0.9;
+// Step index of time t, rounded to the nearest step
+static double enkf_step_of(const GSSK_EnKF *f, double t) {
+  return floor((t - GSSK_GetTStart(f->inst)) / GSSK_GetDt(f->inst) + 0.5);
+}
 
-  double *population = malloc(pop_size * ctx.param_count * sizeof(double));
-  double *fitness = malloc(pop_size * sizeof(double));
-  double *best_params = malloc(ctx.param_count * sizeof(double));
-  double best_fitness = INFINITY;
+GSSK_Status GSSK_EnKFAdvance(GSSK_EnKF *filter, double t) {
+  if (!filter)
+    return GSSK_ERR_UNKNOWN;
+  double step = enkf_step_of(filter, t);
+  if (!(step >= (double)filter->step))
+    return GSSK_ERR_UNKNOWN;
+  return enkf_advance_to(filter, (size_t)step);
+}
 
-  // srand handled globally
+double GSSK_EnKFGetTime(GSSK_EnKF *filter) {
+  if (!filter)
+    return NAN;
+  return GSSK_GetTStart(filter->inst) +
+         (double)filter->step * GSSK_GetDt(filter->inst);
+}
 
-  // Initialize Population
-  for (int i = 0; i < pop_size; i++) {
-    for (size_t j = 0; j < ctx.param_count; j++) {
-      // Assuming k is in range [0, 10] for now as a heuristic
-      population[i * ctx.param_count + j] = get_random_double(0.0, 10.0);
+// Mean and sample standard deviation over the members of one lane quantity
+// ('k' selects the k array, else the state)
+static void enkf_moments(GSSK_EnKF *f, bool k, size_t count, double *mean,
+                         double *sd) {
+  for (size_t i = 0; i < count; i++) {
+    double sum = 0.0, ss = 0.0;
+    for (size_t b = 0; b < f->block_count; b++) {
+      const gssk_batch *blk = &f->blocks[b];
+      const double *v =
+          k ? &blk->k[i * ENKF_LANES] : &blk->state[i * ENKF_LANES];
+      for (size_t m = 0; m < blk->members; m++)
+        sum += v[m];
     }
-    fitness[i] = calculate_fitness(&ctx, &population[i * ctx.param_count]);
-    if (fitness[i] < best_fitness) {
-      best_fitness = fitness[i];
-      memcpy(best_params, &population[i * ctx.param_count],
-             ctx.param_count * sizeof(double));
+    double mu = sum / (double)f->members;
+    for (size_t b = 0; sd && b < f->block_count; b++) {
+      const gssk_batch *blk = &f->blocks[b];
+      const double *v =
+          k ? &blk->k[i * ENKF_LANES] : &blk->state[i * ENKF_LANES];
+      for (size_t m = 0; m < blk->members; m++)
+        ss += (v[m] - mu) * (v[m] - mu);
     }
+    mean[i] = mu;
+    if (sd)
+      sd[i] = sqrt(ss / (double)(f->members - 1));
   }
+}
 
-  // DE Main Loop
-  for (int iter = 0; iter < iterations; iter++) {
-    for (int i = 0; i < pop_size; i++) {
-      // Mutation
-      int a, b, c;
-      do { a = rand() % pop_size; } while (a == i);
-      do { b = rand() % pop_size; } while (b == i || b == a);
-      do { c = rand() % pop_size; } while (c == i || c == a || c == b);
-
-      double *trial = malloc(ctx.param_count * sizeof(double));
-      int R = rand() % ctx.param_count;
-      for (size_t j = 0; j < ctx.param_count; j++) {
-        if (get_random_double(0, 1) < CR || j == (size_t)R) {
-          trial[j] = population[a * ctx.param_count + j] +
-                     F * (population[b * ctx.param_count + j] -
-                          population[c * ctx.param_count + j]);
-          if (trial[j] < 0) trial[j] = 0; // Boundary constraint
-        } else {
-          trial[j] = population[i * ctx.param_count + j];
-        }
-      }
+void GSSK_EnKFGetState(GSSK_EnKF *filter, double *mean, double *sd) {
+  if (filter && mean)
+    enkf_moments(filter, false, filter->node_count, mean, sd);
+}
 
-      double trial_fitness = calculate_fitness(&ctx, trial);
-      if (trial_fitness <= fitness[i]) {
-        fitness[i] = trial_fitness;
-        memcpy(&population[i * ctx.param_count], trial,
-               ctx.param_count * sizeof(double));
-        if (trial_fitness < best_fitness) {
-          best_fitness = trial_fitness;
-          memcpy(best_params, trial, ctx.param_count * sizeof(double));
-        }
+void GSSK_EnKFGetK(GSSK_EnKF *filter, double *mean, double *sd) {
+  if (filter && mean)
+    enkf_moments(filter, true, filter->edge_count, mean, sd);
+}
+
+typedef struct {
+  GSSK_EnKF *filter;
+  size_t count;  /**< Observations in the group */
+} EnKFUpdate;
+
+// Solve for each member's gain weights w = Pyy^-1 d and apply x += C w
+static void enkf_update_task(void *arg, size_t block, size_t worker) {
+  (void)worker;
+  EnKFUpdate *u = arg;
+  GSSK_EnKF *f = u->filter;
+  gssk_batch *b = &f->blocks[block];
+  size_t n = f->node_count + f->param_count;
+  size_t obs = u->count;
+  for (size_t lane = 0; lane < b->members; lane++) {
+    double *w = &f->innov[(block * ENKF_LANES + lane) * obs];
+    gssk_cholesky_solve(f->pyy, obs, w);
+    for (size_t i = 0; i < n; i++) {
+      double *x = enkf_entry(f, b, i, lane);
+      double dx = 0.0;
+      for (size_t r = 0; r < obs; r++)
+        dx += f->gain[i * obs + r] * w[r];
+      *x += dx;
+      if (*x < 0.0)
+        *x = 0.0;
+    }
+  }
+}
+
+typedef struct {
+  size_t node;
+  size_t step;
+  size_t order;  /**< Position in the batch, so ties keep their order */
+  double value;
+} EnKFObs;
+
+static int enkf_obs_compare(const void *a, const void *b) {
+  const EnKFObs *x = a, *y = b;
+  if (x->step != y->step)
+    return x->step < y->step ? -1 : 1;
+  return (x->order > y->order) - (x->order < y->order);
+}
+
+// Standard deviation of the noise on an observed value
+static double enkf_obs_sd(const GSSK_EnKF *f, double value) {
+  return f->opts.obs_error + f->opts.obs_relative_error * fabs(value);
+}
+
+// Update the members on observations 'obs' (all at the current step)
+static GSSK_Status enkf_analysis(GSSK_EnKF *f, const EnKFObs *obs,
+                                 size_t count) {
+  size_t N = f->members;
+  size_t n = f->node_count + f->param_count;
+  if (count > f->capacity) {
+    double *hx = realloc(f->hx, count * N * sizeof(double));
+    if (hx)
+      f->hx = hx;
+    double *innov = realloc(f->innov, count * N * sizeof(double));
+    if (innov)
+      f->innov = innov;
+    double *pyy = realloc(f->pyy, count * count * sizeof(double));
+    if (pyy)
+      f->pyy = pyy;
+    double *gain = realloc(f->gain, n * count * sizeof(double));
+    if (gain)
+      f->gain = gain;
+    if (!hx || !innov || !pyy || !gain)
+      return GSSK_ERR_MALLOC_FAILED;
+    f->capacity = count;
+  }
+
+  // Inflate the forecast anomalies about the mean
+  for (size_t i = 0; i < n; i++) {
+    double sum = 0.0;
+    for (size_t m = 0; m < N; m++)
+      sum += *enkf_entry(f, &f->blocks[m / ENKF_LANES], i, m % ENKF_LANES);
+    f->mean[i] = sum / (double)N;
+  }
+  if (f->opts.inflation != 1.0) {
+    for (size_t i = 0; i < n; i++) {
+      for (size_t m = 0; m < N; m++) {
+        double *x =
+            enkf_entry(f, &f->blocks[m / ENKF_LANES], i, m % ENKF_LANES);
+        *x = f->mean[i] + f->opts.inflation * (*x - f->mean[i]);
       }
-      free(trial);
     }
   }
 
-  // Set best parameters back to instance
-  for (size_t i = 0; i < ctx.param_count; i++) {
-    GSSK_SetEdgeK(inst, i, best_params[i]);
+  // Observed anomalies and their covariance plus the observation noise
+  double *hx = f->hx;
+  for (size_t r = 0; r < count; r++) {
+    for (size_t m = 0; m < N; m++)
+      hx[r * N + m] = *enkf_entry(f, &f->blocks[m / ENKF_LANES], obs[r].node,
+                                  m % ENKF_LANES) -
+                      f->mean[obs[r].node];
+  }
+  for (size_t r = 0; r < count; r++) {
+    double sigma = enkf_obs_sd(f, obs[r].value);
+    for (size_t c = 0; c <= r; c++) {
+      double sum = 0.0;
+      for (size_t m = 0; m < N; m++)
+        sum += hx[r * N + m] * hx[c * N + m];
+      f->pyy[r * count + c] = f->pyy[c * count + r] = sum / (double)(N - 1);
+    }
+    f->pyy[r * count + r] += sigma * sigma;
   }
+  if (!gssk_cholesky(f->pyy, count))
+    return GSSK_ERR_UNKNOWN;
 
-  free(population);
-  free(fitness);
-  free(best_params);
-  free(ctx.node_indices);
+  // Cross covariance of the augmented state with the observed nodes
+  for (size_t i = 0; i < n; i++) {
+    for (size_t r = 0; r < count; r++) {
+      double sum = 0.0;
+      for (size_t m = 0; m < N; m++)
+        sum += (*enkf_entry(f, &f->blocks[m / ENKF_LANES], i, m % ENKF_LANES) -
+                f->mean[i]) *
+               hx[r * N + m];
+      f->gain[i * count + r] = sum / (double)(N - 1);
+    }
+  }
 
+  // Perturbed innovations, drawn on this thread in member order so the
+  // update does not depend on the thread count
+  for (size_t m = 0; m < N; m++) {
+    for (size_t r = 0; r < count; r++) {
+      double y = obs[r].value +
+                 enkf_obs_sd(f, obs[r].value) * gssk_rng_normal(&f->rng);
+      f->innov[m * count + r] =
+          y - (hx[r * N + m] + f->mean[obs[r].node]);
+    }
+  }
+  EnKFUpdate u = {f, count};
+  gssk_parallel_for(f->block_count, f->workers, enkf_update_task, &u);
   return GSSK_SUCCESS;
 }
+
+GSSK_Status GSSK_EnKFAssimilate(GSSK_EnKF *filter,
+                                const GSSK_NodeObservations *obs,
+                                size_t obs_count) {
+  if (!filter || (!obs && obs_count > 0))
+    return GSSK_ERR_UNKNOWN;
+
+  // Validate the whole batch before touching the members
+  size_t total = 0;
+  for (size_t o = 0; o < obs_count; o++) {
+    if (GSSK_FindNodeIdx(filter->inst, obs[o].node_id) == -1 ||
+        (!obs[o].data && obs[o].count > 0))
+      return GSSK_ERR_UNKNOWN;
+    for (size_t j = 0; j < obs[o].count; j++) {
+      double step = enkf_step_of(filter, obs[o].data[j].time);
+      if (!(step >= (double)filter->step) || !isfinite(obs[o].data[j].value))
+        return GSSK_ERR_UNKNOWN;
+    }
+    total += obs[o].count;
+  }
+  if (total == 0)
+    return GSSK_SUCCESS;
+
+  EnKFObs *list = malloc(total * sizeof(EnKFObs));
+  if (!list)
+    return GSSK_ERR_MALLOC_FAILED;
+  size_t count = 0;
+  for (size_t o = 0; o < obs_count; o++) {
+    size_t node = (size_t)GSSK_FindNodeIdx(filter->inst, obs[o].node_id);
+    for (size_t j = 0; j < obs[o].count; j++, count++) {
+      list[count].node = node;
+      list[count].step = (size_t)enkf_step_of(filter, obs[o].data[j].time);
+      list[count].order = count;
+      list[count].value = obs[o].data[j].value;
+    }
+  }
+  qsort(list, total, sizeof(EnKFObs), enkf_obs_compare);
+
+  GSSK_Status status = GSSK_SUCCESS;
+  for (size_t first = 0, last; first < total && status == GSSK_SUCCESS;
+       first = last) {
+    for (last = first + 1; last < total && list[last].step == list[first].step;
+         last++)
+      ;
+    status = enkf_advance_to(filter, list[first].step);
+    if (status == GSSK_SUCCESS)
+      status = enkf_analysis(filter, &list[first], last - first);
+  }
+  free(list);
+  return status;
+}
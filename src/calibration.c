@@ -0,0 +1,3139 @@
+#include "gssk.h"
+#include "gssk_internal.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --- Observation Schedule ---
+
+void gssk_schedule_free(gssk_schedule *s) {
+  gssk_ws_free(s->ws, s->step_start);
+  gssk_ws_free(s->ws, s->node);
+  gssk_ws_free(s->ws, s->weight);
+  gssk_ws_free(s->ws, s->value);
+  memset(s, 0, sizeof(*s));
+}
+
+// Window of the step grid containing obs_t, or 0 if it falls outside
+static size_t schedule_find_step(const double *times, size_t steps,
+                                 double obs_t) {
+  if (!(obs_t > times[0]) || !(obs_t <= times[steps - 1]))
+    return 0;
+  size_t lo = 1, hi = steps - 1;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (times[mid] < obs_t)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+GSSK_Status gssk_schedule_compile(gssk_schedule *sched, GSSK_Instance *inst,
+                                  const GSSK_NodeObservations *obs,
+                                  size_t obs_count, GSSK_Workspace *ws) {
+  memset(sched, 0, sizeof(*sched));
+  sched->ws = ws;
+  double t_start = GSSK_GetTStart(inst);
+  double t_end = GSSK_GetTEnd(inst);
+  double dt = GSSK_GetDt(inst);
+
+  // Reproduce the simulation clock (t accumulates dt), so every
+  // observation lands in the window the step loop would have used
+  size_t capacity = gssk_output_steps(inst) + 2;
+  double *times = gssk_ws_alloc(ws, capacity * sizeof(double));
+  size_t *step_of = NULL;
+  size_t total = 0;
+  for (size_t o = 0; o < obs_count; o++)
+    total += obs[o].count;
+  if (!times)
+    return GSSK_ERR_MALLOC_FAILED;
+  size_t steps = 0;
+  double t = t_start;
+  while (steps < capacity && t <= t_end + (dt * 0.01)) {
+    times[steps++] = t;
+    if (t >= t_end)
+      break;
+    t += dt;
+  }
+
+  step_of = gssk_ws_alloc(ws, total * sizeof(size_t));
+  if (!step_of) {
+    gssk_ws_free(ws, times);
+    return GSSK_ERR_MALLOC_FAILED;
+  }
+  size_t j = 0;
+  for (size_t o = 0; o < obs_count; o++) {
+    int node_idx = GSSK_FindNodeIdx(inst, obs[o].node_id);
+    for (size_t i = 0; i < obs[o].count; i++, j++) {
+      step_of[j] = node_idx == -1
+                       ? 0
+                       : schedule_find_step(times, steps, obs[o].data[i].time);
+      if (step_of[j] > sched->last_step)
+        sched->last_step = step_of[j];
+      if (step_of[j] > 0)
+        sched->count++;
+    }
+  }
+
+  size_t n = sched->count > 0 ? sched->count : 1;
+  sched->step_start = gssk_ws_calloc(ws, sched->last_step + 2, sizeof(size_t));
+  sched->node = gssk_ws_alloc(ws, n * sizeof(int));
+  sched->weight = gssk_ws_alloc(ws, n * sizeof(double));
+  sched->value = gssk_ws_alloc(ws, n * sizeof(double));
+  if (!sched->step_start || !sched->node || !sched->weight || !sched->value) {
+    gssk_ws_free(ws, times);
+    gssk_ws_free(ws, step_of);
+    gssk_schedule_free(sched);
+    return GSSK_ERR_MALLOC_FAILED;
+  }
+
+  // Counting sort by step, stable in input order so residuals accumulate in
+  // the same order as a per-step scan of the observation arrays
+  for (j = 0; j < total; j++) {
+    if (step_of[j] > 0)
+      sched->step_start[step_of[j] + 1]++;
+  }
+  for (size_t s = 0; s <= sched->last_step; s++)
+    sched->step_start[s + 1] += sched->step_start[s];
+  j = 0;
+  for (size_t o = 0; o < obs_count; o++) {
+    int node_idx = GSSK_FindNodeIdx(inst, obs[o].node_id);
+    for (size_t i = 0; i < obs[o].count; i++, j++) {
+      size_t s = step_of[j];
+      if (s == 0)
+        continue;
+      size_t slot = sched->step_start[s]++;
+      double t1 = times[s - 1], t2 = times[s];
+      sched->node[slot] = node_idx;
+      sched->weight[slot] =
+          fabs(t2 - t1) < 1e-9 ? 0.0 : (obs[o].data[i].time - t1) / (t2 - t1);
+      sched->value[slot] = obs[o].data[i].value;
+    }
+  }
+  // The fill pass advanced each start to the next step's start; shift back
+  for (size_t s = sched->last_step + 1; s > 0; s--)
+    sched->step_start[s] = sched->step_start[s - 1];
+  sched->step_start[0] = 0;
+
+  gssk_ws_free(ws, times);
+  gssk_ws_free(ws, step_of);
+  return GSSK_SUCCESS;
+}
+
+// --- Parameter Space ---
+
+// One optimizer coordinate. Edges marked calibratable in the model are
+// searched on [0, 1], mapped linearly or log-linearly onto their k range;
+// the others directly in k, bounded below by the optimizer's k_min.
+typedef struct {
+  bool unit;
+  GSSK_ParamScale scale;
+  double lo, hi; /**< k range mapped from [0, 1] (log k for log scale) */
+} ParamMap;
+
+typedef struct {
+  GSSK_Workspace *ws;
+  size_t count;
+  size_t *edges;    /**< Edge of each coordinate */
+  ParamMap *maps;
+  double *base_k;   /**< k of every edge, for those not optimized */
+} ParamSpace;
+
+static void param_space_free(ParamSpace *space) {
+  gssk_ws_free(space->ws, space->edges);
+  gssk_ws_free(space->ws, space->maps);
+  gssk_ws_free(space->ws, space->base_k);
+  memset(space, 0, sizeof(*space));
+}
+
+// The optimized edges are 'edges' when given, else those the model marks
+// calibratable, else every edge
+static GSSK_Status param_space_init(ParamSpace *space, GSSK_Instance *inst,
+                                   const size_t *edges, size_t count,
+                                   GSSK_Workspace *ws) {
+  memset(space, 0, sizeof(*space));
+  space->ws = ws;
+  size_t edge_count = GSSK_GetEdgeCount(inst);
+  size_t marked = 0;
+  for (size_t e = 0; e < edge_count; e++)
+    marked += GSSK_GetEdgeCalibration(inst, e, NULL, NULL, NULL);
+  if (edges) {
+    for (size_t i = 0; i < count; i++) {
+      if (edges[i] >= edge_count)
+        return GSSK_ERR_UNKNOWN;
+    }
+  } else {
+    count = marked > 0 ? marked : edge_count;
+  }
+  if (count == 0)
+    return GSSK_ERR_UNKNOWN;
+
+  space->count = count;
+  space->edges = gssk_ws_alloc(ws, count * sizeof(size_t));
+  space->maps = gssk_ws_alloc(ws, count * sizeof(ParamMap));
+  space->base_k = gssk_ws_alloc(ws, edge_count * sizeof(double));
+  if (!space->edges || !space->maps || !space->base_k) {
+    param_space_free(space);
+    return GSSK_ERR_MALLOC_FAILED;
+  }
+  for (size_t e = 0, i = 0; e < edge_count; e++) {
+    space->base_k[e] = GSSK_GetEdgeK(inst, e);
+    if (!edges && (marked == 0 || GSSK_GetEdgeCalibration(inst, e, NULL,
+                                                          NULL, NULL)))
+      space->edges[i++] = e;
+  }
+  for (size_t i = 0; i < count; i++) {
+    ParamMap *m = &space->maps[i];
+    if (edges)
+      space->edges[i] = edges[i];
+    m->unit = GSSK_GetEdgeCalibration(inst, space->edges[i], &m->lo, &m->hi,
+                                      &m->scale);
+    if (m->unit && m->scale == GSSK_SCALE_LOG) {
+      m->lo = log(m->lo);
+      m->hi = log(m->hi);
+    }
+  }
+  return GSSK_SUCCESS;
+}
+
+static double param_to_k(const ParamMap *m, double u) {
+  if (!m->unit)
+    return u;
+  double v = m->lo + u * (m->hi - m->lo);
+  return m->scale == GSSK_SCALE_LOG ? exp(v) : v;
+}
+
+// Coordinate of k, clamped into the edge's range
+static double param_from_k(const ParamMap *m, double k) {
+  if (!m->unit)
+    return k;
+  double v = m->scale == GSSK_SCALE_LOG ? log(k > 0.0 ? k : 1e-300) : k;
+  double u = (v - m->lo) / (m->hi - m->lo);
+  return u < 0.0 ? 0.0 : (u > 1.0 ? 1.0 : u);
+}
+
+// dk/du, to carry k-gradients over to the coordinates
+static double param_dk(const ParamMap *m, double u) {
+  if (!m->unit)
+    return 1.0;
+  double dk = m->hi - m->lo;
+  return m->scale == GSSK_SCALE_LOG ? param_to_k(m, u) * dk : dk;
+}
+
+static double param_lower(const ParamMap *m, double k_min) {
+  return m->unit ? 0.0 : k_min;
+}
+
+static double param_upper(const ParamMap *m) {
+  return m->unit ? 1.0 : INFINITY;
+}
+
+// --- Experiments ---
+
+// Data sets fitted together, each observed from its own initial state
+typedef struct {
+  GSSK_Workspace *ws;
+  size_t count;
+  gssk_schedule *schedules; /**< count */
+  double *initial;      /**< count * node_count, NULL for the model's own */
+  size_t observations;  /**< Scheduled over all experiments */
+  size_t last_step;     /**< Summed over all experiments */
+} ExperimentSet;
+
+static void experiment_set_free(ExperimentSet *set) {
+  if (set->schedules) {
+    for (size_t e = 0; e < set->count; e++)
+      gssk_schedule_free(&set->schedules[e]);
+  }
+  gssk_ws_free(set->ws, set->schedules);
+  gssk_ws_free(set->ws, set->initial);
+  memset(set, 0, sizeof(*set));
+}
+
+static GSSK_Status experiment_set_init(ExperimentSet *set,
+                                       GSSK_Instance *inst,
+                                       const GSSK_Experiment *experiments,
+                                       size_t count, GSSK_Workspace *ws) {
+  memset(set, 0, sizeof(*set));
+  set->ws = ws;
+  size_t nodes = GSSK_GetStateSize(inst);
+  bool overrides = false;
+  for (size_t e = 0; e < count; e++) {
+    if (!experiments[e].obs || experiments[e].obs_count == 0 ||
+        (experiments[e].override_count > 0 &&
+         (!experiments[e].node_ids || !experiments[e].initial_values)))
+      return GSSK_ERR_UNKNOWN;
+    overrides = overrides || experiments[e].override_count > 0;
+  }
+
+  set->schedules = gssk_ws_calloc(ws, count, sizeof(gssk_schedule));
+  if (overrides)
+    set->initial = gssk_ws_alloc(ws, count * nodes * sizeof(double));
+  if (!set->schedules || (overrides && !set->initial)) {
+    experiment_set_free(set);
+    return GSSK_ERR_MALLOC_FAILED;
+  }
+  set->count = count;
+  for (size_t e = 0; e < count; e++) {
+    const GSSK_Experiment *x = &experiments[e];
+    GSSK_Status status = gssk_schedule_compile(&set->schedules[e], inst,
+                                               x->obs, x->obs_count, ws);
+    if (status != GSSK_SUCCESS) {
+      experiment_set_free(set);
+      return status;
+    }
+    set->observations += set->schedules[e].count;
+    set->last_step += set->schedules[e].last_step;
+    if (!set->initial)
+      continue;
+    double *initial = &set->initial[e * nodes];
+    for (size_t i = 0; i < nodes; i++)
+      initial[i] = GSSK_GetInitialValue(inst, i);
+    for (size_t i = 0; i < x->override_count; i++) {
+      int idx = GSSK_FindNodeIdx(inst, x->node_ids[i]);
+      if (idx == -1) {
+        experiment_set_free(set);
+        return GSSK_ERR_UNKNOWN;
+      }
+      initial[idx] = x->initial_values[i];
+    }
+  }
+  return GSSK_SUCCESS;
+}
+
+// --- Parameter Calibration ---
+
+typedef struct {
+  const ExperimentSet *data;
+  const ParamSpace *space;
+  size_t param_count;
+  double *partial_sse;    /**< experiments * batch, with several */
+  size_t *partial_points; /**< experiments * batch, with several */
+} OptimizerContext;
+
+// Members integrated in lockstep by one worker task
+#define CALIBRATION_LANES 8
+
+// Per-thread evaluation scratch
+typedef struct {
+  gssk_batch batch;
+  double *prev_state; /**< node_count * lanes */
+  double *sse;        /**< lanes */
+  size_t *points;     /**< lanes */
+  unsigned char *done; /**< lanes, set once a member is aborted */
+  size_t aborted;     /**< Evaluations cut short so far */
+  size_t skipped;     /**< Evaluations never started, the run being
+                           cancelled (counted on the first experiment) */
+} CalibrationWorker;
+
+static void calibration_workers_free(CalibrationWorker *w, size_t count,
+                                     GSSK_Workspace *ws) {
+  if (!w)
+    return;
+  for (size_t i = 0; i < count; i++) {
+    gssk_batch_free(&w[i].batch);
+    gssk_ws_free(ws, w[i].prev_state);
+    gssk_ws_free(ws, w[i].sse);
+    gssk_ws_free(ws, w[i].points);
+    gssk_ws_free(ws, w[i].done);
+  }
+  gssk_ws_free(ws, w);
+}
+
+static CalibrationWorker *calibration_workers_alloc(GSSK_Instance *inst,
+                                                    size_t count,
+                                                    GSSK_Workspace *ws) {
+  CalibrationWorker *w = gssk_ws_calloc(ws, count, sizeof(CalibrationWorker));
+  if (!w)
+    return NULL;
+  size_t L = CALIBRATION_LANES;
+  for (size_t i = 0; i < count; i++) {
+    w[i].prev_state =
+        gssk_ws_alloc(ws, GSSK_GetStateSize(inst) * L * sizeof(double));
+    w[i].sse = gssk_ws_alloc(ws, L * sizeof(double));
+    w[i].points = gssk_ws_alloc(ws, L * sizeof(size_t));
+    w[i].done = gssk_ws_alloc(ws, L);
+    if (gssk_batch_init(&w[i].batch, inst, L, ws) != GSSK_SUCCESS ||
+        !w[i].prev_state || !w[i].sse || !w[i].points || !w[i].done) {
+      calibration_workers_free(w, count, ws);
+      return NULL;
+    }
+  }
+  return w;
+}
+
+// Member states at an observed step with the squared error up to it, so
+// that a calibration session can extend members' scores over new
+// observations without integrating from the start
+typedef struct {
+  size_t step;     /**< Step the states belong to */
+  double *state;   /**< members * node_count */
+  double *sse;     /**< members */
+  size_t *points;  /**< members */
+} FitnessCheckpoints;
+
+// Squared error of one experiment's observations for up to
+// CALIBRATION_LANES parameter vectors, integrated together and scored in
+// the same sweep, left in w->sse and w->points (see worker_fitness).
+// With 'resume', members continue from its states and scores instead of
+// the initial state; with 'save', the states at the last observed step are
+// stored there (both single-experiment only).
+// Integration stops at the last observed step, and each step only visits
+// its own scheduled observations. A member that diverges stops
+// accumulating, as the scalar path would.
+//
+// 'bounds' (optional) holds the fitness each member must reach to be
+// accepted. Since the squared error only grows, a member whose partial SSE
+// already exceeds bound * (observations of all experiments) can never
+// reach it; it is abandoned (w->done) with fitness INFINITY. Abandoned or
+// diverged members at the end of the block are dropped from the lockstep
+// integration, and the sweep ends once none is left.
+static void calculate_fitness(const OptimizerContext *ctx,
+                              CalibrationWorker *w, size_t experiment,
+                              const double *vectors, const double *bounds,
+                              size_t members,
+                              const FitnessCheckpoints *resume,
+                              FitnessCheckpoints *save) {
+  const gssk_schedule *sched = &ctx->data->schedules[experiment];
+  gssk_batch *b = &w->batch;
+  GSSK_Instance *inst = b->model;
+  size_t L = b->lanes;
+  size_t node_count = GSSK_GetStateSize(inst);
+  double dt = GSSK_GetDt(inst);
+  const ParamSpace *space = ctx->space;
+  for (size_t e = 0; e < GSSK_GetEdgeCount(inst); e++) {
+    for (size_t m = 0; m < members; m++)
+      b->k[e * L + m] = space->base_k[e];
+  }
+  for (size_t m = 0; m < members; m++) {
+    for (size_t i = 0; i < ctx->param_count; i++)
+      b->k[space->edges[i] * L + m] =
+          param_to_k(&space->maps[i], vectors[m * ctx->param_count + i]);
+    w->sse[m] = 0.0;
+    w->points[m] = 0;
+    w->done[m] = 0;
+  }
+  gssk_batch_reset(b, members,
+                   ctx->data->initial
+                       ? &ctx->data->initial[experiment * node_count]
+                       : NULL);
+  size_t first_step = 1;
+  if (resume) {
+    for (size_t m = 0; m < members; m++) {
+      for (size_t i = 0; i < node_count; i++)
+        b->state[i * L + m] = resume->state[m * node_count + i];
+      w->sse[m] = resume->sse[m];
+      w->points[m] = resume->points[m];
+    }
+    first_step = resume->step + 1;
+  }
+
+  for (size_t s = first_step; s <= sched->last_step && b->members > 0; s++) {
+    size_t first = sched->step_start[s];
+    size_t end = sched->step_start[s + 1];
+    if (first < end)
+      memcpy(w->prev_state, b->state, node_count * L * sizeof(double));
+    gssk_batch_step(b, dt);
+    if (first == end)
+      continue;
+
+    size_t active = b->members;
+    for (size_t j = first; j < end; j++) {
+      const double *prev = &w->prev_state[(size_t)sched->node[j] * L];
+      const double *cur = &b->state[(size_t)sched->node[j] * L];
+      double weight = sched->weight[j];
+      double value = sched->value[j];
+      for (size_t m = 0; m < active; m++) {
+        if (b->diverged[m] || w->done[m])
+          continue;
+        double diff = prev[m] + weight * (cur[m] - prev[m]) - value;
+        w->sse[m] += diff * diff;
+        w->points[m]++;
+      }
+    }
+
+    if (bounds) {
+      for (size_t m = 0; m < active; m++) {
+        if (!w->done[m] && !b->diverged[m] &&
+            w->sse[m] > bounds[m] * (double)ctx->data->observations) {
+          w->done[m] = 1;
+          w->aborted++;
+        }
+      }
+    }
+    while (b->members > 0 &&
+           (w->done[b->members - 1] || b->diverged[b->members - 1]))
+      b->members--;
+  }
+
+  if (save) {
+    for (size_t m = 0; m < members; m++) {
+      for (size_t i = 0; i < node_count; i++)
+        save->state[m * node_count + i] = b->state[i * L + m];
+      save->sse[m] = w->sse[m];
+      save->points[m] = w->points[m];
+    }
+  }
+}
+
+// Mean squared error of member m after calculate_fitness
+static double worker_fitness(const CalibrationWorker *w, size_t m) {
+  if (w->done[m])
+    return INFINITY;
+  return w->points[m] > 0 ? w->sse[m] / w->points[m] : INFINITY;
+}
+
+// One generation's worth of fitness evaluations, in blocks of
+// CALIBRATION_LANES members spread over the workers. With several
+// experiments, each block is one task per experiment, and the partial
+// squared errors are pooled once all are done.
+typedef struct {
+  const OptimizerContext *ctx;
+  CalibrationWorker *workers;
+  size_t count;
+  const double *vectors; /**< count * param_count */
+  const double *bounds;  /**< Fitness to beat per vector, NULL for none */
+  double *fitness;       /**< count */
+  const FitnessCheckpoints *resume; /**< count, NULL to start afresh */
+  FitnessCheckpoints *save;         /**< count, NULL for none */
+  const gssk_monitor *monitor;      /**< Blocks are skipped once it
+                                         expires, NULL to run them all */
+} FitnessBatch;
+
+static void checkpoints_copy(FitnessCheckpoints *to, size_t i,
+                             const FitnessCheckpoints *from, size_t j,
+                             size_t node_count) {
+  memcpy(&to->state[i * node_count], &from->state[j * node_count],
+         node_count * sizeof(double));
+  to->sse[i] = from->sse[j];
+  to->points[i] = from->points[j];
+}
+
+// Checkpoints of members [first, ...) of a batch
+static FitnessCheckpoints checkpoints_view(const FitnessCheckpoints *c,
+                                           size_t first, size_t node_count) {
+  FitnessCheckpoints view = {c->step, &c->state[first * node_count],
+                             &c->sse[first], &c->points[first]};
+  return view;
+}
+
+static void fitness_task(void *arg, size_t task, size_t worker) {
+  FitnessBatch *b = arg;
+  const OptimizerContext *ctx = b->ctx;
+  size_t experiments = ctx->data->count;
+  size_t e = task % experiments;
+  size_t first = task / experiments * CALIBRATION_LANES;
+  size_t members = b->count - first;
+  if (members > CALIBRATION_LANES)
+    members = CALIBRATION_LANES;
+  // A cancelled or timed-out run leaves the rest of the batch unscored
+  if (b->monitor && gssk_monitor_expired(b->monitor)) {
+    if (e == 0)
+      b->workers[worker].skipped += members;
+    for (size_t m = 0; m < members; m++) {
+      if (experiments == 1) {
+        b->fitness[first + m] = INFINITY;
+      } else {
+        ctx->partial_sse[e * b->count + first + m] = INFINITY;
+        ctx->partial_points[e * b->count + first + m] = 0;
+      }
+    }
+    return;
+  }
+  CalibrationWorker *w = &b->workers[worker];
+  size_t nodes = w->batch.model->node_count;
+  FitnessCheckpoints resume, save;
+  if (b->resume)
+    resume = checkpoints_view(b->resume, first, nodes);
+  if (b->save)
+    save = checkpoints_view(b->save, first, nodes);
+  calculate_fitness(ctx, w, e, &b->vectors[first * ctx->param_count],
+                    b->bounds ? &b->bounds[first] : NULL, members,
+                    b->resume ? &resume : NULL, b->save ? &save : NULL);
+  for (size_t m = 0; m < members; m++) {
+    if (experiments == 1) {
+      b->fitness[first + m] = worker_fitness(w, m);
+    } else {
+      size_t slot = e * b->count + first + m;
+      ctx->partial_sse[slot] = w->done[m] ? INFINITY : w->sse[m];
+      ctx->partial_points[slot] = w->points[m];
+    }
+  }
+}
+
+void GSSK_InitCalibrationOptions(GSSK_CalibrationOptions *opts) {
+  if (!opts)
+    return;
+  opts->iterations = 100;
+  opts->population = 20;
+  opts->F = 0.8;
+  opts->CR = 0.9;
+  opts->k_min = 0.0;
+  opts->k_max = 10.0;
+  opts->seed = 0;
+  opts->threads = 0;
+  opts->workspace = NULL;
+  opts->optimizer = GSSK_OPTIMIZER_DE;
+  opts->restarts = 9;
+  opts->screen_factor = 0;
+  opts->screen_horizon = 1.0;
+  opts->screen_promote = 0.2;
+  opts->screen_correlation = 0.3;
+  opts->cache_size = 0;
+  opts->cache_tolerance = 0.0;
+  opts->control = NULL;
+}
+
+// Multi-fidelity screening. DE trials are first scored on a cheap variant
+// of the model (Euler at a coarser dt, optionally over a truncated
+// horizon); only those the screen ranks well, or predicts to beat the
+// member they would replace, are evaluated at full fidelity. Screening is
+// dropped for good once the coarse and fine ranks of the promoted trials
+// stop agreeing.
+typedef struct {
+  GSSK_Instance model;   /**< Shallow copy of the instance, coarse config */
+  ExperimentSet data;
+  OptimizerContext ctx;
+  CalibrationWorker *pool;
+  double cost;           /**< Screen cost relative to a full evaluation */
+  bool active;
+  double *vectors;       /**< Promoted trials, batch * param_count */
+  double *bounds;        /**< batch */
+  double *fitness;       /**< batch */
+  size_t *picked;        /**< Trial behind each promoted vector, batch */
+  size_t *order;         /**< batch */
+  double *rank_a;        /**< batch */
+  double *rank_b;        /**< batch */
+} CalibrationScreen;
+
+// Fewest promoted trials that make a rank correlation worth checking
+#define SCREEN_MIN_SAMPLE 5
+
+// Fitness memo. Optimizers keep re-proposing vectors they have already
+// scored, most often a DE trial clipped back onto the bound its target
+// sits on. Keys are the optimizer coordinates quantized to the tolerance
+// (their bit patterns when it is 0); the table is open-addressed with a
+// short probe window and overwrites the home slot once that window is
+// full, so it never grows. It is consulted on the calling thread around
+// each batch: the workers share it without locks, and results do not
+// depend on the thread count.
+typedef struct {
+  size_t capacity;     /**< Slots, a power of two */
+  size_t n;            /**< Key length, the parameter count */
+  double tolerance;
+  int64_t *keys;       /**< capacity * n */
+  double *fitness;     /**< capacity */
+  unsigned char *used; /**< capacity */
+  int64_t *key;        /**< n, the key of the vector at hand */
+  double *vectors;     /**< A batch's misses, batch * n */
+  double *bounds;      /**< batch */
+  double *scores;      /**< batch */
+  size_t *missed;      /**< Candidate behind each miss, batch */
+  size_t hits;
+} FitnessCache;
+
+#define FITNESS_CACHE_PROBES 8
+
+static void fitness_cache_free(FitnessCache *c, GSSK_Workspace *ws) {
+  gssk_ws_free(ws, c->keys);
+  gssk_ws_free(ws, c->fitness);
+  gssk_ws_free(ws, c->used);
+  gssk_ws_free(ws, c->key);
+  gssk_ws_free(ws, c->vectors);
+  gssk_ws_free(ws, c->bounds);
+  gssk_ws_free(ws, c->scores);
+  gssk_ws_free(ws, c->missed);
+  memset(c, 0, sizeof(*c));
+}
+
+static GSSK_Status fitness_cache_init(FitnessCache *c, size_t entries,
+                                      double tolerance, size_t n,
+                                      size_t batch, GSSK_Workspace *ws) {
+  memset(c, 0, sizeof(*c));
+  c->capacity = 1;
+  while (c->capacity < entries)
+    c->capacity *= 2;
+  c->n = n;
+  c->tolerance = tolerance;
+  c->keys = gssk_ws_alloc(ws, c->capacity * n * sizeof(int64_t));
+  c->fitness = gssk_ws_alloc(ws, c->capacity * sizeof(double));
+  c->used = gssk_ws_calloc(ws, c->capacity, 1);
+  c->key = gssk_ws_alloc(ws, n * sizeof(int64_t));
+  c->vectors = gssk_ws_alloc(ws, batch * n * sizeof(double));
+  c->bounds = gssk_ws_alloc(ws, batch * sizeof(double));
+  c->scores = gssk_ws_alloc(ws, batch * sizeof(double));
+  c->missed = gssk_ws_alloc(ws, batch * sizeof(size_t));
+  if (!c->keys || !c->fitness || !c->used || !c->key || !c->vectors ||
+      !c->bounds || !c->scores || !c->missed) {
+    fitness_cache_free(c, ws);
+    return GSSK_ERR_MALLOC_FAILED;
+  }
+  return GSSK_SUCCESS;
+}
+
+// Quantize x into c->key and return its hash
+static uint64_t fitness_cache_key(FitnessCache *c, const double *x) {
+  uint64_t h = 0x9e3779b97f4a7c15ULL;
+  for (size_t i = 0; i < c->n; i++) {
+    double v = x[i] == 0.0 ? 0.0 : x[i]; // -0 and +0 share a key
+    double q = c->tolerance > 0.0 ? floor(v / c->tolerance + 0.5) : NAN;
+    if (fabs(q) < 9.0e18)
+      c->key[i] = (int64_t)q;
+    else
+      memcpy(&c->key[i], &v, sizeof(v));
+    h = (h ^ (uint64_t)c->key[i]) * 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+  }
+  return h;
+}
+
+// Slot holding c->key, or the first free one in its probe window;
+// capacity when there is neither
+static size_t fitness_cache_slot(const FitnessCache *c, uint64_t hash) {
+  size_t mask = c->capacity - 1;
+  for (size_t p = 0; p < FITNESS_CACHE_PROBES && p < c->capacity; p++) {
+    size_t s = (size_t)(hash + p) & mask;
+    if (!c->used[s] ||
+        memcmp(&c->keys[s * c->n], c->key, c->n * sizeof(int64_t)) == 0)
+      return s;
+  }
+  return c->capacity;
+}
+
+static bool fitness_cache_lookup(FitnessCache *c, const double *x,
+                                 double *fitness) {
+  size_t s = fitness_cache_slot(c, fitness_cache_key(c, x));
+  if (s == c->capacity || !c->used[s])
+    return false;
+  *fitness = c->fitness[s];
+  return true;
+}
+
+static void fitness_cache_insert(FitnessCache *c, const double *x,
+                                 double fitness) {
+  uint64_t hash = fitness_cache_key(c, x);
+  size_t s = fitness_cache_slot(c, hash);
+  if (s == c->capacity)
+    s = (size_t)hash & (c->capacity - 1);
+  memcpy(&c->keys[s * c->n], c->key, c->n * sizeof(int64_t));
+  c->fitness[s] = fitness;
+  c->used[s] = 1;
+}
+
+// State shared by the optimizers behind GSSK_CalibrateEx
+typedef struct {
+  const GSSK_CalibrationOptions *opts;
+  const OptimizerContext *ctx;
+  GSSK_Workspace *ws;
+  CalibrationWorker *pool;
+  size_t workers;
+  gssk_rng rng;
+  size_t budget;        /**< Fitness evaluations allowed */
+  size_t evaluations;
+  size_t generations;
+  double best_fitness;
+  double *best_params;  /**< param_count */
+  CalibrationScreen *screen; /**< NULL without multi-fidelity screening */
+  FitnessCache *cache;  /**< NULL without a fitness memo */
+  gssk_monitor monitor; /**< The caller's control block */
+  size_t progress_start; /**< Evaluations before this call */
+  size_t progress_total; /**< Evaluations this call plans */
+  double *best_k;       /**< Edge count, for progress reports; NULL
+                             without a control block */
+  const FitnessCheckpoints *resume; /**< States evaluations continue
+                                         from, NULL to start afresh */
+  FitnessCheckpoints *save;  /**< Where evaluations leave their states,
+                                  NULL for nowhere */
+  FitnessCheckpoints *member_checkpoints; /**< Sessions: the DE population's */
+  FitnessCheckpoints *trial_checkpoints;  /**< Sessions: the trials' */
+  size_t screened;      /**< Screen evaluations */
+  size_t screen_dropped; /**< Generation that dropped screening, 0 if none */
+} CalibrationRun;
+
+// Stable ranking of fitness[0..count) into order
+static void rank_fitness(const double *fitness, size_t count, size_t *order) {
+  for (size_t m = 0; m < count; m++) {
+    size_t j = m;
+    for (; j > 0 && fitness[order[j - 1]] > fitness[m]; j--)
+      order[j] = order[j - 1];
+    order[j] = m;
+  }
+}
+
+// Ranks of v (0-based, tied values sharing their mean rank)
+static void midranks(const double *v, size_t m, size_t *order, double *rank) {
+  rank_fitness(v, m, order);
+  for (size_t r = 0; r < m;) {
+    size_t end = r + 1;
+    while (end < m && v[order[end]] == v[order[r]])
+      end++;
+    for (size_t j = r; j < end; j++)
+      rank[order[j]] = 0.5 * (double)(r + end - 1);
+    r = end;
+  }
+}
+
+// Spearman rank correlation of a and b: the Pearson correlation of their
+// midranks, 0 when either is constant
+static double rank_correlation(const double *a, const double *b, size_t m,
+                               size_t *order, double *rank_a,
+                               double *rank_b) {
+  midranks(a, m, order, rank_a);
+  midranks(b, m, order, rank_b);
+  double mean = 0.5 * (double)(m - 1);
+  double sab = 0.0, saa = 0.0, sbb = 0.0;
+  for (size_t i = 0; i < m; i++) {
+    double da = rank_a[i] - mean, db = rank_b[i] - mean;
+    sab += da * db;
+    saa += da * da;
+    sbb += db * db;
+  }
+  return saa > 0.0 && sbb > 0.0 ? sab / sqrt(saa * sbb) : 0.0;
+}
+
+// Score 'count' vectors in blocks of CALIBRATION_LANES spread over the pool.
+// 'bounds', 'resume' and 'save' are as for calculate_fitness; blocks not
+// started when 'monitor' expires score INFINITY.
+static void evaluate_batch(const OptimizerContext *ctx,
+                           CalibrationWorker *pool, size_t workers,
+                           const double *vectors, const double *bounds,
+                           size_t count, double *fitness,
+                           const FitnessCheckpoints *resume,
+                           FitnessCheckpoints *save,
+                           const gssk_monitor *monitor) {
+  FitnessBatch batch = {ctx,     pool,    count,  vectors, bounds,
+                        fitness, resume, save,   monitor};
+  size_t experiments = ctx->data->count;
+  size_t tasks =
+      (count + CALIBRATION_LANES - 1) / CALIBRATION_LANES * experiments;
+  gssk_parallel_for(tasks, workers < tasks ? workers : tasks, fitness_task,
+                    &batch);
+  if (experiments == 1)
+    return;
+  for (size_t m = 0; m < count; m++) {
+    double sse = 0.0;
+    size_t points = 0;
+    for (size_t e = 0; e < experiments; e++) {
+      sse += ctx->partial_sse[e * count + m];
+      points += ctx->partial_points[e * count + m];
+    }
+    fitness[m] = points > 0 ? sse / (double)points : INFINITY;
+  }
+}
+
+// Evaluations the workers skipped for cancellation so far
+static size_t calibration_skipped(const CalibrationRun *run) {
+  size_t skipped = 0;
+  for (size_t w = 0; w < run->workers; w++)
+    skipped += run->pool[w].skipped;
+  return skipped;
+}
+
+// Report the best so far when progress is due, and latch a cancellation
+// or expired time budget for the optimizer loops to see
+static void calibration_progress(CalibrationRun *run) {
+  gssk_monitor *mon = &run->monitor;
+  size_t done = run->evaluations - run->progress_start;
+  if (run->best_k && gssk_monitor_due(mon, done)) {
+    const ParamSpace *space = run->ctx->space;
+    memcpy(run->best_k, space->base_k,
+           run->pool[0].batch.model->edge_count * sizeof(double));
+    for (size_t i = 0; i < space->count; i++)
+      run->best_k[space->edges[i]] =
+          param_to_k(&space->maps[i], run->best_params[i]);
+    gssk_monitor_report(mon, done, run->progress_total, run->best_fitness,
+                        run->best_k);
+  }
+  gssk_monitor_check(mon);
+}
+
+// Evaluate a generation's 'count' candidates as one batch and keep the
+// best seen so far. Candidates are scored in order whatever the thread
+// count, so ties resolve the same way. With a fitness memo only the
+// candidates it does not know are simulated; those that ran to the end
+// are remembered (an aborted score is only a bound).
+static void calibration_evaluate(CalibrationRun *run, const double *vectors,
+                                 const double *bounds, size_t count,
+                                 double *fitness) {
+  size_t n = run->ctx->param_count;
+  FitnessCache *c = run->cache;
+  size_t skipped = calibration_skipped(run);
+  if (c && !run->resume && !run->save) {
+    size_t misses = 0;
+    for (size_t i = 0; i < count; i++) {
+      if (fitness_cache_lookup(c, &vectors[i * n], &fitness[i])) {
+        c->hits++;
+        continue;
+      }
+      memcpy(&c->vectors[misses * n], &vectors[i * n], n * sizeof(double));
+      if (bounds)
+        c->bounds[misses] = bounds[i];
+      c->missed[misses++] = i;
+    }
+    evaluate_batch(run->ctx, run->pool, run->workers, c->vectors,
+                   bounds ? c->bounds : NULL, misses, c->scores, NULL, NULL,
+                   &run->monitor);
+    for (size_t m = 0; m < misses; m++) {
+      fitness[c->missed[m]] = c->scores[m];
+      if (isfinite(c->scores[m]))
+        fitness_cache_insert(c, &c->vectors[m * n], c->scores[m]);
+    }
+  } else {
+    // Checkpointed batches (sessions) are always completed, so the saved
+    // states stay whole; those runs stop between generations
+    evaluate_batch(run->ctx, run->pool, run->workers, vectors, bounds, count,
+                   fitness, run->resume, run->save,
+                   run->resume || run->save ? NULL : &run->monitor);
+  }
+  run->evaluations += count - (calibration_skipped(run) - skipped);
+  for (size_t i = 0; i < count; i++) {
+    if (fitness[i] < run->best_fitness) {
+      run->best_fitness = fitness[i];
+      memcpy(run->best_params, &vectors[i * n], n * sizeof(double));
+    }
+  }
+  calibration_progress(run);
+}
+
+// Evaluations spent so far, screens counted at their relative cost
+static double calibration_spent(const CalibrationRun *run) {
+  double spent = (double)run->evaluations;
+  if (run->screen)
+    spent += (double)run->screened * run->screen->cost;
+  return spent;
+}
+
+// Screen scores of freshly evaluated members, when screening
+static void calibration_screen_members(CalibrationRun *run,
+                                       const double *vectors, size_t count,
+                                       double *screen_fitness) {
+  CalibrationScreen *s = run->screen;
+  if (!s || !s->active)
+    return;
+  evaluate_batch(&s->ctx, s->pool, run->workers, vectors, NULL, count,
+                 screen_fitness, NULL, NULL, NULL);
+  run->screened += count;
+}
+
+// Score DE trials against the members they would replace, whose fitness
+// (and screen score) is at the same index. Without screening every trial
+// is evaluated, abandoning those that cannot win. With it, the trials in
+// the promoted fraction by screen rank, or screening at least as well as
+// their member, are evaluated and the rest are rejected with fitness
+// INFINITY; 'trial_screen' receives every trial's screen score.
+static void calibration_evaluate_trials(CalibrationRun *run,
+                                        const double *trials,
+                                        const double *member_fitness,
+                                        const double *member_screen,
+                                        size_t count, double *fitness,
+                                        double *trial_screen) {
+  CalibrationScreen *s = run->screen;
+  if (!s || !s->active) {
+    calibration_evaluate(run, trials, member_fitness, count, fitness);
+    return;
+  }
+  size_t n = run->ctx->param_count;
+  evaluate_batch(&s->ctx, s->pool, run->workers, trials, NULL, count,
+                 trial_screen, NULL, NULL, NULL);
+  run->screened += count;
+
+  rank_fitness(trial_screen, count, s->order);
+  size_t quota = (size_t)ceil(run->opts->screen_promote * (double)count);
+  size_t promoted = 0;
+  for (size_t r = 0; r < count; r++) {
+    size_t i = s->order[r];
+    fitness[i] = INFINITY;
+    if (r < quota || trial_screen[i] <= member_screen[i])
+      s->picked[promoted++] = i;
+  }
+  // Promoted trials keep their generation order, so the full evaluation
+  // sees them as DE would
+  for (size_t p = 1; p < promoted; p++) {
+    size_t i = s->picked[p], j = p;
+    for (; j > 0 && s->picked[j - 1] > i; j--)
+      s->picked[j] = s->picked[j - 1];
+    s->picked[j] = i;
+  }
+  for (size_t p = 0; p < promoted; p++)
+    memcpy(&s->vectors[p * n], &trials[s->picked[p] * n], n * sizeof(double));
+  calibration_evaluate(run, s->vectors, NULL, promoted, s->fitness);
+
+  // Rank agreement over the promoted trials, which run to the end so that
+  // their full scores are comparable
+  for (size_t p = 0; p < promoted; p++) {
+    fitness[s->picked[p]] = s->fitness[p];
+    s->bounds[p] = trial_screen[s->picked[p]];
+  }
+  if (promoted >= SCREEN_MIN_SAMPLE &&
+      rank_correlation(s->bounds, s->fitness, promoted, s->order,
+                       s->rank_a, s->rank_b) <
+          run->opts->screen_correlation) {
+    s->active = false;
+    run->screen_dropped = run->generations + 1;
+  }
+}
+
+static void calibration_screen_free(CalibrationScreen *s, size_t workers,
+                                    GSSK_Workspace *ws) {
+  calibration_workers_free(s->pool, workers, ws);
+  experiment_set_free(&s->data);
+  gssk_ws_free(ws, s->vectors);
+  gssk_ws_free(ws, s->bounds);
+  gssk_ws_free(ws, s->fitness);
+  gssk_ws_free(ws, s->picked);
+  gssk_ws_free(ws, s->order);
+  gssk_ws_free(ws, s->rank_a);
+  gssk_ws_free(ws, s->rank_b);
+  memset(s, 0, sizeof(*s));
+}
+
+// The screen model shares the instance's nodes and edges, with its own
+// configuration, schedules and worker scratch
+static GSSK_Status calibration_screen_init(CalibrationScreen *s,
+                                           GSSK_Instance *inst,
+                                           const GSSK_Experiment *experiments,
+                                           size_t experiment_count,
+                                           const CalibrationRun *run,
+                                           size_t batch) {
+  const GSSK_CalibrationOptions *opts = run->opts;
+  GSSK_Workspace *ws = run->ws;
+  size_t n = run->ctx->param_count;
+  memset(s, 0, sizeof(*s));
+  s->model = *inst;
+  s->model.config.dt = inst->config.dt * (double)opts->screen_factor;
+  s->model.config.method = GSSK_METHOD_EULER;
+  s->model.config.t_end =
+      inst->config.t_start +
+      opts->screen_horizon * (inst->config.t_end - inst->config.t_start);
+
+  GSSK_Status status = experiment_set_init(&s->data, &s->model, experiments,
+                                           experiment_count, ws);
+  if (status != GSSK_SUCCESS)
+    return status;
+  s->ctx = *run->ctx;
+  s->ctx.data = &s->data;
+  s->pool = calibration_workers_alloc(&s->model, run->workers, ws);
+  s->vectors = gssk_ws_alloc(ws, batch * n * sizeof(double));
+  s->bounds = gssk_ws_alloc(ws, batch * sizeof(double));
+  s->fitness = gssk_ws_alloc(ws, batch * sizeof(double));
+  s->picked = gssk_ws_alloc(ws, batch * sizeof(size_t));
+  s->order = gssk_ws_alloc(ws, batch * sizeof(size_t));
+  s->rank_a = gssk_ws_alloc(ws, batch * sizeof(double));
+  s->rank_b = gssk_ws_alloc(ws, batch * sizeof(double));
+  if (!s->pool || !s->vectors || !s->bounds || !s->fitness || !s->picked ||
+      !s->order || !s->rank_a || !s->rank_b) {
+    calibration_screen_free(s, run->workers, ws);
+    return GSSK_ERR_MALLOC_FAILED;
+  }
+
+  // Relative cost from the steps and stages each integration needs; a
+  // screen that sees no observation has nothing to say
+  double stages = inst->config.method == GSSK_METHOD_RK4 ? 4.0 : 1.0;
+  size_t full_steps = run->ctx->data->last_step;
+  s->cost = full_steps > 0 ? (double)s->data.last_step /
+                                 ((double)full_steps * stages)
+                           : 1.0;
+  s->active = s->data.observations > 0;
+  return GSSK_SUCCESS;
+}
+
+// DE population and generation scratch; calibration sessions keep it
+// between runs
+typedef struct {
+  double *population;     /**< pop_size * param_count */
+  double *trials;         /**< pop_size * param_count */
+  double *fitness;        /**< pop_size */
+  double *trial_fitness;  /**< pop_size */
+  double *screen_fitness; /**< pop_size */
+  double *trial_screen;   /**< pop_size */
+} DEState;
+
+static void de_state_free(DEState *de, GSSK_Workspace *ws) {
+  gssk_ws_free(ws, de->population);
+  gssk_ws_free(ws, de->trials);
+  gssk_ws_free(ws, de->fitness);
+  gssk_ws_free(ws, de->trial_fitness);
+  gssk_ws_free(ws, de->screen_fitness);
+  gssk_ws_free(ws, de->trial_screen);
+  memset(de, 0, sizeof(*de));
+}
+
+static GSSK_Status de_state_alloc(DEState *de, size_t pop_size, size_t n,
+                                  GSSK_Workspace *ws) {
+  de->population = gssk_ws_alloc(ws, pop_size * n * sizeof(double));
+  de->trials = gssk_ws_alloc(ws, pop_size * n * sizeof(double));
+  de->fitness = gssk_ws_alloc(ws, pop_size * sizeof(double));
+  de->trial_fitness = gssk_ws_alloc(ws, pop_size * sizeof(double));
+  de->screen_fitness = gssk_ws_alloc(ws, pop_size * sizeof(double));
+  de->trial_screen = gssk_ws_alloc(ws, pop_size * sizeof(double));
+  if (!de->population || !de->trials || !de->fitness || !de->trial_fitness ||
+      !de->screen_fitness || !de->trial_screen) {
+    de_state_free(de, ws);
+    return GSSK_ERR_MALLOC_FAILED;
+  }
+  for (size_t i = 0; i < pop_size; i++)
+    de->screen_fitness[i] = de->trial_screen[i] = INFINITY;
+  return GSSK_SUCCESS;
+}
+
+// Initialize Population: edges with a calibration range are searched on
+// [0, 1] over that range, the others over [k_min, k_max]
+static void de_init(CalibrationRun *run, DEState *de) {
+  const GSSK_CalibrationOptions *opts = run->opts;
+  const ParamSpace *space = run->ctx->space;
+  size_t pop_size = opts->population;
+  size_t n = run->ctx->param_count;
+  for (size_t i = 0; i < pop_size * n; i++) {
+    double u = gssk_rng_uniform(&run->rng);
+    de->population[i] = space->maps[i % n].unit
+                            ? u
+                            : opts->k_min + u * (opts->k_max - opts->k_min);
+  }
+  run->save = run->member_checkpoints;
+  calibration_evaluate(run, de->population, NULL, pop_size, de->fitness);
+  run->save = NULL;
+  calibration_screen_members(run, de->population, pop_size,
+                             de->screen_fitness);
+}
+
+// DE Main Loop. Trials are drawn for the whole generation on this thread
+// and evaluated as one batch, then selected in member order, so the result
+// depends only on the seed and not on the thread count.
+// A trial only has to beat the member it would replace
+static void de_generations(CalibrationRun *run, DEState *de,
+                           int generations) {
+  const GSSK_CalibrationOptions *opts = run->opts;
+  const ParamSpace *space = run->ctx->space;
+  size_t pop_size = opts->population;
+  size_t n = run->ctx->param_count;
+  double *population = de->population;
+  double *trials = de->trials;
+  for (int generation = 0; generation < generations && !run->monitor.stopped;
+       generation++) {
+    for (size_t i = 0; i < pop_size; i++) {
+      // Mutation
+      size_t a, b, c;
+      do { a = gssk_rng_next(&run->rng) % pop_size; } while (a == i);
+      do {
+        b = gssk_rng_next(&run->rng) % pop_size;
+      } while (b == i || b == a);
+      do {
+        c = gssk_rng_next(&run->rng) % pop_size;
+      } while (c == i || c == a || c == b);
+
+      double *trial = &trials[i * n];
+      size_t R = gssk_rng_next(&run->rng) % n;
+      for (size_t j = 0; j < n; j++) {
+        if (gssk_rng_uniform(&run->rng) < opts->CR || j == R) {
+          trial[j] = population[a * n + j] +
+                     opts->F * (population[b * n + j] - population[c * n + j]);
+          // Boundary constraints
+          double lower = param_lower(&space->maps[j], opts->k_min);
+          double upper = param_upper(&space->maps[j]);
+          if (trial[j] < lower)
+            trial[j] = lower;
+          else if (trial[j] > upper)
+            trial[j] = upper;
+        } else {
+          trial[j] = population[i * n + j];
+        }
+      }
+    }
+
+    run->save = run->trial_checkpoints;
+    calibration_evaluate_trials(run, trials, de->fitness, de->screen_fitness,
+                                pop_size, de->trial_fitness,
+                                de->trial_screen);
+    run->save = NULL;
+    run->generations++;
+
+    // Selection
+    for (size_t i = 0; i < pop_size; i++) {
+      if (de->trial_fitness[i] <= de->fitness[i]) {
+        de->fitness[i] = de->trial_fitness[i];
+        de->screen_fitness[i] = de->trial_screen[i];
+        memcpy(&population[i * n], &trials[i * n], n * sizeof(double));
+        if (run->member_checkpoints)
+          checkpoints_copy(run->member_checkpoints, i,
+                           run->trial_checkpoints, i,
+                           run->pool[0].batch.model->node_count);
+      }
+    }
+  }
+}
+
+static GSSK_Status de_run(CalibrationRun *run) {
+  DEState de;
+  GSSK_Status status =
+      de_state_alloc(&de, run->opts->population, run->ctx->param_count,
+                     run->ws);
+  if (status != GSSK_SUCCESS)
+    return status;
+  de_init(run, &de);
+  de_generations(run, &de, run->opts->iterations);
+  de_state_free(&de, run->ws);
+  return GSSK_SUCCESS;
+}
+
+// --- Success-History Adaptive DE (L-SHADE) ---
+
+// Entries in the F / CR success history
+#define SHADE_MEMORY 6
+// Archive capacity as a multiple of the population
+#define SHADE_ARCHIVE_RATE 2.6
+// Fraction of the population eligible as 'pbest'
+#define SHADE_PBEST 0.11
+// The population shrinks linearly to this size over the budget
+#define SHADE_MIN_POPULATION 4
+
+// Each trial draws its F and CR around a random entry of the success
+// history, and mutates by current-to-pbest/1 with the second difference
+// vector partly drawn from an archive of replaced members. Successful
+// (F, CR) pairs update one history entry per generation, weighted by their
+// fitness improvement. The population shrinks linearly with the evaluations
+// spent, dropping its worst members. The history starts from opts->F and
+// opts->CR.
+static GSSK_Status shade_run(CalibrationRun *run) {
+  const GSSK_CalibrationOptions *opts = run->opts;
+  const ParamSpace *space = run->ctx->space;
+  GSSK_Workspace *ws = run->ws;
+  size_t pop_init = opts->population;
+  size_t n = run->ctx->param_count;
+  size_t archive_max = (size_t)(SHADE_ARCHIVE_RATE * (double)pop_init + 0.5);
+  const double pi = acos(-1.0);
+  GSSK_Status status = GSSK_SUCCESS;
+
+  double *population = gssk_ws_alloc(ws, pop_init * n * sizeof(double));
+  double *trials = gssk_ws_alloc(ws, pop_init * n * sizeof(double));
+  double *archive = gssk_ws_alloc(ws, archive_max * n * sizeof(double));
+  double *fitness = gssk_ws_alloc(ws, pop_init * sizeof(double));
+  double *trial_fitness = gssk_ws_alloc(ws, pop_init * sizeof(double));
+  double *trial_F = gssk_ws_alloc(ws, pop_init * sizeof(double));
+  double *trial_CR = gssk_ws_alloc(ws, pop_init * sizeof(double));
+  double *success_F = gssk_ws_alloc(ws, pop_init * sizeof(double));
+  double *success_CR = gssk_ws_alloc(ws, pop_init * sizeof(double));
+  double *success_w = gssk_ws_alloc(ws, pop_init * sizeof(double));
+  double *screen_fitness = gssk_ws_alloc(ws, pop_init * sizeof(double));
+  double *trial_screen = gssk_ws_alloc(ws, pop_init * sizeof(double));
+  size_t *order = gssk_ws_alloc(ws, pop_init * sizeof(size_t));
+  if (!population || !trials || !archive || !fitness || !trial_fitness ||
+      !trial_F || !trial_CR || !success_F || !success_CR || !success_w ||
+      !screen_fitness || !trial_screen || !order) {
+    status = GSSK_ERR_MALLOC_FAILED;
+    goto cleanup;
+  }
+  for (size_t i = 0; i < pop_init; i++)
+    screen_fitness[i] = trial_screen[i] = INFINITY;
+
+  // A negative CR entry is terminal: that entry only yields CR = 0
+  double memory_F[SHADE_MEMORY], memory_CR[SHADE_MEMORY];
+  for (size_t h = 0; h < SHADE_MEMORY; h++) {
+    memory_F[h] = opts->F;
+    memory_CR[h] = opts->CR;
+  }
+  size_t memory_next = 0;
+
+  for (size_t i = 0; i < pop_init * n; i++) {
+    double u = gssk_rng_uniform(&run->rng);
+    population[i] = space->maps[i % n].unit
+                        ? u
+                        : opts->k_min + u * (opts->k_max - opts->k_min);
+  }
+  calibration_evaluate(run, population, NULL, pop_init, fitness);
+  calibration_screen_members(run, population, pop_init, screen_fitness);
+
+  size_t pop_size = pop_init;
+  size_t archived = 0;
+  while (calibration_spent(run) + (double)pop_size <= (double)run->budget &&
+         !run->monitor.stopped) {
+    rank_fitness(fitness, pop_size, order);
+    size_t pbest = (size_t)(SHADE_PBEST * (double)pop_size + 0.5);
+    if (pbest < 2)
+      pbest = 2;
+
+    // Trials, drawn on this thread and evaluated as one batch
+    for (size_t i = 0; i < pop_size; i++) {
+      size_t h = gssk_rng_next(&run->rng) % SHADE_MEMORY;
+      double CR = 0.0;
+      if (memory_CR[h] >= 0.0) {
+        CR = memory_CR[h] + 0.1 * gssk_rng_normal(&run->rng);
+        CR = CR < 0.0 ? 0.0 : (CR > 1.0 ? 1.0 : CR);
+      }
+      double F;
+      do {
+        F = memory_F[h] +
+            0.1 * tan(pi * (gssk_rng_uniform(&run->rng) - 0.5));
+      } while (F <= 0.0);
+      if (F > 1.0)
+        F = 1.0;
+      trial_F[i] = F;
+      trial_CR[i] = CR;
+
+      const double *x = &population[i * n];
+      const double *best =
+          &population[order[gssk_rng_next(&run->rng) % pbest] * n];
+      size_t r1, r2;
+      do {
+        r1 = gssk_rng_next(&run->rng) % pop_size;
+      } while (r1 == i);
+      do {
+        r2 = gssk_rng_next(&run->rng) % (pop_size + archived);
+      } while (r2 == i || r2 == r1);
+      const double *a = &population[r1 * n];
+      const double *b = r2 < pop_size ? &population[r2 * n]
+                                      : &archive[(r2 - pop_size) * n];
+
+      double *trial = &trials[i * n];
+      size_t R = gssk_rng_next(&run->rng) % n;
+      for (size_t j = 0; j < n; j++) {
+        if (gssk_rng_uniform(&run->rng) < CR || j == R) {
+          double v = x[j] + F * (best[j] - x[j]) + F * (a[j] - b[j]);
+          // Out of range coordinates land halfway to the violated bound
+          double lower = param_lower(&space->maps[j], opts->k_min);
+          double upper = param_upper(&space->maps[j]);
+          if (v < lower)
+            v = 0.5 * (lower + x[j]);
+          else if (v > upper)
+            v = 0.5 * (upper + x[j]);
+          trial[j] = v;
+        } else {
+          trial[j] = x[j];
+        }
+      }
+    }
+
+    calibration_evaluate_trials(run, trials, fitness, screen_fitness,
+                                pop_size, trial_fitness, trial_screen);
+    run->generations++;
+
+    // Selection; strictly better trials feed the archive and the history.
+    // Improvements on a diverged member count as large finite weights.
+    size_t successes = 0;
+    double weight_sum = 0.0;
+    for (size_t i = 0; i < pop_size; i++) {
+      if (trial_fitness[i] > fitness[i])
+        continue;
+      if (trial_fitness[i] < fitness[i]) {
+        double *slot = archived < archive_max
+                           ? &archive[archived++ * n]
+                           : &archive[(gssk_rng_next(&run->rng) % archived) *
+                                      n];
+        memcpy(slot, &population[i * n], n * sizeof(double));
+        double gain = isfinite(fitness[i]) ? fitness[i] - trial_fitness[i]
+                                           : 1e300 / (double)pop_init;
+        success_F[successes] = trial_F[i];
+        success_CR[successes] = trial_CR[i];
+        success_w[successes] = gain;
+        weight_sum += gain;
+        successes++;
+      }
+      fitness[i] = trial_fitness[i];
+      screen_fitness[i] = trial_screen[i];
+      memcpy(&population[i * n], &trials[i * n], n * sizeof(double));
+    }
+
+    // Weighted Lehmer means of the successful F's and CR's
+    if (successes > 0 && weight_sum > 0.0) {
+      double f2 = 0.0, f1 = 0.0, c2 = 0.0, c1 = 0.0, c_max = 0.0;
+      for (size_t s = 0; s < successes; s++) {
+        double w = success_w[s] / weight_sum;
+        f2 += w * success_F[s] * success_F[s];
+        f1 += w * success_F[s];
+        c2 += w * success_CR[s] * success_CR[s];
+        c1 += w * success_CR[s];
+        c_max = fmax(c_max, success_CR[s]);
+      }
+      memory_F[memory_next] = f2 / f1;
+      memory_CR[memory_next] =
+          memory_CR[memory_next] < 0.0 || c_max == 0.0 ? -1.0 : c2 / c1;
+      memory_next = (memory_next + 1) % SHADE_MEMORY;
+    }
+
+    // Linear population size reduction: the worst members go, and the
+    // archive shrinks with the population
+    double progress = calibration_spent(run) / (double)run->budget;
+    size_t target = (size_t)((double)pop_init -
+                             progress * (double)(pop_init -
+                                                 SHADE_MIN_POPULATION) +
+                             0.5);
+    if (target < SHADE_MIN_POPULATION)
+      target = SHADE_MIN_POPULATION;
+    if (target < pop_size) {
+      rank_fitness(fitness, pop_size, order);
+      for (size_t i = 0; i < target; i++) {
+        memcpy(&trials[i * n], &population[order[i] * n], n * sizeof(double));
+        trial_fitness[i] = fitness[order[i]];
+        trial_screen[i] = screen_fitness[order[i]];
+      }
+      memcpy(population, trials, target * n * sizeof(double));
+      memcpy(fitness, trial_fitness, target * sizeof(double));
+      memcpy(screen_fitness, trial_screen, target * sizeof(double));
+      pop_size = target;
+      archive_max = (size_t)(SHADE_ARCHIVE_RATE * (double)pop_size + 0.5);
+      while (archived > archive_max) {
+        size_t drop = gssk_rng_next(&run->rng) % archived;
+        archived--;
+        memcpy(&archive[drop * n], &archive[archived * n], n * sizeof(double));
+      }
+    }
+  }
+
+cleanup:
+  gssk_ws_free(ws, population);
+  gssk_ws_free(ws, trials);
+  gssk_ws_free(ws, archive);
+  gssk_ws_free(ws, fitness);
+  gssk_ws_free(ws, trial_fitness);
+  gssk_ws_free(ws, trial_F);
+  gssk_ws_free(ws, trial_CR);
+  gssk_ws_free(ws, success_F);
+  gssk_ws_free(ws, success_CR);
+  gssk_ws_free(ws, success_w);
+  gssk_ws_free(ws, screen_fitness);
+  gssk_ws_free(ws, trial_screen);
+  gssk_ws_free(ws, order);
+  return status;
+}
+
+// --- CMA-ES ---
+
+// The search runs in normalized coordinates x >= 0 (x <= 1 for edges with a
+// calibration range), mapped to the optimizer coordinates by
+// origin + x * width so that [0, 1] spans [k_min, k_max] for the others.
+// Samples are repaired by clamping into the box, and the repaired steps
+// drive the update.
+
+// Default population for n parameters
+static size_t cmaes_lambda(size_t n) {
+  return 4 + (size_t)floor(3.0 * log((double)n));
+}
+
+// Largest population the IPOP restarts reach within the budget
+static size_t cmaes_max_lambda(const CalibrationRun *run, size_t n) {
+  size_t lambda = cmaes_lambda(n);
+  for (int r = 0; r < run->opts->restarts && 2 * lambda <= run->budget; r++)
+    lambda *= 2;
+  return lambda;
+}
+
+static GSSK_Status cmaes_run(CalibrationRun *run) {
+  const GSSK_CalibrationOptions *opts = run->opts;
+  const ParamSpace *space = run->ctx->space;
+  GSSK_Workspace *ws = run->ws;
+  size_t n = run->ctx->param_count;
+  size_t lambda_max = cmaes_max_lambda(run, n);
+  double N = (double)n;
+  GSSK_Status status = GSSK_SUCCESS;
+
+  double *origin = gssk_ws_alloc(ws, n * sizeof(double));
+  double *width = gssk_ws_alloc(ws, n * sizeof(double));
+  double *upper = gssk_ws_alloc(ws, n * sizeof(double));
+  double *mean = gssk_ws_alloc(ws, n * sizeof(double));
+  double *step = gssk_ws_alloc(ws, n * sizeof(double));
+  double *tmp = gssk_ws_alloc(ws, n * sizeof(double));
+  double *pc = gssk_ws_alloc(ws, n * sizeof(double));
+  double *ps = gssk_ws_alloc(ws, n * sizeof(double));
+  double *D = gssk_ws_alloc(ws, n * sizeof(double));
+  double *B = gssk_ws_alloc(ws, n * n * sizeof(double));
+  double *C = gssk_ws_alloc(ws, n * n * sizeof(double));
+  double *E = gssk_ws_alloc(ws, n * n * sizeof(double));
+  double *y = gssk_ws_alloc(ws, lambda_max * n * sizeof(double));
+  double *x = gssk_ws_alloc(ws, lambda_max * n * sizeof(double));
+  double *fitness = gssk_ws_alloc(ws, lambda_max * sizeof(double));
+  double *weights = gssk_ws_alloc(ws, lambda_max * sizeof(double));
+  size_t *order = gssk_ws_alloc(ws, lambda_max * sizeof(size_t));
+  if (!origin || !width || !upper || !mean || !step || !tmp || !pc || !ps ||
+      !D || !B || !C || !E || !y || !x || !fitness || !weights || !order) {
+    status = GSSK_ERR_MALLOC_FAILED;
+    goto cleanup;
+  }
+  for (size_t i = 0; i < n; i++) {
+    bool unit = space->maps[i].unit;
+    origin[i] = param_lower(&space->maps[i], opts->k_min);
+    width[i] = unit || opts->k_max <= opts->k_min ? 1.0
+                                                  : opts->k_max - opts->k_min;
+    upper[i] = unit ? 1.0 : INFINITY;
+  }
+
+  bool solved = false;
+  size_t lambda = cmaes_lambda(n);
+  for (int restart = 0;
+       restart <= opts->restarts && !solved && !run->monitor.stopped;
+       restart++, lambda *= 2) {
+    if (lambda > lambda_max || run->evaluations + lambda > run->budget)
+      break;
+
+    // Strategy parameters (Hansen's defaults for this population)
+    size_t mu = lambda / 2;
+    double wsum = 0.0, wsq = 0.0;
+    for (size_t r = 0; r < mu; r++) {
+      weights[r] = log(mu + 0.5) - log(r + 1.0);
+      wsum += weights[r];
+    }
+    for (size_t r = 0; r < mu; r++) {
+      weights[r] /= wsum;
+      wsq += weights[r] * weights[r];
+    }
+    double mueff = 1.0 / wsq;
+    double cs = (mueff + 2.0) / (N + mueff + 5.0);
+    double ds = 1.0 + 2.0 * fmax(0.0, sqrt((mueff - 1.0) / (N + 1.0)) - 1.0) +
+                cs;
+    double cc = (4.0 + mueff / N) / (N + 4.0 + 2.0 * mueff / N);
+    double c1 = 2.0 / ((N + 1.3) * (N + 1.3) + mueff);
+    double cmu = fmin(1.0 - c1, 2.0 * (mueff - 2.0 + 1.0 / mueff) /
+                                    ((N + 2.0) * (N + 2.0) + mueff));
+    double chi_n = sqrt(N) * (1.0 - 1.0 / (4.0 * N) + 1.0 / (21.0 * N * N));
+    size_t eigen_every = (size_t)(1.0 / ((c1 + cmu) * N * 10.0));
+    if (eigen_every < 1)
+      eigen_every = 1;
+    size_t stall_limit = 10 + (size_t)ceil(30.0 * N / (double)lambda);
+
+    // Each run starts from a random mean with an isotropic distribution
+    for (size_t i = 0; i < n; i++) {
+      mean[i] = gssk_rng_uniform(&run->rng);
+      pc[i] = ps[i] = 0.0;
+      D[i] = 1.0;
+      for (size_t j = 0; j < n; j++)
+        B[i * n + j] = C[i * n + j] = i == j ? 1.0 : 0.0;
+    }
+    double sigma = 0.3;
+    double run_best = INFINITY;
+    size_t stall = 0, since_eigen = 0;
+
+    for (size_t g = 1; run->evaluations + lambda <= run->budget; g++) {
+      // Sample y ~ N(0, C) as B D z, then repair into the box
+      for (size_t m = 0; m < lambda; m++) {
+        double *ym = &y[m * n];
+        double *xm = &x[m * n];
+        for (size_t j = 0; j < n; j++)
+          tmp[j] = D[j] * gssk_rng_normal(&run->rng);
+        for (size_t i = 0; i < n; i++) {
+          double v = 0.0;
+          for (size_t j = 0; j < n; j++)
+            v += B[i * n + j] * tmp[j];
+          double xi = mean[i] + sigma * v;
+          if (xi < 0.0)
+            xi = 0.0;
+          else if (xi > upper[i])
+            xi = upper[i];
+          ym[i] = (xi - mean[i]) / sigma;
+          xm[i] = origin[i] + xi * width[i];
+        }
+      }
+
+      calibration_evaluate(run, x, NULL, lambda, fitness);
+      if (run->monitor.stopped)
+        break;
+      run->generations++;
+
+      // Rank, ties keeping the sampling order
+      rank_fitness(fitness, lambda, order);
+
+      // Recombination: the weighted mean step of the best mu samples
+      for (size_t i = 0; i < n; i++) {
+        double v = 0.0;
+        for (size_t r = 0; r < mu; r++)
+          v += weights[r] * y[order[r] * n + i];
+        step[i] = v;
+        mean[i] += sigma * v;
+        if (mean[i] < 0.0)
+          mean[i] = 0.0;
+        else if (mean[i] > upper[i])
+          mean[i] = upper[i];
+      }
+
+      // Evolution paths; ps uses the step whitened by C^-1/2 = B D^-1 B^T
+      double norm = 0.0;
+      for (size_t j = 0; j < n; j++) {
+        double v = 0.0;
+        for (size_t i = 0; i < n; i++)
+          v += B[i * n + j] * step[i];
+        tmp[j] = v / D[j];
+      }
+      for (size_t i = 0; i < n; i++) {
+        double v = 0.0;
+        for (size_t j = 0; j < n; j++)
+          v += B[i * n + j] * tmp[j];
+        ps[i] = (1.0 - cs) * ps[i] + sqrt(cs * (2.0 - cs) * mueff) * v;
+        norm += ps[i] * ps[i];
+      }
+      norm = sqrt(norm);
+      bool hsig = norm / sqrt(1.0 - pow(1.0 - cs, 2.0 * (double)g)) / chi_n <
+                  1.4 + 2.0 / (N + 1.0);
+      for (size_t i = 0; i < n; i++)
+        pc[i] = (1.0 - cc) * pc[i] +
+                (hsig ? sqrt(cc * (2.0 - cc) * mueff) * step[i] : 0.0);
+
+      // Rank-one and rank-mu covariance update
+      double decay = 1.0 - c1 - cmu + (hsig ? 0.0 : c1 * cc * (2.0 - cc));
+      for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j <= i; j++) {
+          double rank_mu = 0.0;
+          for (size_t r = 0; r < mu; r++)
+            rank_mu += weights[r] * y[order[r] * n + i] * y[order[r] * n + j];
+          double v = decay * C[i * n + j] + c1 * pc[i] * pc[j] + cmu * rank_mu;
+          C[i * n + j] = C[j * n + i] = v;
+        }
+      }
+      sigma *= exp((cs / ds) * (norm / chi_n - 1.0));
+
+      // The decomposition is refreshed lazily, as C changes slowly
+      if (++since_eigen >= eigen_every) {
+        since_eigen = 0;
+        memcpy(E, C, n * n * sizeof(double));
+        gssk_symmetric_eigen(E, n, D, B);
+        for (size_t i = 0; i < n; i++)
+          D[i] = sqrt(fmax(D[i], 1e-300));
+      }
+
+      // Stop this run once it is solved, stalled or degenerate
+      double best = fitness[order[0]];
+      if (best == 0.0) {
+        solved = true;
+        break;
+      }
+      if (best < run_best &&
+          (isinf(run_best) || run_best - best > 1e-12 * run_best)) {
+        run_best = best;
+        stall = 0;
+      } else if (++stall > stall_limit) {
+        break;
+      }
+      double d_min = D[0], d_max = D[0];
+      for (size_t i = 1; i < n; i++) {
+        d_min = fmin(d_min, D[i]);
+        d_max = fmax(d_max, D[i]);
+      }
+      if (!isfinite(sigma) || sigma * d_max < 1e-11 || d_max > 1e7 * d_min)
+        break;
+    }
+  }
+
+cleanup:
+  gssk_ws_free(ws, origin);
+  gssk_ws_free(ws, width);
+  gssk_ws_free(ws, upper);
+  gssk_ws_free(ws, mean);
+  gssk_ws_free(ws, step);
+  gssk_ws_free(ws, tmp);
+  gssk_ws_free(ws, pc);
+  gssk_ws_free(ws, ps);
+  gssk_ws_free(ws, D);
+  gssk_ws_free(ws, B);
+  gssk_ws_free(ws, C);
+  gssk_ws_free(ws, E);
+  gssk_ws_free(ws, y);
+  gssk_ws_free(ws, x);
+  gssk_ws_free(ws, fitness);
+  gssk_ws_free(ws, weights);
+  gssk_ws_free(ws, order);
+  return status;
+}
+
+// --- Bayesian Optimization ---
+
+// A Gaussian process surrogate of the log misfit over the normalized box
+// (as for CMA-ES, [0, 1] spans [k_min, k_max] for edges without a
+// calibration range), on top of a quadratic trend. Each generation fits
+// the GP, then picks a batch of 'population' candidates by expected
+// improvement, each pick assuming the previous ones return the worst value
+// in the training set ("constant liar") so the batch spreads out; the
+// batch is then simulated in parallel.
+
+// Most evaluated points the surrogate is fitted to (the best ones)
+#define BAYES_MAX_POINTS 256
+// Candidates scored by expected improvement for each pick
+#define BAYES_CANDIDATES 512
+// Noise on the kernel diagonal, relative to the unit signal variance
+#define BAYES_NUGGET 1e-6
+
+typedef struct {
+  size_t dim;
+  size_t count;      /**< Points in the fit */
+  double *x;         /**< capacity * dim */
+  double *y;         /**< capacity, standardized log misfit */
+  double *scale;     /**< dim, Matern length scales */
+  double *L;         /**< count * count Cholesky factor of the kernel */
+  double *alpha;     /**< count, K^-1 y */
+  double *beta;      /**< 2 * dim + 1 coefficients of the quadratic trend */
+} BayesGP;
+
+// Separable quadratic trend under the GP. Without it the posterior mean
+// reverts to the average away from the data, and batches creep along
+// valleys instead of jumping to their predicted floor.
+static double gp_trend(const BayesGP *gp, const double *x) {
+  double v = gp->beta[0];
+  for (size_t i = 0; i < gp->dim; i++)
+    v += x[i] * (gp->beta[1 + i] + x[i] * gp->beta[1 + gp->dim + i]);
+  return v;
+}
+
+// Ridge least-squares fit of the trend to y, leaving the residuals in y;
+// 'a' is (2 dim + 1)^2 scratch
+static void gp_fit_trend(BayesGP *gp, double *a) {
+  size_t p = 2 * gp->dim + 1;
+  memset(a, 0, p * p * sizeof(double));
+  memset(gp->beta, 0, p * sizeof(double));
+  for (size_t r = 0; r < gp->count; r++) {
+    const double *x = &gp->x[r * gp->dim];
+    for (size_t i = 0; i < p; i++) {
+      double fi = i == 0 ? 1.0
+                  : i <= gp->dim
+                      ? x[i - 1]
+                      : x[i - 1 - gp->dim] * x[i - 1 - gp->dim];
+      gp->beta[i] += fi * gp->y[r];
+      for (size_t j = 0; j <= i; j++) {
+        double fj = j == 0 ? 1.0
+                           : (j <= gp->dim ? x[j - 1]
+                                           : x[j - 1 - gp->dim] *
+                                                 x[j - 1 - gp->dim]);
+        a[i * p + j] += fi * fj;
+      }
+    }
+  }
+  for (size_t i = 0; i < p; i++)
+    a[i * p + i] += 1e-3;
+  if (!gssk_cholesky(a, p)) {
+    memset(gp->beta, 0, p * sizeof(double));
+    return;
+  }
+  gssk_cholesky_solve(a, p, gp->beta);
+  for (size_t r = 0; r < gp->count; r++)
+    gp->y[r] -= gp_trend(gp, &gp->x[r * gp->dim]);
+}
+
+// Matern 5/2 kernel with one length scale per coordinate
+static double gp_kernel(const double *a, const double *b, const double *scale,
+                        size_t dim) {
+  double r2 = 0.0;
+  for (size_t i = 0; i < dim; i++) {
+    double d = (a[i] - b[i]) / scale[i];
+    r2 += d * d;
+  }
+  double r = sqrt(5.0 * r2);
+  return (1.0 + r + 5.0 * r2 / 3.0) * exp(-r);
+}
+
+// Factor the kernel matrix and solve for alpha; returns the log marginal
+// likelihood (up to a constant), -INFINITY if the matrix is not SPD
+static double gp_factor(BayesGP *gp) {
+  size_t N = gp->count, dim = gp->dim;
+  for (size_t i = 0; i < N; i++) {
+    for (size_t j = 0; j < i; j++)
+      gp->L[i * N + j] =
+          gp_kernel(&gp->x[i * dim], &gp->x[j * dim], gp->scale, dim);
+    gp->L[i * N + i] = 1.0 + BAYES_NUGGET;
+  }
+  if (!gssk_cholesky(gp->L, N))
+    return -INFINITY;
+  memcpy(gp->alpha, gp->y, N * sizeof(double));
+  gssk_cholesky_solve(gp->L, N, gp->alpha);
+  double fit = 0.0, logdet = 0.0;
+  for (size_t i = 0; i < N; i++) {
+    fit += gp->y[i] * gp->alpha[i];
+    logdet += log(gp->L[i * N + i]);
+  }
+  return -0.5 * fit - logdet;
+}
+
+// Posterior mean and standard deviation at x; 'k' is count scratch
+static void gp_predict(const BayesGP *gp, const double *x, double *k,
+                       double *mean, double *sd) {
+  size_t N = gp->count;
+  double mu = gp_trend(gp, x);
+  for (size_t i = 0; i < N; i++) {
+    k[i] = gp_kernel(x, &gp->x[i * gp->dim], gp->scale, gp->dim);
+    mu += k[i] * gp->alpha[i];
+  }
+  // v = L^-1 k
+  double var = 1.0;
+  for (size_t i = 0; i < N; i++) {
+    double v = k[i];
+    for (size_t j = 0; j < i; j++)
+      v -= gp->L[i * N + j] * k[j];
+    k[i] = v / gp->L[i * N + i];
+    var -= k[i] * k[i];
+  }
+  *mean = mu;
+  *sd = sqrt(var > 1e-12 ? var : 1e-12);
+}
+
+// Expected improvement below 'best' of a normal prediction
+static double expected_improvement(double best, double mean, double sd) {
+  double z = (best - mean) / sd;
+  double cdf = 0.5 * erfc(-z / sqrt(2.0));
+  double pdf = exp(-0.5 * z * z) / sqrt(2.0 * acos(-1.0));
+  return (best - mean) * cdf + sd * pdf;
+}
+
+static GSSK_Status bayes_run(CalibrationRun *run) {
+  const GSSK_CalibrationOptions *opts = run->opts;
+  const ParamSpace *space = run->ctx->space;
+  GSSK_Workspace *ws = run->ws;
+  size_t n = run->ctx->param_count;
+  size_t q = opts->population;
+  size_t budget = run->budget;
+  size_t cap = BAYES_MAX_POINTS + q;
+  static const double spread[] = {0.01, 0.05, 0.2};
+  GSSK_Status status = GSSK_SUCCESS;
+  gssk_sampler design;
+  memset(&design, 0, sizeof(design));
+
+  double *origin = gssk_ws_alloc(ws, n * sizeof(double));
+  double *width = gssk_ws_alloc(ws, n * sizeof(double));
+  double *seen_x = gssk_ws_alloc(ws, budget * n * sizeof(double));
+  double *seen_f = gssk_ws_alloc(ws, budget * sizeof(double));
+  size_t *order = gssk_ws_alloc(ws, budget * sizeof(size_t));
+  double *batch = gssk_ws_alloc(ws, q * n * sizeof(double));
+  double *cand = gssk_ws_alloc(ws, n * sizeof(double));
+  double *pick = gssk_ws_alloc(ws, n * sizeof(double));
+  double *k = gssk_ws_alloc(ws, cap * sizeof(double));
+  BayesGP gp;
+  gp.dim = n;
+  gp.count = 0;
+  gp.x = gssk_ws_alloc(ws, cap * n * sizeof(double));
+  gp.y = gssk_ws_alloc(ws, cap * sizeof(double));
+  gp.scale = gssk_ws_alloc(ws, n * sizeof(double));
+  gp.L = gssk_ws_alloc(ws, cap * cap * sizeof(double));
+  gp.alpha = gssk_ws_alloc(ws, cap * sizeof(double));
+  gp.beta = gssk_ws_alloc(ws, (2 * n + 1) * sizeof(double));
+  double *normal =
+      gssk_ws_alloc(ws, (2 * n + 1) * (2 * n + 1) * sizeof(double));
+  if (!origin || !width || !seen_x || !seen_f || !order || !batch || !cand ||
+      !pick || !k || !gp.x || !gp.y || !gp.scale || !gp.L || !gp.alpha ||
+      !gp.beta || !normal) {
+    status = GSSK_ERR_MALLOC_FAILED;
+    goto cleanup;
+  }
+  for (size_t i = 0; i < n; i++) {
+    bool unit = space->maps[i].unit;
+    origin[i] = param_lower(&space->maps[i], opts->k_min);
+    width[i] = unit || opts->k_max <= opts->k_min ? 1.0
+                                                  : opts->k_max - opts->k_min;
+    gp.scale[i] = 0.3;
+  }
+
+  // Initial Latin hypercube design of one generation
+  size_t seen = q < budget ? q : budget;
+  status = gssk_sampler_init(&design, GSSK_SAMPLING_LHS, n, seen,
+                             gssk_rng_next(&run->rng), ws);
+  if (status != GSSK_SUCCESS)
+    goto cleanup;
+  for (size_t m = 0; m < seen; m++) {
+    gssk_sampler_next(&design, &seen_x[m * n]);
+    for (size_t i = 0; i < n; i++)
+      batch[m * n + i] = origin[i] + seen_x[m * n + i] * width[i];
+  }
+  calibration_evaluate(run, batch, NULL, seen, seen_f);
+
+  while (run->best_fitness > 0.0 && seen + q <= budget &&
+         !run->monitor.stopped) {
+    // Training set: the best points. The misfit is modelled as
+    // log(f + f_best), which flattens the funnel at the optimum to the
+    // depth reached so far; diverged points count as the worst finite one.
+    rank_fitness(seen_f, seen, order);
+    size_t N = seen < BAYES_MAX_POINTS ? seen : BAYES_MAX_POINTS;
+    double shift = fmax(run->best_fitness, 1e-300);
+    double worst = -INFINITY, mean = 0.0, var = 0.0;
+    for (size_t r = 0; r < N; r++) {
+      double f = seen_f[order[r]];
+      if (isfinite(f))
+        worst = fmax(worst, log(f + shift));
+    }
+    for (size_t r = 0; r < N; r++) {
+      double f = seen_f[order[r]];
+      memcpy(&gp.x[r * n], &seen_x[order[r] * n], n * sizeof(double));
+      gp.y[r] = isfinite(f) ? log(f + shift) : (isfinite(worst) ? worst : 0.0);
+      mean += gp.y[r];
+    }
+    mean /= (double)N;
+    for (size_t r = 0; r < N; r++)
+      var += (gp.y[r] - mean) * (gp.y[r] - mean);
+    double sd = var > 0.0 ? sqrt(var / (double)N) : 1.0;
+    for (size_t r = 0; r < N; r++)
+      gp.y[r] = (gp.y[r] - mean) / sd;
+    gp.count = N;
+    double best_y = gp.y[0], liar = gp.y[N - 1];
+    gp_fit_trend(&gp, normal);
+
+    // Length scales by coordinate search on the marginal likelihood,
+    // carried over from the previous generation
+    double lml = gp_factor(&gp);
+    static const double factors[] = {2.0, 0.5, 1.25, 0.8};
+    for (int sweep = 0; sweep < 8; sweep++) {
+      bool moved = false;
+      for (size_t i = 0; i < n; i++) {
+        for (int f = 0; f < 4; f++) {
+          double old = gp.scale[i];
+          double next = old * factors[f];
+          if (next < 0.005 || next > 20.0)
+            continue;
+          gp.scale[i] = next;
+          double trial = gp_factor(&gp);
+          if (trial > lml) {
+            lml = trial;
+            moved = true;
+          } else {
+            gp.scale[i] = old;
+          }
+        }
+      }
+      if (!moved)
+        break;
+    }
+    if (!isfinite(gp_factor(&gp)))
+      break;
+
+    // Batch by expected improvement with constant-liar fantasies.
+    // Candidates are drawn uniformly and around the best points seen.
+    for (size_t m = 0; m < q; m++) {
+      double best_ei = -1.0;
+      for (size_t c = 0; c < BAYES_CANDIDATES; c++) {
+        if (c % 2 == 0) {
+          for (size_t i = 0; i < n; i++)
+            cand[i] = gssk_rng_uniform(&run->rng);
+        } else {
+          const double *centre =
+              &gp.x[(gssk_rng_next(&run->rng) % (N < 5 ? N : 5)) * n];
+          double s = spread[(c / 2) % 3];
+          for (size_t i = 0; i < n; i++) {
+            double v = centre[i] + s * gssk_rng_normal(&run->rng);
+            cand[i] = v < 0.0 ? 0.0 : (v > 1.0 ? 1.0 : v);
+          }
+        }
+        double mu, sigma;
+        gp_predict(&gp, cand, k, &mu, &sigma);
+        double ei = expected_improvement(best_y, mu, sigma);
+        if (ei > best_ei) {
+          best_ei = ei;
+          memcpy(pick, cand, n * sizeof(double));
+        }
+      }
+      memcpy(&seen_x[(seen + m) * n], pick, n * sizeof(double));
+      for (size_t i = 0; i < n; i++)
+        batch[m * n + i] = origin[i] + pick[i] * width[i];
+
+      // The pick joins the fit at the liar value; a factor that fails
+      // just leaves the rest of the batch to the unchanged surrogate
+      if (m + 1 < q) {
+        memcpy(&gp.x[gp.count * n], pick, n * sizeof(double));
+        gp.y[gp.count++] = liar - gp_trend(&gp, pick);
+        if (!isfinite(gp_factor(&gp))) {
+          gp.count--;
+          gp_factor(&gp);
+        }
+      }
+    }
+
+    calibration_evaluate(run, batch, NULL, q, &seen_f[seen]);
+    seen += q;
+    run->generations++;
+  }
+
+cleanup:
+  gssk_sampler_free(&design);
+  gssk_ws_free(ws, origin);
+  gssk_ws_free(ws, width);
+  gssk_ws_free(ws, seen_x);
+  gssk_ws_free(ws, seen_f);
+  gssk_ws_free(ws, order);
+  gssk_ws_free(ws, batch);
+  gssk_ws_free(ws, cand);
+  gssk_ws_free(ws, pick);
+  gssk_ws_free(ws, k);
+  gssk_ws_free(ws, gp.x);
+  gssk_ws_free(ws, gp.y);
+  gssk_ws_free(ws, gp.scale);
+  gssk_ws_free(ws, gp.L);
+  gssk_ws_free(ws, gp.alpha);
+  gssk_ws_free(ws, gp.beta);
+  gssk_ws_free(ws, normal);
+  return status;
+}
+
+// A model without edges has nothing to calibrate: report no work rather
+// than leave the caller's report unwritten
+static GSSK_Status report_nothing_to_fit(GSSK_CalibrationReport *report) {
+  if (report) {
+    memset(report, 0, sizeof(*report));
+    report->best_fitness = INFINITY;
+  }
+  return GSSK_SUCCESS;
+}
+
+GSSK_Status GSSK_CalibrateExperiments(GSSK_Instance *inst,
+                                      const GSSK_Experiment *experiments,
+                                      size_t experiment_count,
+                                      const GSSK_CalibrationOptions *opts,
+                                      GSSK_CalibrationReport *report) {
+  if (!inst || !experiments || experiment_count == 0 || !opts ||
+      opts->population < 4 ||
+      opts->k_max < opts->k_min ||
+      (opts->optimizer != GSSK_OPTIMIZER_DE &&
+       opts->optimizer != GSSK_OPTIMIZER_SHADE &&
+       opts->optimizer != GSSK_OPTIMIZER_CMAES &&
+       opts->optimizer != GSSK_OPTIMIZER_BAYES) ||
+      (opts->screen_factor > 1 &&
+       (!(opts->screen_horizon > 0.0) || opts->screen_horizon > 1.0 ||
+        opts->screen_promote < 0.0 || opts->screen_promote > 1.0)) ||
+      !(opts->cache_tolerance >= 0.0))
+    return GSSK_ERR_UNKNOWN;
+
+  if (GSSK_GetEdgeCount(inst) == 0)
+    return report_nothing_to_fit(report);
+
+  // All scratch comes from the workspace when one is given, and is handed
+  // back at the end; nothing is allocated once the generations start
+  GSSK_Workspace *ws = opts->workspace;
+  gssk_ws_mark mark = gssk_ws_get_mark(ws);
+
+  ParamSpace space;
+  GSSK_Status status = param_space_init(&space, inst, NULL, 0, ws);
+  if (status != GSSK_SUCCESS) {
+    gssk_ws_release(ws, mark);
+    return status;
+  }
+  ExperimentSet data;
+  status = experiment_set_init(&data, inst, experiments, experiment_count, ws);
+  if (status != GSSK_SUCCESS) {
+    param_space_free(&space);
+    gssk_ws_release(ws, mark);
+    return status;
+  }
+  OptimizerContext ctx;
+  memset(&ctx, 0, sizeof(ctx));
+  ctx.data = &data;
+  ctx.space = &space;
+  ctx.param_count = space.count;
+
+  // Every optimizer gets the evaluations of a full DE run
+  size_t n = ctx.param_count;
+  CalibrationRun run;
+  memset(&run, 0, sizeof(run));
+  run.opts = opts;
+  run.ctx = &ctx;
+  run.ws = ws;
+  run.budget = opts->population *
+               (opts->iterations > 0 ? (size_t)opts->iterations + 1 : 1);
+  run.best_fitness = INFINITY;
+  run.progress_total = run.budget;
+  gssk_monitor_init(&run.monitor, opts->control);
+  CalibrationScreen screen;
+  memset(&screen, 0, sizeof(screen));
+  FitnessCache cache;
+  memset(&cache, 0, sizeof(cache));
+
+  // Workers are sized for the largest generation the optimizer evaluates
+  size_t largest = opts->optimizer == GSSK_OPTIMIZER_CMAES
+                       ? cmaes_max_lambda(&run, n)
+                       : opts->population;
+  size_t blocks = (largest + CALIBRATION_LANES - 1) / CALIBRATION_LANES;
+  run.workers = gssk_worker_count(opts->threads, blocks * data.count);
+  run.best_params = gssk_ws_alloc(ws, n * sizeof(double));
+  run.pool = calibration_workers_alloc(inst, run.workers, ws);
+  if (opts->control)
+    run.best_k = gssk_ws_alloc(ws, GSSK_GetEdgeCount(inst) * sizeof(double));
+  if (data.count > 1) {
+    ctx.partial_sse = gssk_ws_alloc(ws, data.count * largest * sizeof(double));
+    ctx.partial_points =
+        gssk_ws_alloc(ws, data.count * largest * sizeof(size_t));
+  }
+  if (!run.best_params || !run.pool || (opts->control && !run.best_k) ||
+      (data.count > 1 && (!ctx.partial_sse || !ctx.partial_points))) {
+    status = GSSK_ERR_MALLOC_FAILED;
+    goto cleanup;
+  }
+  // Only the DE variants screen their trials
+  if (opts->screen_factor > 1 && (opts->optimizer == GSSK_OPTIMIZER_DE ||
+                                  opts->optimizer == GSSK_OPTIMIZER_SHADE)) {
+    status = calibration_screen_init(&screen, inst, experiments,
+                                     experiment_count, &run, largest);
+    if (status != GSSK_SUCCESS)
+      goto cleanup;
+    run.screen = &screen;
+  }
+  if (opts->cache_size > 0) {
+    status = fitness_cache_init(&cache, opts->cache_size,
+                                opts->cache_tolerance, n, largest, ws);
+    if (status != GSSK_SUCCESS)
+      goto cleanup;
+    run.cache = &cache;
+  }
+  // Should nothing finite be found, the current k's are kept
+  for (size_t i = 0; i < n; i++)
+    run.best_params[i] =
+        param_from_k(&space.maps[i], space.base_k[space.edges[i]]);
+
+  uint64_t seed = gssk_resolve_seed(opts->seed);
+  gssk_rng_seed(&run.rng, seed);
+
+  switch (opts->optimizer) {
+  case GSSK_OPTIMIZER_SHADE:
+    status = shade_run(&run);
+    break;
+  case GSSK_OPTIMIZER_CMAES:
+    status = cmaes_run(&run);
+    break;
+  case GSSK_OPTIMIZER_BAYES:
+    status = bayes_run(&run);
+    break;
+  default:
+    status = de_run(&run);
+    break;
+  }
+  if (status != GSSK_SUCCESS)
+    goto cleanup;
+
+  // Set best parameters back to instance
+  for (size_t i = 0; i < n; i++) {
+    GSSK_SetEdgeK(inst, space.edges[i],
+                  param_to_k(&space.maps[i], run.best_params[i]));
+  }
+
+  if (report) {
+    report->best_fitness = run.best_fitness;
+    report->evaluations = run.evaluations;
+    report->generations = run.generations;
+    report->early_aborts = 0;
+    for (size_t w = 0; w < run.workers; w++)
+      report->early_aborts += run.pool[w].aborted;
+    report->screened = run.screened;
+    report->screen_dropped = run.screen_dropped;
+    report->cache_hits = cache.hits;
+  }
+  if (run.monitor.stopped)
+    status = GSSK_ERR_CANCELLED;
+
+cleanup:
+  fitness_cache_free(&cache, ws);
+  calibration_screen_free(&screen, run.workers, ws);
+  gssk_ws_free(ws, run.best_k);
+  gssk_ws_free(ws, run.best_params);
+  gssk_ws_free(ws, ctx.partial_sse);
+  gssk_ws_free(ws, ctx.partial_points);
+  calibration_workers_free(run.pool, run.workers, ws);
+  experiment_set_free(&data);
+  param_space_free(&space);
+  gssk_ws_release(ws, mark);
+  return status;
+}
+
+GSSK_Status GSSK_CalibrateEx(GSSK_Instance *inst,
+                             const GSSK_NodeObservations *obs,
+                             size_t obs_count,
+                             const GSSK_CalibrationOptions *opts,
+                             GSSK_CalibrationReport *report) {
+  if (!obs || obs_count == 0)
+    return GSSK_ERR_UNKNOWN;
+  GSSK_Experiment experiment = {NULL, NULL, 0, obs, obs_count};
+  return GSSK_CalibrateExperiments(inst, &experiment, 1, opts, report);
+}
+
+GSSK_Status GSSK_Calibrate(GSSK_Instance *inst, GSSK_NodeObservations *obs,
+                           size_t obs_count, int iterations) {
+  GSSK_CalibrationOptions opts;
+  GSSK_InitCalibrationOptions(&opts);
+  opts.iterations = iterations;
+  return GSSK_CalibrateEx(inst, obs, obs_count, &opts, NULL);
+}
+
+// --- Calibration Sessions ---
+
+struct GSSK_CalibrationSession {
+  GSSK_Instance *inst;
+  GSSK_CalibrationOptions opts;
+  GSSK_Workspace *ws;  /**< Owner of this session's memory, NULL for heap */
+  gssk_ws_mark mark;   /**< Workspace position before the session */
+  ParamSpace space;
+  ExperimentSet data;  /**< Compiled observations, rebuilt on the heap */
+  OptimizerContext ctx;
+  CalibrationRun run;
+  DEState de;
+  FitnessCheckpoints members; /**< Population states at the last observed
+                                   step */
+  FitnessCheckpoints trials;
+  GSSK_NodeObservations *obs; /**< Copies of the observations, on the heap */
+  size_t obs_count;
+  size_t obs_capacity;
+  size_t scheduled;    /**< Observations the population is scored on */
+  bool started;        /**< Population drawn and scored */
+  bool stale;          /**< Observations added since the last run */
+};
+
+static void checkpoints_free(FitnessCheckpoints *c, GSSK_Workspace *ws) {
+  gssk_ws_free(ws, c->state);
+  gssk_ws_free(ws, c->sse);
+  gssk_ws_free(ws, c->points);
+  memset(c, 0, sizeof(*c));
+}
+
+static GSSK_Status checkpoints_alloc(FitnessCheckpoints *c, size_t members,
+                                     size_t node_count, GSSK_Workspace *ws) {
+  memset(c, 0, sizeof(*c));
+  c->state = gssk_ws_alloc(ws, members * node_count * sizeof(double));
+  c->sse = gssk_ws_alloc(ws, members * sizeof(double));
+  c->points = gssk_ws_alloc(ws, members * sizeof(size_t));
+  if (!c->state || !c->sse || !c->points) {
+    checkpoints_free(c, ws);
+    return GSSK_ERR_MALLOC_FAILED;
+  }
+  return GSSK_SUCCESS;
+}
+
+void GSSK_CalibrationSessionFree(GSSK_CalibrationSession *session) {
+  if (!session)
+    return;
+  GSSK_Workspace *ws = session->ws;
+  gssk_ws_mark mark = session->mark;
+  for (size_t o = 0; o < session->obs_count; o++)
+    free(session->obs[o].data);
+  free(session->obs);
+  experiment_set_free(&session->data);
+  de_state_free(&session->de, ws);
+  checkpoints_free(&session->members, ws);
+  checkpoints_free(&session->trials, ws);
+  calibration_workers_free(session->run.pool, session->run.workers, ws);
+  gssk_ws_free(ws, session->run.best_params);
+  gssk_ws_free(ws, session->run.best_k);
+  param_space_free(&session->space);
+  gssk_ws_free(ws, session);
+  gssk_ws_release(ws, mark);
+}
+
+GSSK_CalibrationSession *
+GSSK_CalibrationSessionCreate(GSSK_Instance *inst,
+                              const GSSK_CalibrationOptions *opts) {
+  if (!inst || !opts || opts->population < 4 || opts->k_max < opts->k_min ||
+      opts->optimizer != GSSK_OPTIMIZER_DE || opts->screen_factor > 1)
+    return NULL;
+
+  GSSK_Workspace *ws = opts->workspace;
+  gssk_ws_mark mark = gssk_ws_get_mark(ws);
+  GSSK_CalibrationSession *session =
+      gssk_ws_calloc(ws, 1, sizeof(GSSK_CalibrationSession));
+  if (!session)
+    return NULL;
+  session->inst = inst;
+  session->opts = *opts;
+  session->ws = ws;
+  session->mark = mark;
+  if (param_space_init(&session->space, inst, NULL, 0, ws) != GSSK_SUCCESS) {
+    GSSK_CalibrationSessionFree(session);
+    return NULL;
+  }
+
+  OptimizerContext *ctx = &session->ctx;
+  ctx->data = &session->data;
+  ctx->space = &session->space;
+  ctx->param_count = session->space.count;
+  size_t pop_size = opts->population;
+  size_t n = ctx->param_count;
+  size_t nodes = GSSK_GetStateSize(inst);
+
+  CalibrationRun *run = &session->run;
+  run->opts = &session->opts;
+  run->ctx = ctx;
+  run->ws = ws;
+  run->best_fitness = INFINITY;
+  run->member_checkpoints = &session->members;
+  run->trial_checkpoints = &session->trials;
+  size_t blocks = (pop_size + CALIBRATION_LANES - 1) / CALIBRATION_LANES;
+  run->workers = gssk_worker_count(opts->threads, blocks);
+  run->pool = calibration_workers_alloc(inst, run->workers, ws);
+  run->best_params = gssk_ws_alloc(ws, n * sizeof(double));
+  if (opts->control)
+    run->best_k = gssk_ws_alloc(ws, GSSK_GetEdgeCount(inst) * sizeof(double));
+  if (!run->pool || !run->best_params || (opts->control && !run->best_k) ||
+      de_state_alloc(&session->de, pop_size, n, ws) != GSSK_SUCCESS ||
+      checkpoints_alloc(&session->members, pop_size, nodes, ws) !=
+          GSSK_SUCCESS ||
+      checkpoints_alloc(&session->trials, pop_size, nodes, ws) !=
+          GSSK_SUCCESS) {
+    GSSK_CalibrationSessionFree(session);
+    return NULL;
+  }
+  for (size_t i = 0; i < n; i++)
+    run->best_params[i] = param_from_k(
+        &session->space.maps[i],
+        session->space.base_k[session->space.edges[i]]);
+
+  uint64_t seed = gssk_resolve_seed(opts->seed);
+  gssk_rng_seed(&run->rng, seed);
+  return session;
+}
+
+GSSK_Status
+GSSK_CalibrationSessionAddObservations(GSSK_CalibrationSession *session,
+                                       const GSSK_NodeObservations *obs,
+                                       size_t obs_count) {
+  if (!session || (!obs && obs_count > 0))
+    return GSSK_ERR_UNKNOWN;
+  for (size_t o = 0; o < obs_count; o++) {
+    if (GSSK_FindNodeIdx(session->inst, obs[o].node_id) == -1 ||
+        (!obs[o].data && obs[o].count > 0))
+      return GSSK_ERR_UNKNOWN;
+  }
+  if (session->obs_count + obs_count > session->obs_capacity) {
+    size_t capacity = session->obs_capacity * 2;
+    if (capacity < session->obs_count + obs_count)
+      capacity = session->obs_count + obs_count;
+    GSSK_NodeObservations *grown =
+        realloc(session->obs, capacity * sizeof(GSSK_NodeObservations));
+    if (!grown)
+      return GSSK_ERR_MALLOC_FAILED;
+    session->obs = grown;
+    session->obs_capacity = capacity;
+  }
+  for (size_t o = 0; o < obs_count; o++) {
+    GSSK_NodeObservations *copy = &session->obs[session->obs_count];
+    int idx = GSSK_FindNodeIdx(session->inst, obs[o].node_id);
+    copy->node_id = GSSK_GetNodeID(session->inst, (size_t)idx);
+    copy->count = obs[o].count;
+    copy->data = malloc((obs[o].count > 0 ? obs[o].count : 1) *
+                        sizeof(GSSK_Observation));
+    if (!copy->data)
+      return GSSK_ERR_MALLOC_FAILED;
+    memcpy(copy->data, obs[o].data, obs[o].count * sizeof(GSSK_Observation));
+    session->obs_count++;
+  }
+  session->stale = session->stale || obs_count > 0;
+  return GSSK_SUCCESS;
+}
+
+// Rescore the population on the observations added since the last run.
+// When they all fall after the step the population's states were saved
+// at, each member just carries on from its checkpoint over the new window;
+// otherwise it is simulated again from the start.
+static GSSK_Status session_rescore(GSSK_CalibrationSession *session) {
+  GSSK_Experiment experiment = {NULL, NULL, 0, session->obs,
+                                session->obs_count};
+  experiment_set_free(&session->data);
+  GSSK_Status status =
+      experiment_set_init(&session->data, session->inst, &experiment, 1, NULL);
+  if (status != GSSK_SUCCESS)
+    return status;
+
+  const gssk_schedule *sched = &session->data.schedules[0];
+  CalibrationRun *run = &session->run;
+  size_t pop_size = session->opts.population;
+  run->best_fitness = INFINITY;
+  if (!session->started) {
+    de_init(run, &session->de);
+    session->started = true;
+  } else {
+    size_t step = session->members.step;
+    bool extends = step <= sched->last_step &&
+                   sched->step_start[step + 1] == session->scheduled;
+    run->resume = extends ? &session->members : NULL;
+    run->save = &session->members;
+    calibration_evaluate(run, session->de.population, NULL, pop_size,
+                         session->de.fitness);
+    run->resume = NULL;
+    run->save = NULL;
+  }
+  session->members.step = session->trials.step = sched->last_step;
+  session->scheduled = sched->count;
+  session->stale = false;
+  return GSSK_SUCCESS;
+}
+
+GSSK_Status GSSK_CalibrationSessionRun(GSSK_CalibrationSession *session,
+                                       int generations,
+                                       GSSK_CalibrationReport *report) {
+  if (!session || session->obs_count == 0 || generations < 0)
+    return GSSK_ERR_UNKNOWN;
+  CalibrationRun *run = &session->run;
+  size_t evaluations = run->evaluations;
+  size_t completed = run->generations;
+  size_t aborted = 0;
+  for (size_t w = 0; w < run->workers; w++)
+    aborted += run->pool[w].aborted;
+  gssk_monitor_init(&run->monitor, session->opts.control);
+  run->progress_start = evaluations;
+  run->progress_total = (session->stale ? session->opts.population : 0) +
+                        session->opts.population * (size_t)generations;
+
+  if (session->stale) {
+    GSSK_Status status = session_rescore(session);
+    if (status != GSSK_SUCCESS)
+      return status;
+  }
+  de_generations(run, &session->de, generations);
+
+  const ParamSpace *space = &session->space;
+  for (size_t i = 0; i < space->count; i++)
+    GSSK_SetEdgeK(session->inst, space->edges[i],
+                  param_to_k(&space->maps[i], run->best_params[i]));
+  if (report) {
+    report->best_fitness = run->best_fitness;
+    report->evaluations = run->evaluations - evaluations;
+    report->generations = run->generations - completed;
+    report->early_aborts = 0;
+    for (size_t w = 0; w < run->workers; w++)
+      report->early_aborts += run->pool[w].aborted;
+    report->early_aborts -= aborted;
+    report->screened = 0;
+    report->screen_dropped = 0;
+    report->cache_hits = 0;
+  }
+  return run->monitor.stopped ? GSSK_ERR_CANCELLED : GSSK_SUCCESS;
+}
+
+// --- Levenberg-Marquardt ---
+
+void GSSK_InitLMOptions(GSSK_LMOptions *opts) {
+  if (!opts)
+    return;
+  opts->edges = NULL;
+  opts->param_count = 0;
+  opts->iterations = 100;
+  opts->lambda = 1e-3;
+  opts->tolerance = 1e-10;
+  opts->k_min = 0.0;
+  opts->workspace = NULL;
+}
+
+typedef struct {
+  const gssk_schedule *schedule;
+  const ParamSpace *space;
+  gssk_sens sens;
+  double *dk;      /**< param_count, dk/du at the current coordinates */
+  double *prev_y;  /**< node_count */
+  double *prev_S;  /**< node_count * param_count */
+  double *jac_row; /**< param_count */
+  double *JtJ;     /**< param_count^2, Gauss-Newton matrix */
+  double *Jtr;     /**< param_count, gradient / 2 */
+} LMContext;
+
+// Load the k's of coordinates u into the integrator
+static void lm_set(LMContext *ctx, const double *u) {
+  const ParamSpace *space = ctx->space;
+  for (size_t a = 0; a < space->count; a++) {
+    ctx->sens.k[space->edges[a]] = param_to_k(&space->maps[a], u[a]);
+    ctx->dk[a] = param_dk(&space->maps[a], u[a]);
+  }
+}
+
+// Sum of squared residuals at the coefficients in ctx->sens.k. With
+// 'jacobian' set, also accumulates J^T J and J^T r from the sensitivities,
+// interpolated between steps exactly like the residuals and carried over to
+// the coordinates. INFINITY if the integration diverges.
+static double lm_evaluate(LMContext *ctx, double dt, bool jacobian) {
+  const gssk_schedule *sched = ctx->schedule;
+  gssk_sens *s = &ctx->sens;
+  size_t n = s->node_count;
+  size_t P = s->param_count;
+  s->tangent = jacobian;
+  if (jacobian) {
+    memset(ctx->JtJ, 0, P * P * sizeof(double));
+    memset(ctx->Jtr, 0, P * sizeof(double));
+  }
+  gssk_sens_reset(s);
+
+  double sse = 0.0;
+  for (size_t step = 1; step <= sched->last_step; step++) {
+    size_t first = sched->step_start[step];
+    size_t end = sched->step_start[step + 1];
+    if (first < end) {
+      memcpy(ctx->prev_y, s->y, n * sizeof(double));
+      if (jacobian)
+        memcpy(ctx->prev_S, s->S, n * P * sizeof(double));
+    }
+    if (gssk_sens_step(s, dt) != GSSK_SUCCESS)
+      return INFINITY;
+
+    for (size_t j = first; j < end; j++) {
+      size_t node = (size_t)sched->node[j];
+      double w = sched->weight[j];
+      double prev = ctx->prev_y[node];
+      double r = prev + w * (s->y[node] - prev) - sched->value[j];
+      sse += r * r;
+      if (!jacobian)
+        continue;
+      const double *sp = &ctx->prev_S[node * P];
+      const double *sc = &s->S[node * P];
+      for (size_t a = 0; a < P; a++)
+        ctx->jac_row[a] = (sp[a] + w * (sc[a] - sp[a])) * ctx->dk[a];
+      for (size_t a = 0; a < P; a++) {
+        ctx->Jtr[a] += ctx->jac_row[a] * r;
+        for (size_t b = 0; b <= a; b++)
+          ctx->JtJ[a * P + b] += ctx->jac_row[a] * ctx->jac_row[b];
+      }
+    }
+  }
+  return sse;
+}
+
+GSSK_Status GSSK_CalibrateLM(GSSK_Instance *inst,
+                             const GSSK_NodeObservations *obs,
+                             size_t obs_count, const GSSK_LMOptions *opts,
+                             GSSK_CalibrationReport *report) {
+  if (!inst || !obs || obs_count == 0 || !opts || opts->lambda <= 0.0)
+    return GSSK_ERR_UNKNOWN;
+  if (GSSK_GetEdgeCount(inst) == 0)
+    return report_nothing_to_fit(report);
+
+  GSSK_Workspace *ws = opts->workspace;
+  gssk_ws_mark mark = gssk_ws_get_mark(ws);
+  ParamSpace space;
+  GSSK_Status status =
+      param_space_init(&space, inst, opts->edges, opts->param_count, ws);
+  if (status != GSSK_SUCCESS) {
+    gssk_ws_release(ws, mark);
+    return status;
+  }
+  size_t P = space.count;
+
+  gssk_schedule schedule;
+  LMContext ctx;
+  memset(&ctx, 0, sizeof(ctx));
+  double *A = NULL, *delta = NULL, *u = NULL;
+  status = gssk_schedule_compile(&schedule, inst, obs, obs_count, ws);
+  if (status != GSSK_SUCCESS) {
+    param_space_free(&space);
+    gssk_ws_release(ws, mark);
+    return status;
+  }
+  if (schedule.count == 0) {
+    status = GSSK_ERR_UNKNOWN;
+    goto cleanup;
+  }
+  ctx.schedule = &schedule;
+  ctx.space = &space;
+  size_t n = GSSK_GetStateSize(inst);
+  status = gssk_sens_init(&ctx.sens, inst, space.edges, P, ws);
+  if (status != GSSK_SUCCESS)
+    goto cleanup;
+  ctx.dk = gssk_ws_alloc(ws, P * sizeof(double));
+  ctx.prev_y = gssk_ws_alloc(ws, n * sizeof(double));
+  ctx.prev_S = gssk_ws_alloc(ws, n * P * sizeof(double));
+  ctx.jac_row = gssk_ws_alloc(ws, P * sizeof(double));
+  ctx.JtJ = gssk_ws_alloc(ws, P * P * sizeof(double));
+  ctx.Jtr = gssk_ws_alloc(ws, P * sizeof(double));
+  A = gssk_ws_alloc(ws, P * P * sizeof(double));
+  delta = gssk_ws_alloc(ws, P * sizeof(double));
+  u = gssk_ws_alloc(ws, P * sizeof(double));
+  if (!ctx.dk || !ctx.prev_y || !ctx.prev_S || !ctx.jac_row || !ctx.JtJ ||
+      !ctx.Jtr || !A || !delta || !u) {
+    status = GSSK_ERR_MALLOC_FAILED;
+    goto cleanup;
+  }
+
+  // Start from the instance's k's, moved into the feasible set
+  double dt = GSSK_GetDt(inst);
+  for (size_t a = 0; a < P; a++) {
+    const ParamMap *m = &space.maps[a];
+    u[a] = param_from_k(m, space.base_k[space.edges[a]]);
+    if (u[a] < param_lower(m, opts->k_min))
+      u[a] = param_lower(m, opts->k_min);
+  }
+  lm_set(&ctx, u);
+  double sse = lm_evaluate(&ctx, dt, true);
+  size_t evaluations = 1;
+  if (isinf(sse)) {
+    status = GSSK_ERR_DIVERGENCE;
+    goto cleanup;
+  }
+
+  // Damped Gauss-Newton steps, (J^T J + lambda diag(J^T J)) delta = -J^T r,
+  // projected onto the bounds. A step that lowers the error is taken and
+  // relaxes the damping; otherwise the damping grows and the step shrinks.
+  double lambda = opts->lambda;
+  bool converged = sse == 0.0;
+  int iteration = 0;
+  for (; iteration < opts->iterations && !converged; iteration++) {
+    for (size_t a = 0; a < P; a++) {
+      for (size_t b = 0; b <= a; b++)
+        A[a * P + b] = ctx.JtJ[a * P + b];
+      double d = ctx.JtJ[a * P + a];
+      A[a * P + a] += lambda * (d > 1e-12 ? d : 1e-12);
+      delta[a] = -ctx.Jtr[a];
+    }
+    if (!gssk_cholesky(A, P)) {
+      lambda *= 10.0;
+      continue;
+    }
+    gssk_cholesky_solve(A, P, delta);
+
+    double step_norm = 0.0, u_norm = 0.0;
+    for (size_t a = 0; a < P; a++) {
+      double lower = param_lower(&space.maps[a], opts->k_min);
+      double upper = param_upper(&space.maps[a]);
+      double trial = u[a] + delta[a];
+      trial = trial < lower ? lower : (trial > upper ? upper : trial);
+      step_norm += (trial - u[a]) * (trial - u[a]);
+      u_norm += u[a] * u[a];
+      delta[a] = trial;
+    }
+    lm_set(&ctx, delta);
+    double trial_sse = lm_evaluate(&ctx, dt, false);
+    evaluations++;
+
+    if (trial_sse < sse) {
+      converged = sse - trial_sse <= opts->tolerance * sse;
+      memcpy(u, delta, P * sizeof(double));
+      sse = lm_evaluate(&ctx, dt, true);
+      evaluations++;
+      lambda /= 10.0;
+    } else {
+      lm_set(&ctx, u);
+      lambda *= 10.0;
+    }
+    // A step this small no longer moves the fit: k is stationary
+    if (sqrt(step_norm) <= opts->tolerance * (sqrt(u_norm) + opts->tolerance))
+      converged = true;
+  }
+
+  for (size_t a = 0; a < P; a++)
+    GSSK_SetEdgeK(inst, space.edges[a], param_to_k(&space.maps[a], u[a]));
+  if (report) {
+    report->best_fitness = sse / (double)schedule.count;
+    report->evaluations = evaluations;
+    report->generations = (size_t)iteration;
+    report->early_aborts = 0;
+    report->screened = 0;
+    report->screen_dropped = 0;
+    report->cache_hits = 0;
+  }
+  if (!converged)
+    status = GSSK_ERR_NOT_CONVERGED;
+
+cleanup:
+  gssk_sens_free(&ctx.sens);
+  gssk_ws_free(ws, ctx.dk);
+  gssk_ws_free(ws, ctx.prev_y);
+  gssk_ws_free(ws, ctx.prev_S);
+  gssk_ws_free(ws, ctx.jac_row);
+  gssk_ws_free(ws, ctx.JtJ);
+  gssk_ws_free(ws, ctx.Jtr);
+  gssk_ws_free(ws, A);
+  gssk_ws_free(ws, delta);
+  gssk_ws_free(ws, u);
+  gssk_schedule_free(&schedule);
+  param_space_free(&space);
+  gssk_ws_release(ws, mark);
+  return status;
+}
+
+// --- Projected L-BFGS ---
+
+void GSSK_InitLBFGSOptions(GSSK_LBFGSOptions *opts) {
+  if (!opts)
+    return;
+  opts->edges = NULL;
+  opts->param_count = 0;
+  opts->iterations = 200;
+  opts->memory = 8;
+  opts->tolerance = 1e-10;
+  opts->k_min = 0.0;
+  opts->checkpoints = 0;
+  opts->workspace = NULL;
+}
+
+typedef struct {
+  gssk_adjoint adj;
+  const ParamSpace *space;
+  double *full_grad;  /**< Adjoint gradient of every edge */
+  double scale;       /**< 1 / scheduled observations */
+  size_t evaluations;
+} LBFGSContext;
+
+// Mean squared error and its gradient over the coordinates x
+static GSSK_Status lbfgs_evaluate(LBFGSContext *c, const double *x, double *f,
+                                  double *g) {
+  const ParamSpace *space = c->space;
+  for (size_t a = 0; a < space->count; a++)
+    c->adj.sens.k[space->edges[a]] = param_to_k(&space->maps[a], x[a]);
+  double sse;
+  GSSK_Status status = gssk_adjoint_gradient(&c->adj, &sse, c->full_grad);
+  c->evaluations++;
+  if (status != GSSK_SUCCESS)
+    return status;
+  *f = sse * c->scale;
+  for (size_t a = 0; a < space->count; a++) {
+    g[a] = c->full_grad[space->edges[a]] * c->scale *
+           param_dk(&space->maps[a], x[a]);
+  }
+  return GSSK_SUCCESS;
+}
+
+// A coordinate held at a bound by its gradient stays there this iteration
+static bool lbfgs_at_bound(const ParamMap *m, double k_min, double x,
+                           double g) {
+  return (x <= param_lower(m, k_min) && g > 0.0) ||
+         (x >= param_upper(m) && g < 0.0);
+}
+
+static double dot(const double *a, const double *b, size_t n) {
+  double sum = 0.0;
+  for (size_t i = 0; i < n; i++)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+GSSK_Status GSSK_CalibrateLBFGS(GSSK_Instance *inst,
+                                const GSSK_NodeObservations *obs,
+                                size_t obs_count,
+                                const GSSK_LBFGSOptions *opts,
+                                GSSK_CalibrationReport *report) {
+  if (!inst || !obs || obs_count == 0 || !opts || opts->memory == 0)
+    return GSSK_ERR_UNKNOWN;
+  if (GSSK_GetEdgeCount(inst) == 0)
+    return report_nothing_to_fit(report);
+
+  GSSK_Workspace *ws = opts->workspace;
+  gssk_ws_mark mark = gssk_ws_get_mark(ws);
+  ParamSpace space;
+  GSSK_Status status =
+      param_space_init(&space, inst, opts->edges, opts->param_count, ws);
+  if (status != GSSK_SUCCESS) {
+    gssk_ws_release(ws, mark);
+    return status;
+  }
+  size_t P = space.count;
+
+  size_t m = opts->memory;
+  gssk_schedule schedule;
+  LBFGSContext ctx;
+  memset(&ctx, 0, sizeof(ctx));
+  double *x = NULL, *g = NULL, *x_new = NULL, *g_new = NULL, *d = NULL;
+  double *S = NULL, *Y = NULL, *rho = NULL, *alpha = NULL;
+  status = gssk_schedule_compile(&schedule, inst, obs, obs_count, ws);
+  if (status != GSSK_SUCCESS) {
+    param_space_free(&space);
+    gssk_ws_release(ws, mark);
+    return status;
+  }
+  if (schedule.count == 0) {
+    status = GSSK_ERR_UNKNOWN;
+    goto cleanup;
+  }
+  status = gssk_adjoint_init(&ctx.adj, inst, &schedule, opts->checkpoints, ws);
+  if (status != GSSK_SUCCESS)
+    goto cleanup;
+  ctx.space = &space;
+  ctx.scale = 1.0 / (double)schedule.count;
+  ctx.full_grad = gssk_ws_alloc(ws, GSSK_GetEdgeCount(inst) * sizeof(double));
+  x = gssk_ws_alloc(ws, P * sizeof(double));
+  g = gssk_ws_alloc(ws, P * sizeof(double));
+  x_new = gssk_ws_alloc(ws, P * sizeof(double));
+  g_new = gssk_ws_alloc(ws, P * sizeof(double));
+  d = gssk_ws_alloc(ws, P * sizeof(double));
+  S = gssk_ws_alloc(ws, m * P * sizeof(double));
+  Y = gssk_ws_alloc(ws, m * P * sizeof(double));
+  rho = gssk_ws_alloc(ws, m * sizeof(double));
+  alpha = gssk_ws_alloc(ws, m * sizeof(double));
+  if (!ctx.full_grad || !x || !g || !x_new || !g_new || !d || !S || !Y ||
+      !rho || !alpha) {
+    status = GSSK_ERR_MALLOC_FAILED;
+    goto cleanup;
+  }
+
+  for (size_t a = 0; a < P; a++) {
+    const ParamMap *m = &space.maps[a];
+    x[a] = param_from_k(m, space.base_k[space.edges[a]]);
+    if (x[a] < param_lower(m, opts->k_min))
+      x[a] = param_lower(m, opts->k_min);
+  }
+  double f;
+  status = lbfgs_evaluate(&ctx, x, &f, g);
+  if (status != GSSK_SUCCESS)
+    goto cleanup;
+
+  size_t history = 0, head = 0; // Stored pairs; slot of the next one
+  bool converged = f == 0.0;
+  int iteration = 0;
+  for (; iteration < opts->iterations && !converged; iteration++) {
+    // Two-loop recursion on the gradient of the free coordinates
+    for (size_t a = 0; a < P; a++)
+      d[a] = lbfgs_at_bound(&space.maps[a], opts->k_min, x[a], g[a]) ? 0.0
+                                                                      : g[a];
+    for (size_t h = 0; h < history; h++) {
+      size_t i = (head + m - 1 - h) % m;
+      alpha[i] = rho[i] * dot(&S[i * P], d, P);
+      for (size_t a = 0; a < P; a++)
+        d[a] -= alpha[i] * Y[i * P + a];
+    }
+    double gamma = 1.0;
+    if (history > 0) {
+      size_t i = (head + m - 1) % m;
+      gamma = dot(&S[i * P], &Y[i * P], P) / dot(&Y[i * P], &Y[i * P], P);
+    } else {
+      double norm = sqrt(dot(d, d, P));
+      gamma = norm > 1.0 ? 1.0 / norm : 1.0;
+    }
+    for (size_t a = 0; a < P; a++)
+      d[a] *= gamma;
+    for (size_t h = history; h-- > 0;) {
+      size_t i = (head + m - 1 - h) % m;
+      double beta = rho[i] * dot(&Y[i * P], d, P);
+      for (size_t a = 0; a < P; a++)
+        d[a] += S[i * P + a] * (alpha[i] - beta);
+    }
+    for (size_t a = 0; a < P; a++) {
+      d[a] = -d[a];
+      if (lbfgs_at_bound(&space.maps[a], opts->k_min, x[a], g[a]))
+        d[a] = 0.0;
+    }
+    if (dot(g, d, P) >= 0.0) {
+      if (history == 0) {
+        converged = true; // Stationary on the feasible set
+        break;
+      }
+      history = 0; // Curvature pairs gone stale: restart from the gradient
+      continue;
+    }
+
+    // Backtracking on the projected path (Armijo condition)
+    double t = 1.0, f_new = f;
+    bool accepted = false;
+    for (int ls = 0; ls < 40 && !accepted; ls++, t *= 0.5) {
+      for (size_t a = 0; a < P; a++) {
+        double lower = param_lower(&space.maps[a], opts->k_min);
+        double upper = param_upper(&space.maps[a]);
+        x_new[a] = x[a] + t * d[a];
+        x_new[a] = x_new[a] < lower ? lower
+                                    : (x_new[a] > upper ? upper : x_new[a]);
+      }
+      double decrease = 0.0;
+      for (size_t a = 0; a < P; a++)
+        decrease += g[a] * (x_new[a] - x[a]);
+      if (lbfgs_evaluate(&ctx, x_new, &f_new, g_new) == GSSK_SUCCESS &&
+          f_new <= f + 1e-4 * decrease)
+        accepted = true;
+    }
+    if (!accepted) {
+      if (history == 0) {
+        converged = true; // No descent left at machine precision
+        break;
+      }
+      history = 0;
+      continue;
+    }
+
+    // Keep the pair only with positive curvature
+    size_t i = head;
+    for (size_t a = 0; a < P; a++) {
+      S[i * P + a] = x_new[a] - x[a];
+      Y[i * P + a] = g_new[a] - g[a];
+    }
+    double sy = dot(&S[i * P], &Y[i * P], P);
+    if (sy > 1e-300) {
+      rho[i] = 1.0 / sy;
+      head = (head + 1) % m;
+      if (history < m)
+        history++;
+    }
+    converged = f - f_new <= opts->tolerance * f;
+    f = f_new;
+    memcpy(x, x_new, P * sizeof(double));
+    memcpy(g, g_new, P * sizeof(double));
+  }
+
+  for (size_t a = 0; a < P; a++)
+    GSSK_SetEdgeK(inst, space.edges[a], param_to_k(&space.maps[a], x[a]));
+  if (report) {
+    report->best_fitness = f;
+    report->evaluations = ctx.evaluations;
+    report->generations = (size_t)iteration;
+    report->early_aborts = 0;
+    report->screened = 0;
+    report->screen_dropped = 0;
+    report->cache_hits = 0;
+  }
+  if (!converged)
+    status = GSSK_ERR_NOT_CONVERGED;
+
+cleanup:
+  gssk_adjoint_free(&ctx.adj);
+  gssk_ws_free(ws, ctx.full_grad);
+  gssk_ws_free(ws, x);
+  gssk_ws_free(ws, g);
+  gssk_ws_free(ws, x_new);
+  gssk_ws_free(ws, g_new);
+  gssk_ws_free(ws, d);
+  gssk_ws_free(ws, S);
+  gssk_ws_free(ws, Y);
+  gssk_ws_free(ws, rho);
+  gssk_ws_free(ws, alpha);
+  gssk_schedule_free(&schedule);
+  param_space_free(&space);
+  gssk_ws_release(ws, mark);
+  return status;
+}
+
+// --- Parallel Tempering MCMC ---
+
+void GSSK_InitMCMCOptions(GSSK_MCMCOptions *opts) {
+  if (!opts)
+    return;
+  opts->edges = NULL;
+  opts->param_count = 0;
+  opts->noise = 1.0;
+  opts->chains = 4;
+  opts->max_temperature = 10.0;
+  opts->burn_in = 1000;
+  opts->thin = 1;
+  opts->swap_interval = 10;
+  opts->step = 0.1;
+  opts->k_min = 0.0;
+  opts->seed = 0;
+  opts->threads = 0;
+  opts->workspace = NULL;
+}
+
+// Acceptance rate the proposal scales are tuned towards during burn-in
+#define MCMC_TARGET_ACCEPTANCE 0.234
+
+// One tempered random-walk chain. Chains own their generator, so a chain's
+// moves do not depend on which worker runs it.
+typedef struct {
+  gssk_rng rng;
+  double *x;           /**< param_count, current state */
+  double *proposal;    /**< param_count */
+  double sse;          /**< Squared error of x */
+  double temperature;
+  double scale;        /**< Proposal scale multiplier */
+  size_t moves;        /**< Moves after burn-in */
+  size_t accepted;     /**< Of which accepted */
+  size_t evaluations;
+  double best_fitness;
+} MCMCChain;
+
+typedef struct {
+  const GSSK_MCMCOptions *opts;
+  const OptimizerContext *ctx;
+  CalibrationWorker *pool;
+  MCMCChain *chains;
+  const double *width; /**< param_count, proposal scale per coordinate */
+  double *samples;
+  size_t sample_count;
+  size_t first;        /**< Steps done before this round */
+  size_t steps;        /**< Steps in this round */
+} MCMCRound;
+
+// Advance one chain through a round of Metropolis steps. The uniform
+// deciding each move is drawn first, which turns acceptance into a bound on
+// the proposal's squared error that calculate_fitness can abort on.
+static void mcmc_task(void *arg, size_t index, size_t worker) {
+  MCMCRound *r = arg;
+  const GSSK_MCMCOptions *opts = r->opts;
+  const OptimizerContext *ctx = r->ctx;
+  MCMCChain *c = &r->chains[index];
+  size_t n = ctx->param_count;
+  double count = (double)ctx->data->observations;
+  double two_var = 2.0 * opts->noise * opts->noise;
+
+  for (size_t s = 0; s < r->steps; s++) {
+    size_t t = r->first + s + 1;
+    bool inside = true;
+    for (size_t i = 0; i < n; i++) {
+      const ParamMap *m = &ctx->space->maps[i];
+      c->proposal[i] = c->x[i] + c->scale * r->width[i] *
+                                     gssk_rng_normal(&c->rng);
+      if (c->proposal[i] < param_lower(m, opts->k_min) ||
+          c->proposal[i] > param_upper(m))
+        inside = false;
+    }
+    double u = gssk_rng_uniform(&c->rng);
+
+    bool accept = false;
+    if (inside) {
+      double threshold = c->sse - two_var * c->temperature * log(u);
+      double bound = threshold / count;
+      CalibrationWorker *w = &r->pool[worker];
+      calculate_fitness(ctx, w, 0, c->proposal, &bound, 1, NULL, NULL);
+      double fitness = worker_fitness(w, 0);
+      c->evaluations++;
+      double sse = fitness * count;
+      if (!w->batch.diverged[0] && sse <= threshold) {
+        accept = true;
+        c->sse = sse;
+        memcpy(c->x, c->proposal, n * sizeof(double));
+        if (fitness < c->best_fitness)
+          c->best_fitness = fitness;
+      }
+    }
+
+    if (t <= opts->burn_in) {
+      // Diminishing adaptation, frozen once sampling starts
+      c->scale *= exp(((accept ? 1.0 : 0.0) - MCMC_TARGET_ACCEPTANCE) /
+                      sqrt((double)t));
+      continue;
+    }
+    c->moves++;
+    c->accepted += accept;
+    size_t kept = t - opts->burn_in;
+    if (index == 0 && kept % opts->thin == 0 &&
+        kept / opts->thin <= r->sample_count) {
+      double *row = &r->samples[(kept / opts->thin - 1) * n];
+      for (size_t i = 0; i < n; i++)
+        row[i] = param_to_k(&ctx->space->maps[i], c->x[i]);
+    }
+  }
+}
+
+GSSK_Status GSSK_CalibrateMCMC(GSSK_Instance *inst,
+                               const GSSK_NodeObservations *obs,
+                               size_t obs_count, const GSSK_MCMCOptions *opts,
+                               double *samples, size_t sample_count,
+                               GSSK_MCMCReport *report) {
+  if (!inst || !obs || obs_count == 0 || !opts || !samples ||
+      sample_count == 0 || !(opts->noise > 0.0) || opts->chains == 0 ||
+      !(opts->max_temperature >= 1.0) || opts->thin == 0 ||
+      opts->swap_interval == 0 || !(opts->step > 0.0))
+    return GSSK_ERR_UNKNOWN;
+  // Nothing to sample, as for the calibrators
+  if (GSSK_GetEdgeCount(inst) == 0) {
+    if (report) {
+      memset(report, 0, sizeof(*report));
+      report->best_fitness = INFINITY;
+    }
+    return GSSK_SUCCESS;
+  }
+
+  GSSK_Workspace *ws = opts->workspace;
+  gssk_ws_mark mark = gssk_ws_get_mark(ws);
+  ParamSpace space;
+  GSSK_Status status =
+      param_space_init(&space, inst, opts->edges, opts->param_count, ws);
+  if (status != GSSK_SUCCESS) {
+    gssk_ws_release(ws, mark);
+    return status;
+  }
+  GSSK_Experiment experiment = {NULL, NULL, 0, obs, obs_count};
+  ExperimentSet data;
+  status = experiment_set_init(&data, inst, &experiment, 1, ws);
+  if (status != GSSK_SUCCESS) {
+    param_space_free(&space);
+    gssk_ws_release(ws, mark);
+    return status;
+  }
+  OptimizerContext ctx;
+  memset(&ctx, 0, sizeof(ctx));
+  ctx.data = &data;
+  ctx.space = &space;
+  ctx.param_count = space.count;
+  size_t n = space.count;
+  size_t C = opts->chains;
+
+  size_t workers = gssk_worker_count(opts->threads, C);
+  CalibrationWorker *pool = NULL;
+  MCMCChain *chains = NULL;
+  double *width = NULL;
+  if (data.observations == 0) {
+    status = GSSK_ERR_UNKNOWN;
+    goto cleanup;
+  }
+  pool = calibration_workers_alloc(inst, workers, ws);
+  chains = gssk_ws_calloc(ws, C, sizeof(MCMCChain));
+  width = gssk_ws_alloc(ws, n * sizeof(double));
+  if (!pool || !chains || !width) {
+    status = GSSK_ERR_MALLOC_FAILED;
+    goto cleanup;
+  }
+  for (size_t c = 0; c < C; c++) {
+    chains[c].x = gssk_ws_alloc(ws, n * sizeof(double));
+    chains[c].proposal = gssk_ws_alloc(ws, n * sizeof(double));
+    if (!chains[c].x || !chains[c].proposal) {
+      status = GSSK_ERR_MALLOC_FAILED;
+      goto cleanup;
+    }
+  }
+
+  // Every chain starts at the current k's, clamped into the prior
+  double *x0 = chains[0].x;
+  for (size_t i = 0; i < n; i++) {
+    const ParamMap *m = &space.maps[i];
+    x0[i] = param_from_k(m, space.base_k[space.edges[i]]);
+    if (x0[i] < param_lower(m, opts->k_min))
+      x0[i] = param_lower(m, opts->k_min);
+    width[i] = opts->step * (m->unit ? 1.0 : (x0[i] > 0.0 ? x0[i] : 1.0));
+  }
+  calculate_fitness(&ctx, &pool[0], 0, x0, NULL, 1, NULL, NULL);
+  double fitness = worker_fitness(&pool[0], 0);
+  if (pool[0].batch.diverged[0] || !isfinite(fitness)) {
+    status = GSSK_ERR_DIVERGENCE;
+    goto cleanup;
+  }
+
+  uint64_t seed = gssk_resolve_seed(opts->seed);
+  gssk_rng rng;
+  gssk_rng_seed(&rng, seed);
+  for (size_t c = 0; c < C; c++) {
+    MCMCChain *chain = &chains[c];
+    memcpy(chain->x, x0, n * sizeof(double));
+    chain->sse = fitness * (double)data.observations;
+    chain->temperature =
+        C > 1 ? pow(opts->max_temperature, (double)c / (double)(C - 1)) : 1.0;
+    chain->scale = sqrt(chain->temperature);
+    chain->best_fitness = fitness;
+    gssk_rng_seed(&chain->rng, gssk_rng_next(&rng));
+  }
+
+  // Rounds of swap_interval steps on every chain, then swaps between
+  // neighbouring temperatures, alternating even and odd pairs
+  size_t total = opts->burn_in + sample_count * opts->thin;
+  size_t swaps = 0, swapped = 0;
+  MCMCRound round = {opts, &ctx, pool, chains, width, samples, sample_count,
+                     0, 0};
+  for (size_t r = 0; round.first < total; r++) {
+    round.steps = total - round.first < opts->swap_interval
+                      ? total - round.first
+                      : opts->swap_interval;
+    gssk_parallel_for(C, workers, mcmc_task, &round);
+    round.first += round.steps;
+
+    double two_var = 2.0 * opts->noise * opts->noise;
+    for (size_t c = r % 2; c + 1 < C; c += 2) {
+      MCMCChain *a = &chains[c], *b = &chains[c + 1];
+      double log_alpha = (1.0 / a->temperature - 1.0 / b->temperature) *
+                         (a->sse - b->sse) / two_var;
+      swaps++;
+      if (log(gssk_rng_uniform(&rng)) < log_alpha) {
+        double *x = a->x;
+        a->x = b->x;
+        b->x = x;
+        double sse = a->sse;
+        a->sse = b->sse;
+        b->sse = sse;
+        swapped++;
+      }
+    }
+  }
+
+  if (report) {
+    report->samples = sample_count;
+    report->evaluations = 1;
+    report->early_aborts = 0;
+    report->best_fitness = INFINITY;
+    for (size_t c = 0; c < C; c++) {
+      report->evaluations += chains[c].evaluations;
+      if (chains[c].best_fitness < report->best_fitness)
+        report->best_fitness = chains[c].best_fitness;
+    }
+    for (size_t w = 0; w < workers; w++)
+      report->early_aborts += pool[w].aborted;
+    report->acceptance = chains[0].moves > 0 ? (double)chains[0].accepted /
+                                                   (double)chains[0].moves
+                                             : 0.0;
+    report->swap_rate = swaps > 0 ? (double)swapped / (double)swaps : 0.0;
+  }
+
+cleanup:
+  if (chains) {
+    for (size_t c = 0; c < C; c++) {
+      gssk_ws_free(ws, chains[c].x);
+      gssk_ws_free(ws, chains[c].proposal);
+    }
+  }
+  gssk_ws_free(ws, chains);
+  gssk_ws_free(ws, width);
+  calibration_workers_free(pool, workers, ws);
+  experiment_set_free(&data);
+  param_space_free(&space);
+  gssk_ws_release(ws, mark);
+  return status;
+}
@@ -1,60 +1,10 @@
 #include "gssk.h"
+#include "gssk_internal.h"
 #include "cJSON.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-// Internal Node types
-typedef enum {
-  NODE_STORAGE,
-  NODE_SOURCE,
-  NODE_SINK,
-  NODE_CONSTANT
-} GSSK_NodeType;
-
-// Internal Node structure for fast lookup
-typedef struct {
-  char id[64];
-  GSSK_NodeType type;
-  double initial_value;
-} GSSK_NodeInternal;
-
-// Internal Edge structure for the solver
-typedef struct {
-  int origin_idx;
-  int target_idx;
-  int control_idx;
-  GSSK_LogicType logic;
-  double k;
-  double threshold;
-} GSSK_EdgeInternal;
-
-// Internal Instance structure
-struct GSSK_Instance {
-  char error_msg[256];
-  double *state;
-  double *dQ;
-
-  // RK4 Scratchpads
-  double *k2;
-  double *k3;
-  double *k4;
-  double *tmp_state;
-
-  size_t node_count;
-  GSSK_NodeInternal *nodes;
-
-  GSSK_EdgeInternal *edges;
-  size_t edge_count;
-
-  struct {
-    double t_start;
-    double t_end;
-    double dt;
-    GSSK_Method method;
-  } config;
-};
-
 static GSSK_NodeType parse_node_type(const char *type_str) {
   if (strcmp(type_str, "storage") == 0)
     return NODE_STORAGE;
@@ -92,6 +42,47 @@ static GSSK_LogicType parse_logic_type(const char *type_str) {
   return -1;
 }
 
+// Optional params.calibrate: {"min": number, "max": number,
+// "scale": "linear" | "log"}
+static GSSK_Status parse_calibration(GSSK_Instance *inst, int i,
+                                     const cJSON *calibrate,
+                                     GSSK_EdgeInternal *edge) {
+  cJSON *min = cJSON_GetObjectItem(calibrate, "min");
+  cJSON *max = cJSON_GetObjectItem(calibrate, "max");
+  cJSON *scale = cJSON_GetObjectItem(calibrate, "scale");
+  if (!cJSON_IsObject(calibrate) || !cJSON_IsNumber(min) ||
+      !cJSON_IsNumber(max) || (scale && !cJSON_IsString(scale))) {
+    snprintf(inst->error_msg, sizeof(inst->error_msg),
+             "Schema Error: Edge %d 'calibrate' needs numeric 'min' and "
+             "'max'.",
+             i);
+    return GSSK_ERR_SCHEMA_VIOLATION;
+  }
+
+  edge->scale = GSSK_SCALE_LINEAR;
+  if (scale && strcmp(scale->valuestring, "log") == 0) {
+    edge->scale = GSSK_SCALE_LOG;
+  } else if (scale && strcmp(scale->valuestring, "linear") != 0) {
+    snprintf(inst->error_msg, sizeof(inst->error_msg),
+             "Schema Error: Unknown calibration scale '%s' in edge %d.",
+             scale->valuestring, i);
+    return GSSK_ERR_SCHEMA_VIOLATION;
+  }
+
+  edge->k_min = min->valuedouble;
+  edge->k_max = max->valuedouble;
+  if (!(edge->k_min < edge->k_max) ||
+      (edge->scale == GSSK_SCALE_LOG && !(edge->k_min > 0.0))) {
+    snprintf(inst->error_msg, sizeof(inst->error_msg),
+             "Schema Error: Edge %d calibration range [%g, %g] is empty%s.",
+             i, edge->k_min, edge->k_max,
+             edge->scale == GSSK_SCALE_LOG ? " or not positive" : "");
+    return GSSK_ERR_SCHEMA_VIOLATION;
+  }
+  edge->calibrate = true;
+  return GSSK_SUCCESS;
+}
+
 GSSK_Status GSSK_Init(const char *json_data, GSSK_Instance **out_inst) {
   if (!out_inst)
     return GSSK_ERR_UNKNOWN;
@@ -258,6 +249,13 @@ GSSK_Status GSSK_Init(const char *json_data, GSSK_Instance **out_inst) {
       else
         inst->edges[i].threshold = 0.0; // Default threshold
 
+      cJSON *calibrate = cJSON_GetObjectItem(params, "calibrate");
+      if (calibrate) {
+        status = parse_calibration(inst, i, calibrate, &inst->edges[i]);
+        if (status != GSSK_SUCCESS)
+          goto cleanup;
+      }
+
       // Logic-specific validation
       if (inst->edges[i].logic == GSSK_LOGIC_INTERACTION ||
           inst->edges[i].logic == GSSK_LOGIC_LIMIT) {
@@ -345,8 +343,8 @@ cleanup:
   return status;
 }
 
-static void compute_derivatives(GSSK_Instance *inst, const double *state,
-                                double *deriv) {
+void gssk_compute_derivatives(GSSK_Instance *inst, const double *state,
+                              double *deriv) {
   memset(deriv, 0, inst->node_count * sizeof(double));
 
   for (size_t i = 0; i < inst->edge_count; i++) {
@@ -410,28 +408,28 @@ GSSK_Status GSSK_Step(GSSK_Instance *inst, double dt) {
   size_t n = inst->node_count;
 
   if (inst->config.method == GSSK_METHOD_EULER) {
-    compute_derivatives(inst, inst->state, inst->dQ);
+    gssk_compute_derivatives(inst, inst->state, inst->dQ);
     for (size_t i = 0; i < n; i++) {
       inst->state[i] += inst->dQ[i] * dt;
     }
   } else if (inst->config.method == GSSK_METHOD_RK4) {
     // k1 = f(y)
-    compute_derivatives(inst, inst->state, inst->dQ);
+    gssk_compute_derivatives(inst, inst->state, inst->dQ);
 
     // k2 = f(y + h/2 * k1)
     for (size_t i = 0; i < n; i++)
       inst->tmp_state[i] = inst->state[i] + 0.5 * dt * inst->dQ[i];
-    compute_derivatives(inst, inst->tmp_state, inst->k2);
+    gssk_compute_derivatives(inst, inst->tmp_state, inst->k2);
 
     // k3 = f(y + h/2 * k2)
     for (size_t i = 0; i < n; i++)
       inst->tmp_state[i] = inst->state[i] + 0.5 * dt * inst->k2[i];
-    compute_derivatives(inst, inst->tmp_state, inst->k3);
+    gssk_compute_derivatives(inst, inst->tmp_state, inst->k3);
 
     // k4 = f(y + h * k3)
     for (size_t i = 0; i < n; i++)
       inst->tmp_state[i] = inst->state[i] + dt * inst->k3[i];
-    compute_derivatives(inst, inst->tmp_state, inst->k4);
+    gssk_compute_derivatives(inst, inst->tmp_state, inst->k4);
 
     // y = y + h/6 * (k1 + 2k2 + 2k3 + k4)
     for (size_t i = 0; i < n; i++) {
@@ -456,6 +454,53 @@ GSSK_Status GSSK_Step(GSSK_Instance *inst, double dt) {
   return GSSK_SUCCESS;
 }
 
+static double *clone_buffer(const double *src, size_t count) {
+  if (!src)
+    return NULL;
+  double *dst = malloc((count > 0 ? count : 1) * sizeof(double));
+  if (dst)
+    memcpy(dst, src, count * sizeof(double));
+  return dst;
+}
+
+GSSK_Status GSSK_Clone(GSSK_Instance *src, GSSK_Instance **out_inst) {
+  if (!src || !out_inst)
+    return GSSK_ERR_UNKNOWN;
+
+  *out_inst = NULL;
+  GSSK_Instance *inst = calloc(1, sizeof(GSSK_Instance));
+  if (!inst)
+    return GSSK_ERR_MALLOC_FAILED;
+
+  memcpy(inst->error_msg, src->error_msg, sizeof(inst->error_msg));
+  inst->node_count = src->node_count;
+  inst->edge_count = src->edge_count;
+  inst->config = src->config;
+
+  size_t n = src->node_count;
+  inst->state = clone_buffer(src->state, n);
+  inst->dQ = clone_buffer(src->dQ, n);
+  inst->k2 = clone_buffer(src->k2, n);
+  inst->k3 = clone_buffer(src->k3, n);
+  inst->k4 = clone_buffer(src->k4, n);
+  inst->tmp_state = clone_buffer(src->tmp_state, n);
+  inst->nodes = malloc((n > 0 ? n : 1) * sizeof(GSSK_NodeInternal));
+  inst->edges =
+      malloc((src->edge_count > 0 ? src->edge_count : 1) *
+             sizeof(GSSK_EdgeInternal));
+
+  if (!inst->state || !inst->dQ || !inst->nodes || !inst->edges ||
+      (src->k2 && (!inst->k2 || !inst->k3 || !inst->k4 || !inst->tmp_state))) {
+    GSSK_Free(inst);
+    return GSSK_ERR_MALLOC_FAILED;
+  }
+  memcpy(inst->nodes, src->nodes, n * sizeof(GSSK_NodeInternal));
+  memcpy(inst->edges, src->edges, src->edge_count * sizeof(GSSK_EdgeInternal));
+
+  *out_inst = inst;
+  return GSSK_SUCCESS;
+}
+
 const char *GSSK_GetErrorDescription(GSSK_Instance *inst) {
   return inst ? inst->error_msg : "Invalid Instance";
 }
@@ -506,6 +551,31 @@ void GSSK_SetEdgeK(GSSK_Instance *inst, size_t index, double k) {
   inst->edges[index].k = k;
 }
 
+bool GSSK_GetEdgeCalibration(GSSK_Instance *inst, size_t index, double *k_min,
+                             double *k_max, GSSK_ParamScale *scale) {
+  if (!inst || index >= inst->edge_count || !inst->edges[index].calibrate)
+    return false;
+  if (k_min)
+    *k_min = inst->edges[index].k_min;
+  if (k_max)
+    *k_max = inst->edges[index].k_max;
+  if (scale)
+    *scale = inst->edges[index].scale;
+  return true;
+}
+
+double GSSK_GetInitialValue(GSSK_Instance *inst, size_t index) {
+  if (!inst || index >= inst->node_count)
+    return 0.0;
+  return inst->nodes[index].initial_value;
+}
+
+void GSSK_SetInitialValue(GSSK_Instance *inst, size_t index, double value) {
+  if (!inst || index >= inst->node_count)
+    return;
+  inst->nodes[index].initial_value = value;
+}
+
 void GSSK_Free(GSSK_Instance *inst) {
   if (inst) {
     free(inst->state);
@@ -1,5 +1,8 @@
 export interface GSSKModule {
   _GSSK_Init(jsonPtr: number, outInstPtr: number): number;
+  _GSSK_Clone(kernelPtr: number, outInstPtr: number): number;
+  _GSSK_WorkspaceCreate(kernelPtr: number): number;
+  _GSSK_WorkspaceFree(workspacePtr: number): void;
   _GSSK_GetErrorDescription(kernelPtr: number): number;
   _GSSK_Step(kernelPtr: number, dt: number): number;
   _GSSK_GetState(kernelPtr: number): number;
@@ -13,9 +16,58 @@ export interface GSSKModule {
   _GSSK_GetEdgeCount(kernelPtr: number): number;
   _GSSK_GetEdgeK(kernelPtr: number, index: number): number;
   _GSSK_SetEdgeK(kernelPtr: number, index: number, k: number): void;
+  _GSSK_GetEdgeCalibration(kernelPtr: number, index: number, kMinPtr: number, kMaxPtr: number, scalePtr: number): number;
+  _GSSK_GetInitialValue(kernelPtr: number, index: number): number;
+  _GSSK_SetInitialValue(kernelPtr: number, index: number, value: number): void;
   _GSSK_EnsembleForecast(kernelPtr: number, runs: number, perturbation: number): number;
+  _GSSK_InitEnsembleOptions(optsPtr: number): void;
+  _GSSK_EnsembleForecastEx(kernelPtr: number, optsPtr: number): number;
   _GSSK_FreeEnsembleResult(resPtr: number): void;
+  _GSSK_EnsembleSessionCreate(kernelPtr: number, optsPtr: number): number;
+  _GSSK_EnsembleSessionAdd(sessionPtr: number, members: number): number;
+  _GSSK_EnsembleSessionRunUntilConverged(sessionPtr: number, tolerance: number, maxMembers: number, timeBudget: number, outErrorPtr: number): number;
+  _GSSK_EnsembleSessionGetMembers(sessionPtr: number): number;
+  _GSSK_EnsembleSessionGetResult(sessionPtr: number): number;
+  _GSSK_EnsembleSessionFree(sessionPtr: number): void;
+  _GSSK_EnsembleCompare(baselinePtr: number, scenarioPtr: number, optsPtr: number): number;
+  _GSSK_FreeScenarioDelta(resPtr: number): void;
+  _GSSK_InitEnKFOptions(optsPtr: number): void;
+  _GSSK_EnKFCreate(kernelPtr: number, optsPtr: number): number;
+  _GSSK_EnKFAdvance(filterPtr: number, t: number): number;
+  _GSSK_EnKFAssimilate(filterPtr: number, obsPtr: number, obsCount: number): number;
+  _GSSK_EnKFGetTime(filterPtr: number): number;
+  _GSSK_EnKFGetState(filterPtr: number, meanPtr: number, sdPtr: number): void;
+  _GSSK_EnKFGetK(filterPtr: number, meanPtr: number, sdPtr: number): void;
+  _GSSK_EnKFFree(filterPtr: number): void;
+  _GSSK_InitUnscentedOptions(optsPtr: number): void;
+  _GSSK_UnscentedForecast(kernelPtr: number, optsPtr: number): number;
+  _GSSK_InitIntervalOptions(optsPtr: number): void;
+  _GSSK_IntervalForecast(kernelPtr: number, optsPtr: number): number;
+  _GSSK_InitPCEOptions(optsPtr: number): void;
+  _GSSK_PCEBuild(kernelPtr: number, optsPtr: number, outPcePtr: number): number;
+  _GSSK_PCEEvaluate(pcePtr: number, kValuesPtr: number, outPtr: number): number;
+  _GSSK_FreePCEResult(pcePtr: number): void;
+  _GSSK_Sensitivities(kernelPtr: number, edgesPtr: number, paramCount: number, outResPtr: number): number;
+  _GSSK_FreeSensitivityResult(resPtr: number): void;
+  _GSSK_InitGlobalSensitivityOptions(optsPtr: number): void;
+  _GSSK_GlobalSensitivities(kernelPtr: number, optsPtr: number, outResPtr: number): number;
+  _GSSK_FreeGlobalSensitivityResult(resPtr: number): void;
+  _GSSK_InitGradientOptions(optsPtr: number): void;
+  _GSSK_Gradient(kernelPtr: number, obsPtr: number, obsCount: number, optsPtr: number, objectivePtr: number, gradientPtr: number): number;
+  _GSSK_InitCalibrationOptions(optsPtr: number): void;
+  _GSSK_CalibrateEx(kernelPtr: number, obsPtr: number, obsCount: number, optsPtr: number, reportPtr: number): number;
   _GSSK_Calibrate(kernelPtr: number, obsPtr: number, obsCount: number, iterations: number): number;
+  _GSSK_CalibrateExperiments(kernelPtr: number, experimentsPtr: number, experimentCount: number, optsPtr: number, reportPtr: number): number;
+  _GSSK_CalibrationSessionCreate(kernelPtr: number, optsPtr: number): number;
+  _GSSK_CalibrationSessionAddObservations(sessionPtr: number, obsPtr: number, obsCount: number): number;
+  _GSSK_CalibrationSessionRun(sessionPtr: number, generations: number, reportPtr: number): number;
+  _GSSK_CalibrationSessionFree(sessionPtr: number): void;
+  _GSSK_InitLMOptions(optsPtr: number): void;
+  _GSSK_CalibrateLM(kernelPtr: number, obsPtr: number, obsCount: number, optsPtr: number, reportPtr: number): number;
+  _GSSK_InitLBFGSOptions(optsPtr: number): void;
+  _GSSK_CalibrateLBFGS(kernelPtr: number, obsPtr: number, obsCount: number, optsPtr: number, reportPtr: number): number;
+  _GSSK_InitMCMCOptions(optsPtr: number): void;
+  _GSSK_CalibrateMCMC(kernelPtr: number, obsPtr: number, obsCount: number, optsPtr: number, samplesPtr: number, sampleCount: number, reportPtr: number): number;
   _GSSK_Free(kernelPtr: number): void;
   _malloc(size: number): number;
   _free(ptr: number): void;
@@ -0,0 +1,464 @@
+/**
+ * @file gssk_internal.h
+ * @brief Internal helpers shared between the GSSK translation units.
+ *
+ * Nothing in this header is part of the public ABI. It is included by the
+ * kernel sources only and may change without notice.
+ */
+
+#ifndef GSSK_INTERNAL_H
+#define GSSK_INTERNAL_H
+
+#include "gssk.h"
+#include <stdint.h>
+
+// --- Instance Layout ---
+
+// Internal Node types
+typedef enum {
+  NODE_STORAGE,
+  NODE_SOURCE,
+  NODE_SINK,
+  NODE_CONSTANT
+} GSSK_NodeType;
+
+// Internal Node structure for fast lookup
+typedef struct {
+  char id[64];
+  GSSK_NodeType type;
+  double initial_value;
+} GSSK_NodeInternal;
+
+// Internal Edge structure for the solver
+typedef struct {
+  int origin_idx;
+  int target_idx;
+  int control_idx;
+  GSSK_LogicType logic;
+  double k;
+  double threshold;
+  bool calibrate;        // k is fitted by the calibrators, in [k_min, k_max]
+  GSSK_ParamScale scale;
+  double k_min;
+  double k_max;
+} GSSK_EdgeInternal;
+
+// Internal Instance structure
+struct GSSK_Instance {
+  char error_msg[256];
+  double *state;
+  double *dQ;
+
+  // RK4 Scratchpads
+  double *k2;
+  double *k3;
+  double *k4;
+  double *tmp_state;
+
+  size_t node_count;
+  GSSK_NodeInternal *nodes;
+
+  GSSK_EdgeInternal *edges;
+  size_t edge_count;
+
+  struct {
+    double t_start;
+    double t_end;
+    double dt;
+    GSSK_Method method;
+  } config;
+};
+
+/**
+ * @brief Evaluate dQ/dt for an arbitrary state vector (the solver's RHS).
+ */
+void gssk_compute_derivatives(GSSK_Instance *inst, const double *state,
+                              double *deriv);
+
+/**
+ * @brief Flow of edge e with coefficient k, and its partial derivatives
+ *        with respect to k, the origin quantity and the control quantity.
+ *        Same arithmetic as gssk_compute_derivatives for the flow itself.
+ */
+static inline double gssk_flow_partials(const GSSK_EdgeInternal *e, double k,
+                                        const double *state, double *d_k,
+                                        double *d_q, double *d_c) {
+  double q = state[e->origin_idx];
+  double flow = 0.0;
+  *d_k = *d_q = *d_c = 0.0;
+  switch (e->logic) {
+  case GSSK_LOGIC_CONSTANT:
+    flow = k;
+    *d_k = 1.0;
+    break;
+  case GSSK_LOGIC_LINEAR:
+    flow = k * q;
+    *d_k = q;
+    *d_q = k;
+    break;
+  case GSSK_LOGIC_INTERACTION:
+    if (e->control_idx != -1) {
+      double c = state[e->control_idx];
+      flow = k * q * c;
+      *d_k = q * c;
+      *d_q = k * c;
+      *d_c = k * q;
+    }
+    break;
+  case GSSK_LOGIC_LIMIT:
+    if (e->control_idx != -1) {
+      double c = state[e->control_idx];
+      if (c > 1e-9) {
+        double den = 1.0 + (q / c);
+        flow = (k * q) / den;
+        *d_k = q / den;
+        *d_q = k / (den * den);
+        *d_c = k * q * q / (c * c * den * den);
+      }
+    }
+    break;
+  case GSSK_LOGIC_THRESHOLD:
+    // Piecewise constant in q: only the coefficient carries a derivative
+    flow = (q > e->threshold) ? k : 0.0;
+    *d_k = (q > e->threshold) ? 1.0 : 0.0;
+    break;
+  }
+  return flow;
+}
+
+// --- Random Number Generation ---
+
+/**
+ * @brief Small, fast PRNG (xoshiro256**) with per-call state.
+ *
+ * The kernel never touches global generator state, so every sampler owns
+ * its own stream and results are reproducible for a given seed.
+ */
+typedef struct {
+  uint64_t s[4];
+} gssk_rng;
+
+void gssk_rng_seed(gssk_rng *rng, uint64_t seed);
+uint64_t gssk_rng_next(gssk_rng *rng);
+double gssk_rng_uniform(gssk_rng *rng); /**< Uniform in (0, 1) */
+double gssk_rng_normal(gssk_rng *rng);  /**< Standard normal */
+
+/**
+ * @brief Seed of a public options block. 0 draws a seed from rand(), so
+ *        callers that seed the C library generator with srand stay
+ *        reproducible; any other value is returned unchanged.
+ */
+uint64_t gssk_resolve_seed(uint64_t seed);
+
+/**
+ * @brief Inverse of the standard normal CDF (Acklam's approximation).
+ */
+double gssk_inv_normal_cdf(double p);
+
+// --- Runtime ---
+
+/**
+ * @brief Monotonic wall-clock time in seconds (arbitrary origin).
+ */
+double gssk_wall_time(void);
+
+/**
+ * @brief Progress, cancellation and time budget of one long-running call,
+ *        driven by the caller's GSSK_Control block.
+ *
+ * gssk_monitor_expired only reads, so worker threads may poll it; the other
+ * functions belong to the calling thread.
+ */
+typedef struct {
+  const GSSK_Control *control; /**< NULL when the caller gave none */
+  double start;                /**< Wall time when the call started */
+  size_t next_report;          /**< Work done at which progress is due */
+  bool stopped;                /**< Latched once the call must wind down */
+} gssk_monitor;
+
+void gssk_monitor_init(gssk_monitor *m, const GSSK_Control *control);
+
+/**
+ * @brief True once the cancel flag is set or the time budget is spent.
+ */
+bool gssk_monitor_expired(const gssk_monitor *m);
+
+/**
+ * @brief Latch gssk_monitor_expired into m->stopped and return it.
+ */
+bool gssk_monitor_check(gssk_monitor *m);
+
+/**
+ * @brief True when a progress callback is due after 'done' units of work.
+ */
+bool gssk_monitor_due(const gssk_monitor *m, size_t done);
+
+/**
+ * @brief Invoke the progress callback and schedule the next one.
+ */
+void gssk_monitor_report(gssk_monitor *m, size_t done, size_t total,
+                         double best_fitness, const double *best_k);
+
+/**
+ * @brief Body of a parallel loop. 'worker' is in [0, workers) and identifies
+ *        the per-thread scratch (e.g. an instance clone) the task may use.
+ */
+typedef void (*gssk_task_fn)(void *ctx, size_t index, size_t worker);
+
+/**
+ * @brief Resolve a requested thread count (0 = all cores) for 'tasks' items.
+ *        Always 1 when the kernel is built without GSSK_THREADS.
+ */
+size_t gssk_worker_count(size_t requested, size_t tasks);
+
+/**
+ * @brief Run fn(ctx, i, worker) for every i in [0, count) on up to 'workers'
+ *        threads, returning once all tasks are done.
+ */
+void gssk_parallel_for(size_t count, size_t workers, gssk_task_fn fn,
+                       void *ctx);
+
+// --- Workspaces (workspace.c) ---
+
+/**
+ * @brief Position in a workspace, for releasing everything allocated after it.
+ */
+typedef struct {
+  size_t block;
+  size_t offset;
+} gssk_ws_mark;
+
+/**
+ * @brief Scratch allocation from 'ws', or from the heap when ws is NULL.
+ *        Workspace memory is 64-byte aligned and only reclaimed by
+ *        gssk_ws_release; gssk_ws_free is a no-op for it.
+ */
+void *gssk_ws_alloc(GSSK_Workspace *ws, size_t bytes);
+void *gssk_ws_calloc(GSSK_Workspace *ws, size_t count, size_t size);
+void gssk_ws_free(GSSK_Workspace *ws, void *p);
+gssk_ws_mark gssk_ws_get_mark(const GSSK_Workspace *ws);
+void gssk_ws_release(GSSK_Workspace *ws, gssk_ws_mark mark);
+
+// --- Simulation Helpers (advanced.c) ---
+
+/**
+ * @brief Number of recorded output steps from t_start to t_end inclusive.
+ */
+size_t gssk_output_steps(GSSK_Instance *inst);
+
+/**
+ * @brief Simulate from the initial state, recording node_count * step_count
+ *        values (step-major). Returns GSSK_ERR_DIVERGENCE on blow-up.
+ */
+GSSK_Status gssk_simulate_trajectory(GSSK_Instance *inst, size_t step_count,
+                                     double *out);
+
+/**
+ * @brief Allocate 'count' private clones of inst for worker threads.
+ */
+GSSK_Instance **gssk_clone_workers(GSSK_Instance *inst, size_t count);
+void gssk_free_workers(GSSK_Instance **workers, size_t count);
+
+// --- Batched Integration (batch.c) ---
+
+/**
+ * @brief Lockstep integrator for many parameter sets on one topology.
+ *
+ * Arrays are member-interleaved: entry (i, m) lives at i * lanes + m, for
+ * edge coefficients and node quantities alike. The model is only read, so
+ * several batches may share it across threads.
+ */
+typedef struct {
+  GSSK_Instance *model;
+  GSSK_Workspace *ws;      /**< Source of the arrays, NULL for the heap */
+  size_t lanes;            /**< Member capacity (array stride) */
+  size_t members;          /**< Members in use, <= lanes */
+  double *k;               /**< Edge coefficients, edge_count * lanes */
+  double *state;           /**< Node quantities, node_count * lanes */
+  double *d1, *d2, *d3, *d4, *tmp; /**< RK stages (d2..tmp RK4 only) */
+  double *flow;            /**< Per-edge flow scratch, lanes */
+  unsigned char *diverged; /**< Set once a member's state turns non-finite */
+} gssk_batch;
+
+GSSK_Status gssk_batch_init(gssk_batch *b, GSSK_Instance *model,
+                            size_t lanes, GSSK_Workspace *ws);
+void gssk_batch_free(gssk_batch *b);
+
+/**
+ * @brief Load the initial values into the first 'members' lanes: 'initial'
+ *        (node_count values), or the model's own when NULL. The caller
+ *        fills b->k for those lanes.
+ */
+void gssk_batch_reset(gssk_batch *b, size_t members, const double *initial);
+
+/**
+ * @brief Advance every member by dt with the model's method; same
+ *        arithmetic as GSSK_Step, lane by lane.
+ */
+void gssk_batch_step(gssk_batch *b, double dt);
+
+// --- Forward Sensitivities (sensitivity.c) ---
+
+/**
+ * @brief Integrator for the state and its tangent S = dQ/dk.
+ *
+ * Differentiates the discrete Euler/RK4 update of GSSK_Step exactly, so S
+ * is the gradient of the simulated (not the continuous) trajectory. The
+ * coefficients are taken from 'k' rather than the model, which is only read.
+ * With param_count 0 it is a plain integrator with its own k's.
+ */
+typedef struct {
+  GSSK_Instance *model;
+  GSSK_Workspace *ws;
+  size_t node_count;
+  size_t param_count;    /**< Columns of S */
+  const size_t *params;  /**< Edge of each column */
+  int *param_of_edge;    /**< Column of each edge, -1 if not a parameter */
+  double *k;             /**< Coefficient of every edge, edge_count */
+  bool tangent;          /**< Integrate S as well as the state */
+  double *y;             /**< State, node_count */
+  double *S;             /**< Tangent, node_count * param_count (row-major) */
+  double *y_stage, *d1, *d2, *d3, *d4;     /**< node_count */
+  double *S_stage, *T1, *T2, *T3, *T4;     /**< node_count * param_count */
+  double *row;           /**< param_count */
+} gssk_sens;
+
+GSSK_Status gssk_sens_init(gssk_sens *s, GSSK_Instance *model,
+                           const size_t *params, size_t param_count,
+                           GSSK_Workspace *ws);
+void gssk_sens_free(gssk_sens *s);
+
+/**
+ * @brief Load the initial state (and S = 0). k must be filled first.
+ */
+void gssk_sens_reset(gssk_sens *s);
+
+/**
+ * @brief Advance y (and S when s->tangent) by dt. Returns
+ *        GSSK_ERR_DIVERGENCE if the state becomes non-finite.
+ */
+GSSK_Status gssk_sens_step(gssk_sens *s, double dt);
+
+// --- Observation Schedule (calibration.c) ---
+
+/**
+ * @brief Observations compiled against the integration grid.
+ *
+ * Entry j belongs to output step s (the window (t_{s-1}, t_s]) and is
+ * compared with prev + weight[j] * (cur - prev) of node[j]. Entries of step
+ * s occupy [step_start[s], step_start[s + 1]), in input order.
+ */
+typedef struct {
+  GSSK_Workspace *ws;
+  size_t count;
+  size_t last_step;   /**< Final step with an observation, 0 if none */
+  size_t *step_start; /**< last_step + 2 offsets */
+  int *node;
+  double *weight;
+  double *value;
+} gssk_schedule;
+
+GSSK_Status gssk_schedule_compile(gssk_schedule *sched, GSSK_Instance *inst,
+                                  const GSSK_NodeObservations *obs,
+                                  size_t obs_count, GSSK_Workspace *ws);
+void gssk_schedule_free(gssk_schedule *sched);
+
+// --- Adjoint Gradients (sensitivity.c) ---
+
+/**
+ * @brief Reverse-mode gradient of the scheduled squared error.
+ *
+ * The forward pass keeps the state every 'segment' steps. The backward
+ * sweep then recomputes one segment at a time from its checkpoint, storing
+ * the stage derivatives, and pulls the adjoint back through each step. The
+ * coefficients are taken from sens.k.
+ */
+typedef struct {
+  gssk_sens sens;          /**< Plain integrator (no tangent) */
+  const gssk_schedule *schedule;
+  size_t segment;          /**< Steps between checkpoints */
+  size_t stages;           /**< Derivative evaluations per step */
+  double *checkpoints;     /**< node_count per segment */
+  double *seg_y;           /**< States of one segment, (segment + 1) rows */
+  double *seg_d;           /**< Stage derivatives, segment * stages rows */
+  double *lambda;          /**< d(SSE)/dy at the current step */
+  double *ybar, *kbar, *stage, *vbar; /**< node_count scratch; kbar has
+                                           'stages' rows */
+} gssk_adjoint;
+
+/**
+ * @brief Prepare an adjoint sweep. checkpoints = 0 keeps about sqrt(steps).
+ */
+GSSK_Status gssk_adjoint_init(gssk_adjoint *a, GSSK_Instance *model,
+                              const gssk_schedule *sched, size_t checkpoints,
+                              GSSK_Workspace *ws);
+void gssk_adjoint_free(gssk_adjoint *a);
+
+/**
+ * @brief Sum of squared residuals and its gradient with respect to every
+ *        edge k (edge_count values). Returns GSSK_ERR_DIVERGENCE if the
+ *        trajectory blows up.
+ */
+GSSK_Status gssk_adjoint_gradient(gssk_adjoint *a, double *sse,
+                                  double *grad);
+
+// --- Shared Helpers (uncertainty.c) ---
+
+/**
+ * @brief Resolve an edge subset (NULL selects every edge in order) into a
+ *        validated heap array. *count receives the subset size.
+ */
+GSSK_Status gssk_resolve_edges(GSSK_Instance *inst, const size_t *edges,
+                               size_t *count, size_t **out_edges);
+
+/**
+ * @brief In-place Cholesky factorization of a symmetric positive definite
+ *        n x n matrix (lower triangle). Returns 0 if it is not SPD.
+ */
+int gssk_cholesky(double *a, size_t n);
+
+/**
+ * @brief Solve L L^T x = b in place given the factor from gssk_cholesky.
+ */
+void gssk_cholesky_solve(const double *l, size_t n, double *b);
+
+/**
+ * @brief Eigen decomposition of a symmetric n x n matrix by cyclic Jacobi
+ *        rotations. 'a' is destroyed; eigenvalues go to 'values' and the
+ *        matching unit eigenvectors to the columns of 'vectors' (n x n).
+ */
+void gssk_symmetric_eigen(double *a, size_t n, double *values,
+                          double *vectors);
+
+// --- Design Samplers ---
+
+/**
+ * @brief Generator of points in the unit hypercube (0, 1)^dim.
+ */
+typedef struct {
+  GSSK_Workspace *ws;    /**< Source of the tables, NULL for the heap */
+  GSSK_Sampling kind;
+  size_t dim;
+  size_t count;
+  size_t index;
+  gssk_rng rng;
+  uint32_t *sobol_v;     /**< Scrambled direction numbers, dim * 32 */
+  uint32_t *sobol_x;     /**< Current Gray-code state, dim */
+  uint32_t *lhs_perm;    /**< Per-dimension permutation keys, dim. Re-keyed
+                              every 'count' points, so extending an LHS
+                              design appends a fresh replicate. */
+} gssk_sampler;
+
+GSSK_Status gssk_sampler_init(gssk_sampler *s, GSSK_Sampling kind,
+                              size_t dim, size_t count, uint64_t seed,
+                              GSSK_Workspace *ws);
+void gssk_sampler_next(gssk_sampler *s, double *u);
+void gssk_sampler_free(gssk_sampler *s);
+
+/**
+ * @brief Map a unit-interval draw to a multiplicative perturbation factor.
+ */
+double gssk_perturbation_factor(GSSK_Distribution dist, double spread,
+                                double u);
+
+#endif // GSSK_INTERNAL_H
@@ -0,0 +1,144 @@
+// Platform services (clocks, worker threads) used by the long-running
+// kernel entry points. Threading is compiled in with -DGSSK_THREADS; without
+// it (e.g. plain WASM builds) parallel loops run on the calling thread.
+#define _POSIX_C_SOURCE 200809L
+
+#include "gssk_internal.h"
+#include <time.h>
+
+#ifdef GSSK_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+double gssk_wall_time(void) {
+#ifdef CLOCK_MONOTONIC
+  struct timespec ts;
+  if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+  return (double)clock() / CLOCKS_PER_SEC;
+}
+
+void gssk_monitor_init(gssk_monitor *m, const GSSK_Control *control) {
+  m->control = control;
+  m->start = control ? gssk_wall_time() : 0.0;
+  m->next_report = control ? control->progress_interval : 0;
+  m->stopped = false;
+}
+
+bool gssk_monitor_expired(const gssk_monitor *m) {
+  const GSSK_Control *c = m->control;
+  if (!c)
+    return false;
+  if (c->cancel && *c->cancel)
+    return true;
+  return c->time_budget > 0.0 && gssk_wall_time() - m->start >= c->time_budget;
+}
+
+bool gssk_monitor_check(gssk_monitor *m) {
+  if (!m->stopped)
+    m->stopped = gssk_monitor_expired(m);
+  return m->stopped;
+}
+
+bool gssk_monitor_due(const gssk_monitor *m, size_t done) {
+  return m->control && m->control->progress && done >= m->next_report;
+}
+
+void gssk_monitor_report(gssk_monitor *m, size_t done, size_t total,
+                         double best_fitness, const double *best_k) {
+  const GSSK_Control *c = m->control;
+  GSSK_Progress progress = {done, total, gssk_wall_time() - m->start,
+                            best_fitness, best_k};
+  c->progress(&progress, c->user_data);
+  // An interval of 0 reports at every opportunity
+  m->next_report = done + (c->progress_interval > 0 ? c->progress_interval
+                                                    : 1);
+}
+
+size_t gssk_worker_count(size_t requested, size_t tasks) {
+  size_t workers = requested;
+#ifdef GSSK_THREADS
+  if (workers == 0) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    workers = cores > 0 ? (size_t)cores : 1;
+  }
+#else
+  workers = 1;
+#endif
+  if (workers > tasks)
+    workers = tasks;
+  return workers > 0 ? workers : 1;
+}
+
+#ifdef GSSK_THREADS
+typedef struct {
+  pthread_mutex_t lock;
+  size_t next;
+  size_t count;
+  gssk_task_fn fn;
+  void *ctx;
+} ParallelLoop;
+
+typedef struct {
+  ParallelLoop *loop;
+  size_t worker;
+} ParallelWorker;
+
+static void *parallel_worker(void *arg) {
+  ParallelWorker *w = arg;
+  ParallelLoop *loop = w->loop;
+  for (;;) {
+    pthread_mutex_lock(&loop->lock);
+    size_t index = loop->next++;
+    pthread_mutex_unlock(&loop->lock);
+    if (index >= loop->count)
+      break;
+    loop->fn(loop->ctx, index, w->worker);
+  }
+  return NULL;
+}
+#endif
+
+void gssk_parallel_for(size_t count, size_t workers, gssk_task_fn fn,
+                       void *ctx) {
+  if (count == 0)
+    return;
+#ifdef GSSK_THREADS
+  if (workers > 1) {
+    ParallelLoop loop;
+    loop.next = 0;
+    loop.count = count;
+    loop.fn = fn;
+    loop.ctx = ctx;
+    // Thread handles live on the stack: loops run once per generation or
+    // batch, and must not touch the heap
+    pthread_t threads[workers];
+    ParallelWorker args[workers];
+    if (pthread_mutex_init(&loop.lock, NULL) == 0) {
+      // Worker 0 is the calling thread; a failed spawn just means fewer
+      // helpers, since the remaining indices are drained by whoever is left.
+      size_t spawned = 1;
+      for (size_t w = 1; w < workers; w++) {
+        args[spawned].loop = &loop;
+        args[spawned].worker = spawned;
+        if (pthread_create(&threads[spawned], NULL, parallel_worker,
+                           &args[spawned]) == 0)
+          spawned++;
+      }
+      args[0].loop = &loop;
+      args[0].worker = 0;
+      parallel_worker(&args[0]);
+      for (size_t w = 1; w < spawned; w++)
+        pthread_join(threads[w], NULL);
+      pthread_mutex_destroy(&loop.lock);
+      return;
+    }
+  }
+#else
+  (void)workers;
+#endif
+  for (size_t i = 0; i < count; i++)
+    fn(ctx, i, 0);
+}
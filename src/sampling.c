@@ -0,0 +1,358 @@
+#include "gssk_internal.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --- Random Number Generation ---
+
+static uint64_t splitmix64(uint64_t *x) {
+  uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+void gssk_rng_seed(gssk_rng *rng, uint64_t seed) {
+  for (int i = 0; i < 4; i++)
+    rng->s[i] = splitmix64(&seed);
+}
+
+uint64_t gssk_rng_next(gssk_rng *rng) {
+  uint64_t *s = rng->s;
+  uint64_t result = rotl(s[1] * 5, 7) * 9;
+  uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotl(s[3], 45);
+  return result;
+}
+
+double gssk_rng_uniform(gssk_rng *rng) {
+  // 53 random mantissa bits, shifted off zero
+  return ((double)(gssk_rng_next(rng) >> 11) + 0.5) *
+         (1.0 / 9007199254740992.0);
+}
+
+double gssk_rng_normal(gssk_rng *rng) {
+  return gssk_inv_normal_cdf(gssk_rng_uniform(rng));
+}
+
+uint64_t gssk_resolve_seed(uint64_t seed) {
+  if (seed == 0)
+    seed = ((uint64_t)rand() << 32) ^ (uint64_t)rand();
+  return seed;
+}
+
+double gssk_inv_normal_cdf(double p) {
+  static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02,
+                             -2.759285104469687e+02, 1.383577518672690e+02,
+                             -3.066479806614716e+01, 2.506628277459239e+00};
+  static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02,
+                             -1.556989798598866e+02, 6.680131188771972e+01,
+                             -1.328068155288572e+01};
+  static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01,
+                             -2.400758277161838e+00, -2.549732539343734e+00,
+                             4.374664141464968e+00,  2.938163982698783e+00};
+  static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01,
+                             2.445134137142996e+00, 3.754408661907416e+00};
+  const double p_low = 0.02425;
+
+  if (p <= 0.0)
+    return -INFINITY;
+  if (p >= 1.0)
+    return INFINITY;
+
+  double x;
+  if (p < p_low) {
+    double q = sqrt(-2.0 * log(p));
+    x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+        ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+  } else if (p <= 1.0 - p_low) {
+    double q = p - 0.5;
+    double r = q * q;
+    x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) *
+        q /
+        (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+  } else {
+    double q = sqrt(-2.0 * log(1.0 - p));
+    x = -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q +
+          c[5]) /
+        ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+  }
+
+  // One Halley refinement step brings the result to full double precision
+  double e = 0.5 * erfc(-x / sqrt(2.0)) - p;
+  double u = e * 2.5066282746310002 * exp(x * x / 2.0); // sqrt(2 pi)
+  return x - u / (1.0 + x * u / 2.0);
+}
+
+double gssk_perturbation_factor(GSSK_Distribution dist, double spread,
+                                double u) {
+  switch (dist) {
+  case GSSK_DIST_NORMAL: {
+    double f = 1.0 + spread * gssk_inv_normal_cdf(u);
+    return f > 0.0 ? f : 0.0;
+  }
+  case GSSK_DIST_LOGNORMAL:
+    // Unit mean, so the ensemble stays centred on the nominal model
+    return exp(spread * gssk_inv_normal_cdf(u) - 0.5 * spread * spread);
+  case GSSK_DIST_UNIFORM:
+  default:
+    return 1.0 + spread * (2.0 * u - 1.0);
+  }
+}
+
+// --- Sobol Sequence ---
+
+#define SOBOL_BITS 32
+
+// Initial direction numbers (Joe & Kuo) for the first dimensions. Higher
+// dimensions use random odd initial values, which still yield a valid
+// digital sequence and are decorrelated further by the scrambling below.
+static const uint32_t sobol_init_m[][5] = {
+    {1, 0, 0, 0, 0},   {1, 3, 0, 0, 0},  {1, 3, 1, 0, 0},  {1, 1, 1, 0, 0},
+    {1, 1, 3, 3, 0},   {1, 3, 5, 13, 0}, {1, 1, 5, 5, 17}, {1, 1, 5, 5, 5},
+    {1, 1, 7, 11, 19}, {1, 1, 5, 1, 1},  {1, 1, 1, 3, 11}, {1, 3, 5, 5, 31}};
+static const unsigned sobol_init_s[] = {1, 2, 3, 3, 4, 4, 5, 5, 5, 5, 5, 5};
+#define SOBOL_INIT_COUNT (sizeof(sobol_init_s) / sizeof(sobol_init_s[0]))
+
+// Carry-less multiplication modulo a degree-s polynomial over GF(2)
+static uint64_t gf2_mulmod(uint64_t a, uint64_t b, uint64_t poly, unsigned s) {
+  uint64_t r = 0;
+  while (b) {
+    if (b & 1)
+      r ^= a;
+    b >>= 1;
+    a <<= 1;
+    if ((a >> s) & 1)
+      a ^= poly;
+  }
+  return r;
+}
+
+static uint64_t gf2_powmod(uint64_t e, uint64_t poly, unsigned s) {
+  uint64_t result = 1, base = (s == 1) ? 1 : 2; // x mod (x + 1) == 1
+  while (e) {
+    if (e & 1)
+      result = gf2_mulmod(result, base, poly, s);
+    base = gf2_mulmod(base, base, poly, s);
+    e >>= 1;
+  }
+  return result;
+}
+
+// A polynomial is primitive iff x has multiplicative order exactly 2^s - 1
+static int gf2_is_primitive(uint64_t poly, unsigned s) {
+  uint64_t order = (1ULL << s) - 1;
+  if (gf2_powmod(order, poly, s) != 1)
+    return 0;
+  uint64_t n = order;
+  for (uint64_t q = 2; q * q <= n; q++) {
+    if (n % q == 0) {
+      if (gf2_powmod(order / q, poly, s) == 1)
+        return 0;
+      while (n % q == 0)
+        n /= q;
+    }
+  }
+  if (n > 1 && gf2_powmod(order / n, poly, s) == 1)
+    return 0;
+  return 1;
+}
+
+static uint32_t parity32(uint32_t x) {
+  x ^= x >> 16;
+  x ^= x >> 8;
+  x ^= x >> 4;
+  x ^= x >> 2;
+  x ^= x >> 1;
+  return x & 1;
+}
+
+static GSSK_Status sobol_init(gssk_sampler *s) {
+  s->sobol_v = gssk_ws_alloc(s->ws, s->dim * SOBOL_BITS * sizeof(uint32_t));
+  s->sobol_x = gssk_ws_alloc(s->ws, s->dim * sizeof(uint32_t));
+  if (!s->sobol_v || !s->sobol_x)
+    return GSSK_ERR_MALLOC_FAILED;
+
+  gssk_rng m_rng; // Fixed stream so the unscrambled net is seed-independent
+  gssk_rng_seed(&m_rng, 0x50B01ULL);
+
+  unsigned deg = 1;
+  uint64_t a = 0;
+  uint32_t V[SOBOL_BITS + 1];
+
+  for (size_t j = 0; j < s->dim; j++) {
+    if (j == 0) {
+      for (unsigned i = 1; i <= SOBOL_BITS; i++)
+        V[i] = 1u << (SOBOL_BITS - i);
+    } else {
+      // Next primitive polynomial, ordered by degree then coefficients
+      for (;;) {
+        if (a >= (1ULL << (deg - 1))) {
+          deg++;
+          a = 0;
+          if (deg >= SOBOL_BITS)
+            return GSSK_ERR_UNKNOWN;
+        }
+        uint64_t poly = (1ULL << deg) | (a << 1) | 1;
+        a++;
+        if (gf2_is_primitive(poly, deg))
+          break;
+      }
+      unsigned sd = deg;
+      uint64_t coeffs = a - 1;
+
+      for (unsigned i = 1; i <= sd; i++) {
+        uint32_t m;
+        if (j - 1 < SOBOL_INIT_COUNT && sobol_init_s[j - 1] == sd)
+          m = sobol_init_m[j - 1][i - 1];
+        else
+          m = ((uint32_t)gssk_rng_next(&m_rng) & ((1u << i) - 1)) | 1u;
+        V[i] = m << (SOBOL_BITS - i);
+      }
+      for (unsigned i = sd + 1; i <= SOBOL_BITS; i++) {
+        V[i] = V[i - sd] ^ (V[i - sd] >> sd);
+        for (unsigned k = 1; k < sd; k++) {
+          if ((coeffs >> (sd - 1 - k)) & 1)
+            V[i] ^= V[i - k];
+        }
+      }
+    }
+
+    // Linear matrix scramble: random lower-triangular L with unit diagonal,
+    // where digit r of the output mixes in the more significant digits.
+    uint32_t L[SOBOL_BITS];
+    for (unsigned r = 0; r < SOBOL_BITS; r++) {
+      uint32_t higher = (r == 0) ? 0u : ~((1u << (SOBOL_BITS - r)) - 1u);
+      L[r] = ((uint32_t)gssk_rng_next(&s->rng) & higher) |
+             (1u << (SOBOL_BITS - 1 - r));
+    }
+    for (unsigned i = 1; i <= SOBOL_BITS; i++) {
+      uint32_t y = 0;
+      for (unsigned r = 0; r < SOBOL_BITS; r++)
+        y |= parity32(V[i] & L[r]) << (SOBOL_BITS - 1 - r);
+      s->sobol_v[j * SOBOL_BITS + (i - 1)] = y;
+    }
+
+    // Random digital shift doubles as the first point of the sequence
+    s->sobol_x[j] = (uint32_t)gssk_rng_next(&s->rng);
+  }
+  return GSSK_SUCCESS;
+}
+
+// --- Latin Hypercube ---
+
+// Stateless pseudo-random permutation of [0, n) (Kensler 2013), so the design
+// needs O(dim) memory instead of a stored permutation per dimension.
+static uint32_t lhs_permute(uint32_t i, uint32_t n, uint32_t key) {
+  uint32_t w = n - 1;
+  w |= w >> 1;
+  w |= w >> 2;
+  w |= w >> 4;
+  w |= w >> 8;
+  w |= w >> 16;
+  do {
+    i ^= key;
+    i *= 0xe170893du;
+    i ^= key >> 16;
+    i ^= (i & w) >> 4;
+    i ^= key >> 8;
+    i *= 0x0929eb3fu;
+    i ^= key >> 23;
+    i ^= (i & w) >> 1;
+    i *= 1u | key >> 27;
+    i *= 0x6935fa69u;
+    i ^= (i & w) >> 11;
+    i *= 0x74dcb303u;
+    i ^= (i & w) >> 2;
+    i *= 0x9e501cc1u;
+    i ^= (i & w) >> 2;
+    i *= 0xc860a3dfu;
+    i &= w;
+    i ^= i >> 5;
+  } while (i >= n);
+  return (uint32_t)(((uint64_t)i + key) % n);
+}
+
+// --- Sampler API ---
+
+GSSK_Status gssk_sampler_init(gssk_sampler *s, GSSK_Sampling kind,
+                              size_t dim, size_t count, uint64_t seed,
+                              GSSK_Workspace *ws) {
+  memset(s, 0, sizeof(*s));
+  s->ws = ws;
+  s->kind = kind;
+  s->dim = dim;
+  s->count = count;
+  gssk_rng_seed(&s->rng, seed);
+
+  if (dim == 0)
+    return GSSK_SUCCESS;
+
+  GSSK_Status status = GSSK_SUCCESS;
+  if (kind == GSSK_SAMPLING_SOBOL) {
+    status = sobol_init(s);
+  } else if (kind == GSSK_SAMPLING_LHS) {
+    if (count == 0 || count > UINT32_MAX)
+      return GSSK_ERR_UNKNOWN;
+    s->lhs_perm = gssk_ws_alloc(s->ws, dim * sizeof(uint32_t));
+    if (!s->lhs_perm)
+      return GSSK_ERR_MALLOC_FAILED;
+    for (size_t j = 0; j < dim; j++)
+      s->lhs_perm[j] = (uint32_t)gssk_rng_next(&s->rng);
+  }
+
+  if (status != GSSK_SUCCESS)
+    gssk_sampler_free(s);
+  return status;
+}
+
+void gssk_sampler_next(gssk_sampler *s, double *u) {
+  size_t n = s->index++;
+
+  switch (s->kind) {
+  case GSSK_SAMPLING_SOBOL:
+    if (n > 0) {
+      // Gray-code update: flip the direction number of the lowest set bit
+      unsigned c = 0;
+      while (((n >> c) & 1) == 0)
+        c++;
+      for (size_t j = 0; j < s->dim; j++)
+        s->sobol_x[j] ^= s->sobol_v[j * SOBOL_BITS + c];
+    }
+    for (size_t j = 0; j < s->dim; j++)
+      u[j] = ((double)s->sobol_x[j] + 0.5) * (1.0 / 4294967296.0);
+    break;
+  case GSSK_SAMPLING_LHS:
+    if (n > 0 && n % s->count == 0) {
+      for (size_t j = 0; j < s->dim; j++)
+        s->lhs_perm[j] = (uint32_t)gssk_rng_next(&s->rng);
+    }
+    for (size_t j = 0; j < s->dim; j++) {
+      uint32_t stratum = lhs_permute((uint32_t)(n % s->count),
+                                     (uint32_t)s->count, s->lhs_perm[j]);
+      u[j] = (stratum + gssk_rng_uniform(&s->rng)) / (double)s->count;
+    }
+    break;
+  case GSSK_SAMPLING_RANDOM:
+  default:
+    for (size_t j = 0; j < s->dim; j++)
+      u[j] = gssk_rng_uniform(&s->rng);
+    break;
+  }
+}
+
+void gssk_sampler_free(gssk_sampler *s) {
+  gssk_ws_free(s->ws, s->sobol_v);
+  gssk_ws_free(s->ws, s->sobol_x);
+  gssk_ws_free(s->ws, s->lhs_perm);
+  s->sobol_v = NULL;
+  s->sobol_x = NULL;
+  s->lhs_perm = NULL;
+}
@@ -0,0 +1,1061 @@
+// Sensitivity analysis. In forward mode the state is augmented with the
+// tangent S = dQ/dk of every node with respect to the selected edge
+// coefficients, and S is advanced by differentiating each stage of the
+// Euler/RK4 update with the analytic partials of the flow primitives. The
+// adjoint (reverse) mode pulls the gradient of a scalar objective back
+// through the same stages, at a cost independent of the number of k's. The
+// state itself follows exactly the arithmetic of GSSK_Step. Global
+// (variance-based and screening) sensitivities sample k over a perturbation
+// range instead, simulating the design in lockstep batches.
+#include "gssk.h"
+#include "gssk_internal.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+void gssk_sens_free(gssk_sens *s) {
+  if (!s)
+    return;
+  GSSK_Workspace *ws = s->ws;
+  gssk_ws_free(ws, s->param_of_edge);
+  gssk_ws_free(ws, s->k);
+  gssk_ws_free(ws, s->y);
+  gssk_ws_free(ws, s->S);
+  gssk_ws_free(ws, s->y_stage);
+  gssk_ws_free(ws, s->d1);
+  gssk_ws_free(ws, s->d2);
+  gssk_ws_free(ws, s->d3);
+  gssk_ws_free(ws, s->d4);
+  gssk_ws_free(ws, s->S_stage);
+  gssk_ws_free(ws, s->T1);
+  gssk_ws_free(ws, s->T2);
+  gssk_ws_free(ws, s->T3);
+  gssk_ws_free(ws, s->T4);
+  gssk_ws_free(ws, s->row);
+  memset(s, 0, sizeof(*s));
+}
+
+GSSK_Status gssk_sens_init(gssk_sens *s, GSSK_Instance *model,
+                           const size_t *params, size_t param_count,
+                           GSSK_Workspace *ws) {
+  memset(s, 0, sizeof(*s));
+  if (!model || (param_count > 0 && !params))
+    return GSSK_ERR_UNKNOWN;
+  s->model = model;
+  s->ws = ws;
+  s->node_count = model->node_count;
+  s->param_count = param_count;
+  s->params = params;
+  s->tangent = param_count > 0;
+
+  size_t n = model->node_count;
+  size_t ne = model->edge_count > 0 ? model->edge_count : 1;
+  size_t cells = n * param_count;
+  bool rk4 = model->config.method == GSSK_METHOD_RK4;
+  s->param_of_edge = gssk_ws_alloc(ws, ne * sizeof(int));
+  s->k = gssk_ws_alloc(ws, ne * sizeof(double));
+  s->y = gssk_ws_alloc(ws, n * sizeof(double));
+  s->S = gssk_ws_alloc(ws, cells * sizeof(double));
+  s->d1 = gssk_ws_alloc(ws, n * sizeof(double));
+  s->T1 = gssk_ws_alloc(ws, cells * sizeof(double));
+  s->row = gssk_ws_alloc(ws, param_count * sizeof(double));
+  if (rk4) {
+    s->y_stage = gssk_ws_alloc(ws, n * sizeof(double));
+    s->d2 = gssk_ws_alloc(ws, n * sizeof(double));
+    s->d3 = gssk_ws_alloc(ws, n * sizeof(double));
+    s->d4 = gssk_ws_alloc(ws, n * sizeof(double));
+    s->S_stage = gssk_ws_alloc(ws, cells * sizeof(double));
+    s->T2 = gssk_ws_alloc(ws, cells * sizeof(double));
+    s->T3 = gssk_ws_alloc(ws, cells * sizeof(double));
+    s->T4 = gssk_ws_alloc(ws, cells * sizeof(double));
+  }
+  if (!s->param_of_edge || !s->k || !s->y || !s->S || !s->d1 || !s->T1 ||
+      !s->row ||
+      (rk4 && (!s->y_stage || !s->d2 || !s->d3 || !s->d4 || !s->S_stage ||
+               !s->T2 || !s->T3 || !s->T4))) {
+    gssk_sens_free(s);
+    return GSSK_ERR_MALLOC_FAILED;
+  }
+
+  for (size_t i = 0; i < model->edge_count; i++) {
+    s->param_of_edge[i] = -1;
+    s->k[i] = model->edges[i].k;
+  }
+  for (size_t j = 0; j < param_count; j++)
+    s->param_of_edge[params[j]] = (int)j;
+  return GSSK_SUCCESS;
+}
+
+void gssk_sens_reset(gssk_sens *s) {
+  for (size_t i = 0; i < s->node_count; i++)
+    s->y[i] = s->model->nodes[i].initial_value;
+  memset(s->S, 0, s->node_count * s->param_count * sizeof(double));
+}
+
+// Derivative of the state (as gssk_compute_derivatives, with s->k) and,
+// when S is given, its tangent T = (df/dQ) S + df/dk
+static void sens_derivatives(gssk_sens *s, const double *y, double *deriv,
+                             const double *S, double *T) {
+  const GSSK_Instance *inst = s->model;
+  size_t P = s->param_count;
+  double *g = s->row;
+  memset(deriv, 0, inst->node_count * sizeof(double));
+  if (S)
+    memset(T, 0, inst->node_count * P * sizeof(double));
+
+  for (size_t i = 0; i < inst->edge_count; i++) {
+    const GSSK_EdgeInternal *e = &inst->edges[i];
+    double d_k, d_q, d_c;
+    double flow = gssk_flow_partials(e, s->k[i], y, &d_k, &d_q, &d_c);
+    deriv[e->origin_idx] -= flow;
+    deriv[e->target_idx] += flow;
+    if (!S)
+      continue;
+
+    const double *s_q = &S[(size_t)e->origin_idx * P];
+    for (size_t j = 0; j < P; j++)
+      g[j] = d_q * s_q[j];
+    if (d_c != 0.0) {
+      const double *s_c = &S[(size_t)e->control_idx * P];
+      for (size_t j = 0; j < P; j++)
+        g[j] += d_c * s_c[j];
+    }
+    if (s->param_of_edge[i] != -1)
+      g[s->param_of_edge[i]] += d_k;
+
+    double *t_o = &T[(size_t)e->origin_idx * P];
+    double *t_t = &T[(size_t)e->target_idx * P];
+    for (size_t j = 0; j < P; j++) {
+      t_o[j] -= g[j];
+      t_t[j] += g[j];
+    }
+  }
+
+  for (size_t i = 0; i < inst->node_count; i++) {
+    if (inst->nodes[i].type == NODE_SOURCE ||
+        inst->nodes[i].type == NODE_CONSTANT) {
+      deriv[i] = 0.0;
+      if (S)
+        memset(&T[i * P], 0, P * sizeof(double));
+    }
+  }
+}
+
+GSSK_Status gssk_sens_step(gssk_sens *s, double dt) {
+  size_t n = s->node_count;
+  size_t cells = n * s->param_count;
+  double *S = s->tangent ? s->S : NULL;
+
+  sens_derivatives(s, s->y, s->d1, S, s->T1);
+  if (s->model->config.method == GSSK_METHOD_EULER) {
+    for (size_t i = 0; i < n; i++)
+      s->y[i] += s->d1[i] * dt;
+    for (size_t c = 0; S && c < cells; c++)
+      S[c] += s->T1[c] * dt;
+  } else if (s->model->config.method == GSSK_METHOD_RK4) {
+    double *Ss = S ? s->S_stage : NULL;
+    for (size_t i = 0; i < n; i++)
+      s->y_stage[i] = s->y[i] + 0.5 * dt * s->d1[i];
+    for (size_t c = 0; S && c < cells; c++)
+      Ss[c] = S[c] + 0.5 * dt * s->T1[c];
+    sens_derivatives(s, s->y_stage, s->d2, Ss, s->T2);
+
+    for (size_t i = 0; i < n; i++)
+      s->y_stage[i] = s->y[i] + 0.5 * dt * s->d2[i];
+    for (size_t c = 0; S && c < cells; c++)
+      Ss[c] = S[c] + 0.5 * dt * s->T2[c];
+    sens_derivatives(s, s->y_stage, s->d3, Ss, s->T3);
+
+    for (size_t i = 0; i < n; i++)
+      s->y_stage[i] = s->y[i] + dt * s->d3[i];
+    for (size_t c = 0; S && c < cells; c++)
+      Ss[c] = S[c] + dt * s->T3[c];
+    sens_derivatives(s, s->y_stage, s->d4, Ss, s->T4);
+
+    for (size_t i = 0; i < n; i++) {
+      s->y[i] += (dt / 6.0) *
+                 (s->d1[i] + 2.0 * s->d2[i] + 2.0 * s->d3[i] + s->d4[i]);
+    }
+    for (size_t c = 0; S && c < cells; c++) {
+      S[c] += (dt / 6.0) *
+              (s->T1[c] + 2.0 * s->T2[c] + 2.0 * s->T3[c] + s->T4[c]);
+    }
+  }
+
+  // Divergence check and clamp, as in GSSK_Step. A clamped node is pinned
+  // at zero, so small changes of k leave it there
+  for (size_t i = 0; i < n; i++) {
+    if (isnan(s->y[i]) || isinf(s->y[i]))
+      return GSSK_ERR_DIVERGENCE;
+    if (s->y[i] < 0.0) {
+      s->y[i] = 0.0;
+      if (S)
+        memset(&S[i * s->param_count], 0, s->param_count * sizeof(double));
+    }
+  }
+  return GSSK_SUCCESS;
+}
+
+// --- Adjoint ---
+
+void gssk_adjoint_free(gssk_adjoint *a) {
+  if (!a)
+    return;
+  GSSK_Workspace *ws = a->sens.ws;
+  gssk_ws_free(ws, a->checkpoints);
+  gssk_ws_free(ws, a->seg_y);
+  gssk_ws_free(ws, a->seg_d);
+  gssk_ws_free(ws, a->lambda);
+  gssk_ws_free(ws, a->ybar);
+  gssk_ws_free(ws, a->kbar);
+  gssk_ws_free(ws, a->stage);
+  gssk_ws_free(ws, a->vbar);
+  gssk_sens_free(&a->sens);
+  memset(a, 0, sizeof(*a));
+}
+
+GSSK_Status gssk_adjoint_init(gssk_adjoint *a, GSSK_Instance *model,
+                              const gssk_schedule *sched, size_t checkpoints,
+                              GSSK_Workspace *ws) {
+  memset(a, 0, sizeof(*a));
+  if (!model || !sched)
+    return GSSK_ERR_UNKNOWN;
+  GSSK_Status status = gssk_sens_init(&a->sens, model, NULL, 0, ws);
+  if (status != GSSK_SUCCESS)
+    return status;
+  a->schedule = sched;
+
+  // Uniform checkpointing: about sqrt(steps) stored states by default, so
+  // the recomputed segment needs about as much memory as the checkpoints
+  size_t steps = sched->last_step > 0 ? sched->last_step : 1;
+  if (checkpoints == 0)
+    checkpoints = (size_t)ceil(sqrt((double)steps));
+  if (checkpoints > steps)
+    checkpoints = steps;
+  a->segment = (steps + checkpoints - 1) / checkpoints;
+  size_t stored = (steps + a->segment - 1) / a->segment;
+  a->stages = model->config.method == GSSK_METHOD_RK4 ? 4 : 1;
+
+  size_t n = model->node_count;
+  a->checkpoints = gssk_ws_alloc(ws, stored * n * sizeof(double));
+  a->seg_y = gssk_ws_alloc(ws, (a->segment + 1) * n * sizeof(double));
+  a->seg_d = gssk_ws_alloc(ws, a->segment * a->stages * n * sizeof(double));
+  a->lambda = gssk_ws_alloc(ws, n * sizeof(double));
+  a->ybar = gssk_ws_alloc(ws, n * sizeof(double));
+  a->kbar = gssk_ws_alloc(ws, a->stages * n * sizeof(double));
+  a->stage = gssk_ws_alloc(ws, n * sizeof(double));
+  a->vbar = gssk_ws_alloc(ws, n * sizeof(double));
+  if (!a->checkpoints || !a->seg_y || !a->seg_d || !a->lambda || !a->ybar ||
+      !a->kbar || !a->stage || !a->vbar) {
+    gssk_adjoint_free(a);
+    return GSSK_ERR_MALLOC_FAILED;
+  }
+  return GSSK_SUCCESS;
+}
+
+static bool node_is_fixed(const GSSK_Instance *inst, int idx) {
+  return inst->nodes[idx].type == NODE_SOURCE ||
+         inst->nodes[idx].type == NODE_CONSTANT;
+}
+
+// Vector-Jacobian product of the derivative function at y: out = (df/dy)^T
+// cot, and grad += (df/dk)^T cot. Fixed nodes have no derivative, so their
+// entries of cot do not contribute.
+static void adjoint_vjp(gssk_adjoint *a, const double *y, const double *cot,
+                        double *out, double *grad) {
+  const GSSK_Instance *inst = a->sens.model;
+  memset(out, 0, inst->node_count * sizeof(double));
+  for (size_t i = 0; i < inst->edge_count; i++) {
+    const GSSK_EdgeInternal *e = &inst->edges[i];
+    double c_o = node_is_fixed(inst, e->origin_idx) ? 0.0 : cot[e->origin_idx];
+    double c_t = node_is_fixed(inst, e->target_idx) ? 0.0 : cot[e->target_idx];
+    double g = c_t - c_o;
+    if (g == 0.0)
+      continue;
+    double d_k, d_q, d_c;
+    gssk_flow_partials(e, a->sens.k[i], y, &d_k, &d_q, &d_c);
+    out[e->origin_idx] += g * d_q;
+    if (d_c != 0.0)
+      out[e->control_idx] += g * d_c;
+    grad[i] += g * d_k;
+  }
+}
+
+// Pull lambda = d(SSE)/dy_{s} back through the step from y (= y_{s-1})
+// whose stage derivatives are d, leaving d(SSE)/dy_{s-1} in lambda
+static void adjoint_step(gssk_adjoint *a, const double *y, const double *d,
+                         double dt, double *grad) {
+  size_t n = a->sens.node_count;
+  double *lambda = a->lambda;
+  const double *d1 = d;
+
+  // A clamped node is pinned at zero and passes nothing back. The update
+  // is recomputed with the arithmetic of gssk_sens_step to find them
+  for (size_t i = 0; i < n; i++) {
+    double pre;
+    if (a->stages == 1) {
+      pre = y[i] + d1[i] * dt;
+    } else {
+      pre = y[i] + (dt / 6.0) * (d1[i] + 2.0 * d[n + i] + 2.0 * d[2 * n + i] +
+                                 d[3 * n + i]);
+    }
+    if (pre < 0.0)
+      lambda[i] = 0.0;
+  }
+
+  memcpy(a->ybar, lambda, n * sizeof(double));
+  if (a->stages == 1) {
+    for (size_t i = 0; i < n; i++)
+      a->kbar[i] = dt * lambda[i];
+    adjoint_vjp(a, y, a->kbar, a->vbar, grad);
+    for (size_t i = 0; i < n; i++)
+      a->ybar[i] += a->vbar[i];
+  } else {
+    double *kb1 = a->kbar, *kb2 = &a->kbar[n], *kb3 = &a->kbar[2 * n],
+           *kb4 = &a->kbar[3 * n];
+    for (size_t i = 0; i < n; i++) {
+      kb1[i] = (dt / 6.0) * lambda[i];
+      kb2[i] = (dt / 6.0) * 2.0 * lambda[i];
+      kb3[i] = (dt / 6.0) * 2.0 * lambda[i];
+      kb4[i] = (dt / 6.0) * lambda[i];
+    }
+    // Stages in reverse: Y4 = y + dt d3, Y3 = y + dt/2 d2, Y2 = y + dt/2 d1
+    for (size_t i = 0; i < n; i++)
+      a->stage[i] = y[i] + dt * d[2 * n + i];
+    adjoint_vjp(a, a->stage, kb4, a->vbar, grad);
+    for (size_t i = 0; i < n; i++) {
+      a->ybar[i] += a->vbar[i];
+      kb3[i] += dt * a->vbar[i];
+    }
+    for (size_t i = 0; i < n; i++)
+      a->stage[i] = y[i] + 0.5 * dt * d[n + i];
+    adjoint_vjp(a, a->stage, kb3, a->vbar, grad);
+    for (size_t i = 0; i < n; i++) {
+      a->ybar[i] += a->vbar[i];
+      kb2[i] += 0.5 * dt * a->vbar[i];
+    }
+    for (size_t i = 0; i < n; i++)
+      a->stage[i] = y[i] + 0.5 * dt * d1[i];
+    adjoint_vjp(a, a->stage, kb2, a->vbar, grad);
+    for (size_t i = 0; i < n; i++) {
+      a->ybar[i] += a->vbar[i];
+      kb1[i] += 0.5 * dt * a->vbar[i];
+    }
+    adjoint_vjp(a, y, kb1, a->vbar, grad);
+    for (size_t i = 0; i < n; i++)
+      a->ybar[i] += a->vbar[i];
+  }
+  memcpy(lambda, a->ybar, n * sizeof(double));
+}
+
+// Add the residual terms of step s to lambda: the current-state share
+// (weight) when 'current' is set, else the previous-state share
+static void adjoint_residuals(gssk_adjoint *a, size_t s, const double *prev,
+                              const double *cur, bool current) {
+  const gssk_schedule *sched = a->schedule;
+  for (size_t j = sched->step_start[s]; j < sched->step_start[s + 1]; j++) {
+    size_t node = (size_t)sched->node[j];
+    double w = sched->weight[j];
+    double r = prev[node] + w * (cur[node] - prev[node]) - sched->value[j];
+    a->lambda[node] += 2.0 * r * (current ? w : 1.0 - w);
+  }
+}
+
+GSSK_Status gssk_adjoint_gradient(gssk_adjoint *a, double *sse,
+                                  double *grad) {
+  gssk_sens *s = &a->sens;
+  const gssk_schedule *sched = a->schedule;
+  size_t n = s->node_count;
+  size_t N = sched->last_step;
+  double dt = s->model->config.dt;
+  memset(grad, 0, s->model->edge_count * sizeof(double));
+
+  // Forward pass, scoring as calculate_fitness does
+  *sse = 0.0;
+  gssk_sens_reset(s);
+  for (size_t step = 1; step <= N; step++) {
+    if ((step - 1) % a->segment == 0)
+      memcpy(&a->checkpoints[(step - 1) / a->segment * n], s->y,
+             n * sizeof(double));
+    size_t first = sched->step_start[step];
+    size_t end = sched->step_start[step + 1];
+    if (first < end)
+      memcpy(a->stage, s->y, n * sizeof(double));
+    if (gssk_sens_step(s, dt) != GSSK_SUCCESS)
+      return GSSK_ERR_DIVERGENCE;
+    for (size_t j = first; j < end; j++) {
+      size_t node = (size_t)sched->node[j];
+      double prev = a->stage[node];
+      double r = prev + sched->weight[j] * (s->y[node] - prev) -
+                 sched->value[j];
+      *sse += r * r;
+    }
+  }
+
+  // Backward sweep, one recomputed segment at a time
+  size_t L = a->segment, st = a->stages;
+  memset(a->lambda, 0, n * sizeof(double));
+  for (size_t c = (N + L - 1) / L; c-- > 0;) {
+    size_t start = c * L;
+    size_t len = N - start < L ? N - start : L;
+    memcpy(s->y, &a->checkpoints[c * n], n * sizeof(double));
+    for (size_t l = 0; l < len; l++) {
+      memcpy(&a->seg_y[l * n], s->y, n * sizeof(double));
+      gssk_sens_step(s, dt); // Replays the forward pass, which succeeded
+      double *d = &a->seg_d[l * st * n];
+      memcpy(d, s->d1, n * sizeof(double));
+      if (st == 4) {
+        memcpy(&d[n], s->d2, n * sizeof(double));
+        memcpy(&d[2 * n], s->d3, n * sizeof(double));
+        memcpy(&d[3 * n], s->d4, n * sizeof(double));
+      }
+    }
+    memcpy(&a->seg_y[len * n], s->y, n * sizeof(double));
+
+    for (size_t l = len; l-- > 0;) {
+      size_t step = start + l + 1;
+      const double *prev = &a->seg_y[l * n], *cur = &a->seg_y[(l + 1) * n];
+      adjoint_residuals(a, step, prev, cur, true);
+      adjoint_step(a, prev, &a->seg_d[l * st * n], dt, grad);
+      adjoint_residuals(a, step, prev, cur, false);
+    }
+  }
+  return GSSK_SUCCESS;
+}
+
+// --- Public API ---
+
+GSSK_Status GSSK_Sensitivities(GSSK_Instance *inst, const size_t *edges,
+                               size_t param_count,
+                               GSSK_SensitivityResult **out_res) {
+  if (!inst || !out_res)
+    return GSSK_ERR_UNKNOWN;
+  *out_res = NULL;
+
+  GSSK_SensitivityResult *res = calloc(1, sizeof(GSSK_SensitivityResult));
+  if (!res)
+    return GSSK_ERR_MALLOC_FAILED;
+  size_t p = param_count;
+  GSSK_Status status = gssk_resolve_edges(inst, edges, &p, &res->edges);
+  if (status != GSSK_SUCCESS) {
+    free(res);
+    return status;
+  }
+  res->param_count = p;
+  res->node_count = GSSK_GetStateSize(inst);
+  res->step_count = gssk_output_steps(inst);
+
+  size_t cells = res->node_count * res->step_count;
+  res->state = malloc(cells * sizeof(double));
+  res->sensitivity = malloc(cells * p * sizeof(double));
+  gssk_sens sens;
+  memset(&sens, 0, sizeof(sens));
+  if (!res->state || !res->sensitivity ||
+      gssk_sens_init(&sens, inst, res->edges, p, NULL) != GSSK_SUCCESS) {
+    GSSK_FreeSensitivityResult(res);
+    return GSSK_ERR_MALLOC_FAILED;
+  }
+
+  // Same recording loop as gssk_simulate_trajectory
+  double dt = GSSK_GetDt(inst);
+  size_t n = res->node_count;
+  gssk_sens_reset(&sens);
+  for (size_t s = 0; s < res->step_count; s++) {
+    memcpy(&res->state[s * n], sens.y, n * sizeof(double));
+    memcpy(&res->sensitivity[s * n * p], sens.S, n * p * sizeof(double));
+    if (s + 1 < res->step_count && status == GSSK_SUCCESS)
+      status = gssk_sens_step(&sens, dt);
+  }
+  gssk_sens_free(&sens);
+
+  if (status != GSSK_SUCCESS) {
+    GSSK_FreeSensitivityResult(res);
+    return status;
+  }
+  *out_res = res;
+  return GSSK_SUCCESS;
+}
+
+void GSSK_FreeSensitivityResult(GSSK_SensitivityResult *res) {
+  if (!res)
+    return;
+  free(res->edges);
+  free(res->state);
+  free(res->sensitivity);
+  free(res);
+}
+
+void GSSK_InitGradientOptions(GSSK_GradientOptions *opts) {
+  if (!opts)
+    return;
+  opts->checkpoints = 0;
+  opts->workspace = NULL;
+}
+
+GSSK_Status GSSK_Gradient(GSSK_Instance *inst,
+                          const GSSK_NodeObservations *obs, size_t obs_count,
+                          const GSSK_GradientOptions *opts, double *objective,
+                          double *gradient) {
+  if (!inst || !obs || obs_count == 0 || !objective || !gradient)
+    return GSSK_ERR_UNKNOWN;
+  GSSK_GradientOptions defaults;
+  if (!opts) {
+    GSSK_InitGradientOptions(&defaults);
+    opts = &defaults;
+  }
+
+  GSSK_Workspace *ws = opts->workspace;
+  gssk_ws_mark mark = gssk_ws_get_mark(ws);
+  gssk_schedule schedule;
+  GSSK_Status status =
+      gssk_schedule_compile(&schedule, inst, obs, obs_count, ws);
+  if (status != GSSK_SUCCESS) {
+    gssk_ws_release(ws, mark);
+    return status;
+  }
+  gssk_adjoint adj;
+  memset(&adj, 0, sizeof(adj));
+  if (schedule.count == 0) {
+    status = GSSK_ERR_UNKNOWN;
+    goto cleanup;
+  }
+  status = gssk_adjoint_init(&adj, inst, &schedule, opts->checkpoints, ws);
+  if (status != GSSK_SUCCESS)
+    goto cleanup;
+
+  double sse;
+  status = gssk_adjoint_gradient(&adj, &sse, gradient);
+  if (status == GSSK_SUCCESS) {
+    // Objective is the mean squared error, as reported by the calibrators
+    double scale = 1.0 / (double)schedule.count;
+    *objective = sse * scale;
+    for (size_t i = 0; i < GSSK_GetEdgeCount(inst); i++)
+      gradient[i] *= scale;
+  }
+
+cleanup:
+  gssk_adjoint_free(&adj);
+  gssk_schedule_free(&schedule);
+  gssk_ws_release(ws, mark);
+  return status;
+}
+
+// --- Global Sensitivity Analysis ---
+
+// Design runs are simulated this many at a time by the lockstep integrator
+#define GSA_LANES 8
+
+void GSSK_InitGlobalSensitivityOptions(GSSK_GlobalSensitivityOptions *opts) {
+  if (!opts)
+    return;
+  opts->edges = NULL;
+  opts->param_count = 0;
+  opts->nodes = NULL;
+  opts->node_count = 0;
+  opts->times = NULL;
+  opts->time_count = 0;
+  opts->method = GSSK_GSA_MORRIS;
+  opts->distribution = GSSK_DIST_UNIFORM;
+  opts->perturbation = 0.1;
+  opts->samples = 20;
+  opts->levels = 4;
+  opts->bootstrap = 100;
+  opts->confidence = 0.95;
+  opts->seed = 0;
+  opts->threads = 0;
+}
+
+void GSSK_FreeGlobalSensitivityResult(GSSK_GlobalSensitivityResult *res) {
+  if (!res)
+    return;
+  free(res->edges);
+  free(res->nodes);
+  free(res->times);
+  free(res->peak);
+  free(res->mu_star);
+  free(res->mu_star_lo);
+  free(res->mu_star_hi);
+  free(res->mu);
+  free(res->sigma);
+  free(res->first);
+  free(res->first_lo);
+  free(res->first_hi);
+  free(res->total);
+  free(res->total_lo);
+  free(res->total_hi);
+  free(res->variance);
+  free(res);
+}
+
+typedef struct {
+  GSSK_Instance *model;
+  const GSSK_GlobalSensitivityResult *res;
+  const double *base_k;  /**< k of every edge */
+  const double *design;  /**< k of every parameter, runs * param_count */
+  const size_t *steps;   /**< Output step of each time, time_count */
+  const size_t *order;   /**< Times in step order */
+  size_t runs;
+  size_t cells;          /**< output_count * time_count */
+  double *outputs;       /**< runs * cells */
+  gssk_batch *batches;   /**< One per worker */
+} GSADesign;
+
+// Simulate one block of design runs, recording the selected outputs (NAN
+// once a run diverged) as gssk_simulate_trajectory would
+static void gsa_design_task(void *arg, size_t block, size_t worker) {
+  GSADesign *d = arg;
+  const GSSK_GlobalSensitivityResult *res = d->res;
+  gssk_batch *b = &d->batches[worker];
+  size_t L = b->lanes;
+  size_t p = res->param_count;
+  size_t first = block * L;
+  size_t members = d->runs - first < L ? d->runs - first : L;
+  size_t edge_count = GSSK_GetEdgeCount(d->model);
+  for (size_t e = 0; e < edge_count; e++) {
+    for (size_t m = 0; m < members; m++)
+      b->k[e * L + m] = d->base_k[e];
+  }
+  for (size_t m = 0; m < members; m++) {
+    for (size_t i = 0; i < p; i++)
+      b->k[res->edges[i] * L + m] = d->design[(first + m) * p + i];
+  }
+  gssk_batch_reset(b, members, NULL);
+
+  double dt = GSSK_GetDt(d->model);
+  size_t last = d->steps[d->order[res->time_count - 1]];
+  for (size_t s = 0, next = 0; s <= last; s++) {
+    for (; next < res->time_count && d->steps[d->order[next]] == s; next++) {
+      size_t t = d->order[next];
+      for (size_t o = 0; o < res->output_count; o++) {
+        const double *q = &b->state[res->nodes[o] * L];
+        double *out = &d->outputs[first * d->cells + t * res->output_count + o];
+        for (size_t m = 0; m < members; m++)
+          out[m * d->cells] = b->diverged[m] ? NAN : q[m];
+      }
+    }
+    if (s < last)
+      gssk_batch_step(b, dt);
+  }
+}
+
+typedef struct {
+  GSSK_GlobalSensitivityResult *res;
+  const double *outputs; /**< runs * cells */
+  size_t cells;
+  size_t samples;        /**< Trajectories or base samples */
+  const size_t *moved;   /**< Morris: parameter moved by each step,
+                              samples * param_count */
+  const double *delta;   /**< Morris: its change in the unit design */
+  const size_t *picks;   /**< Bootstrap resamples, bootstrap * samples */
+  size_t bootstrap;
+  double tail;           /**< (1 - confidence) / 2 */
+  double **scratch;      /**< Per worker */
+} GSAAnalysis;
+
+static int gsa_compare(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+// Percentile interval of 'count' replicate values (sorted in place)
+static void gsa_interval(double *v, size_t count, double tail, double *lo,
+                         double *hi) {
+  qsort(v, count, sizeof(double), gsa_compare);
+  double a = tail * (double)(count - 1), b = (1.0 - tail) * (double)(count - 1);
+  size_t ia = (size_t)a, ib = (size_t)b;
+  *lo = ia + 1 < count ? v[ia] + (a - ia) * (v[ia + 1] - v[ia]) : v[ia];
+  *hi = ib + 1 < count ? v[ib] + (b - ib) * (v[ib + 1] - v[ib]) : v[ib];
+}
+
+// Jansen estimators over the base samples 'pick' (all when NULL): with
+// V the variance of f(A) and f(B), S_i = 1 - E[(f(B) - f(AB_i))^2] / 2V
+// and ST_i = E[(f(A) - f(AB_i))^2] / 2V. 'd' and 't' are p scratch.
+static double sobol_indices(const GSAAnalysis *a, size_t cell,
+                            const size_t *pick, double *first, double *total,
+                            double *d, double *t) {
+  size_t p = a->res->param_count;
+  size_t N = a->samples;
+  const double *f = a->outputs;
+  size_t stride = (p + 2) * a->cells;
+  double mean = 0.0, var = 0.0;
+  for (size_t j = 0; j < N; j++) {
+    const double *row = &f[(pick ? pick[j] : j) * stride + cell];
+    mean += row[0] + row[a->cells];
+  }
+  mean /= (double)(2 * N);
+  for (size_t i = 0; i < p; i++)
+    d[i] = t[i] = 0.0;
+  for (size_t j = 0; j < N; j++) {
+    const double *row = &f[(pick ? pick[j] : j) * stride + cell];
+    double fa = row[0], fb = row[a->cells];
+    var += (fa - mean) * (fa - mean) + (fb - mean) * (fb - mean);
+    for (size_t i = 0; i < p; i++) {
+      double fab = row[(2 + i) * a->cells];
+      d[i] += (fb - fab) * (fb - fab);
+      t[i] += (fa - fab) * (fa - fab);
+    }
+  }
+  var /= (double)(2 * N);
+  for (size_t i = 0; i < p; i++) {
+    first[i] = var > 0.0 ? 1.0 - d[i] / (double)(2 * N) / var : 0.0;
+    total[i] = var > 0.0 ? t[i] / (double)(2 * N) / var : 0.0;
+  }
+  return var;
+}
+
+static void sobol_task(void *arg, size_t cell, size_t worker) {
+  GSAAnalysis *a = arg;
+  GSSK_GlobalSensitivityResult *res = a->res;
+  size_t p = res->param_count;
+  size_t B = a->bootstrap;
+  double *d = a->scratch[worker], *t = d + p;
+  double *first = t + p, *total = first + B * p, *v = total + B * p;
+  res->variance[cell] = sobol_indices(a, cell, NULL, &res->first[cell * p],
+                                      &res->total[cell * p], d, t);
+  if (B == 0)
+    return;
+  for (size_t b = 0; b < B; b++)
+    sobol_indices(a, cell, &a->picks[b * a->samples], &first[b * p],
+                  &total[b * p], d, t);
+  for (size_t i = 0; i < p; i++) {
+    for (size_t b = 0; b < B; b++)
+      v[b] = first[b * p + i];
+    gsa_interval(v, B, a->tail, &res->first_lo[cell * p + i],
+                 &res->first_hi[cell * p + i]);
+    for (size_t b = 0; b < B; b++)
+      v[b] = total[b * p + i];
+    gsa_interval(v, B, a->tail, &res->total_lo[cell * p + i],
+                 &res->total_hi[cell * p + i]);
+  }
+}
+
+static void morris_task(void *arg, size_t cell, size_t worker) {
+  GSAAnalysis *a = arg;
+  GSSK_GlobalSensitivityResult *res = a->res;
+  size_t p = res->param_count;
+  size_t r = a->samples;
+  size_t B = a->bootstrap;
+  double *ee = a->scratch[worker], *reps = ee + r * p, *v = reps + B * p;
+
+  // Elementary effects of every trajectory, in parameter order
+  for (size_t j = 0; j < r; j++) {
+    const double *f = &a->outputs[j * (p + 1) * a->cells + cell];
+    for (size_t k = 0; k < p; k++) {
+      size_t i = a->moved[j * p + k];
+      ee[j * p + i] = (f[(k + 1) * a->cells] - f[k * a->cells]) /
+                      a->delta[j * p + k];
+    }
+  }
+  for (size_t i = 0; i < p; i++) {
+    double sum = 0.0, sum_abs = 0.0, ss = 0.0;
+    for (size_t j = 0; j < r; j++) {
+      sum += ee[j * p + i];
+      sum_abs += fabs(ee[j * p + i]);
+    }
+    double mu = sum / (double)r;
+    for (size_t j = 0; j < r; j++)
+      ss += (ee[j * p + i] - mu) * (ee[j * p + i] - mu);
+    res->mu[cell * p + i] = mu;
+    res->mu_star[cell * p + i] = sum_abs / (double)r;
+    res->sigma[cell * p + i] = r > 1 ? sqrt(ss / (double)(r - 1)) : 0.0;
+  }
+  if (B == 0)
+    return;
+  for (size_t b = 0; b < B; b++) {
+    const size_t *pick = &a->picks[b * r];
+    for (size_t i = 0; i < p; i++) {
+      double sum_abs = 0.0;
+      for (size_t j = 0; j < r; j++)
+        sum_abs += fabs(ee[pick[j] * p + i]);
+      reps[b * p + i] = sum_abs / (double)r;
+    }
+  }
+  for (size_t i = 0; i < p; i++) {
+    for (size_t b = 0; b < B; b++)
+      v[b] = reps[b * p + i];
+    gsa_interval(v, B, a->tail, &res->mu_star_lo[cell * p + i],
+                 &res->mu_star_hi[cell * p + i]);
+  }
+}
+
+// Radial one-at-a-time trajectories on a grid of 'levels' stratum centres:
+// each starts at a random grid point and moves every coordinate, in random
+// order, by half the levels (half the unit range) towards the far side
+static void morris_design(gssk_rng *rng, size_t r, size_t p,
+                          unsigned levels, double *u, size_t *moved,
+                          double *delta, size_t *perm) {
+  size_t jump = levels / 2;
+  for (size_t j = 0; j < r; j++) {
+    double *x = &u[j * (p + 1) * p];
+    for (size_t i = 0; i < p; i++) {
+      size_t l = gssk_rng_next(rng) % levels;
+      x[i] = ((double)l + 0.5) / (double)levels;
+      perm[i] = i;
+    }
+    for (size_t i = p; i > 1; i--) {
+      size_t k = gssk_rng_next(rng) % i;
+      size_t tmp = perm[i - 1];
+      perm[i - 1] = perm[k];
+      perm[k] = tmp;
+    }
+    for (size_t k = 0; k < p; k++) {
+      size_t i = perm[k];
+      double *next = &x[(k + 1) * p];
+      memcpy(next, &x[k * p], p * sizeof(double));
+      double step = (double)jump / (double)levels;
+      delta[j * p + k] = next[i] < 0.5 ? step : -step;
+      next[i] += delta[j * p + k];
+      moved[j * p + k] = i;
+    }
+  }
+}
+
+GSSK_Status
+GSSK_GlobalSensitivities(GSSK_Instance *inst,
+                         const GSSK_GlobalSensitivityOptions *opts,
+                         GSSK_GlobalSensitivityResult **out_res) {
+  if (!out_res)
+    return GSSK_ERR_UNKNOWN;
+  *out_res = NULL;
+  if (!inst || !opts || opts->samples < 2 ||
+      (opts->method != GSSK_GSA_MORRIS && opts->method != GSSK_GSA_SOBOL) ||
+      (opts->method == GSSK_GSA_MORRIS &&
+       (opts->levels < 2 || opts->levels % 2 != 0)) ||
+      (opts->bootstrap > 0 &&
+       !(opts->confidence > 0.0 && opts->confidence < 1.0)))
+    return GSSK_ERR_UNKNOWN;
+
+  GSSK_GlobalSensitivityResult *res =
+      calloc(1, sizeof(GSSK_GlobalSensitivityResult));
+  if (!res)
+    return GSSK_ERR_MALLOC_FAILED;
+  res->method = opts->method;
+  size_t p = opts->param_count;
+  GSSK_Status status = gssk_resolve_edges(inst, opts->edges, &p, &res->edges);
+  if (status != GSSK_SUCCESS) {
+    free(res);
+    return status;
+  }
+  res->param_count = p;
+
+  // Output nodes and steps, validated against the model
+  size_t node_count = GSSK_GetStateSize(inst);
+  size_t step_count = gssk_output_steps(inst);
+  double t_start = GSSK_GetTStart(inst), dt = GSSK_GetDt(inst);
+  res->output_count = opts->nodes ? opts->node_count : node_count;
+  res->time_count = opts->times ? opts->time_count : step_count;
+  size_t outputs = res->output_count, times = res->time_count;
+  size_t cells = outputs * times;
+  size_t samples = opts->samples;
+  size_t B = opts->bootstrap;
+  size_t runs = opts->method == GSSK_GSA_SOBOL ? samples * (p + 2)
+                                               : samples * (p + 1);
+  res->nodes = malloc((outputs > 0 ? outputs : 1) * sizeof(size_t));
+  res->times = malloc((times > 0 ? times : 1) * sizeof(double));
+  size_t *steps = malloc((times > 0 ? times : 1) * sizeof(size_t));
+  size_t *order = malloc((times > 0 ? times : 1) * sizeof(size_t));
+  double *base_k = malloc(GSSK_GetEdgeCount(inst) * sizeof(double));
+  double *u = malloc(runs * p * sizeof(double));
+  double *design = malloc(runs * p * sizeof(double));
+  double *sim = malloc(runs * (cells > 0 ? cells : 1) * sizeof(double));
+  size_t *picks = B > 0 ? malloc(B * samples * sizeof(size_t)) : NULL;
+  size_t *moved = NULL, *perm = NULL;
+  double *delta = NULL;
+  size_t workers = 0, batch_count = 0;
+  gssk_batch *batches = NULL;
+  double **scratch = NULL;
+  if (!res->nodes || !res->times || !steps || !order || !base_k || !u ||
+      !design || !sim || (B > 0 && !picks)) {
+    status = GSSK_ERR_MALLOC_FAILED;
+    goto cleanup;
+  }
+  if (outputs == 0 || times == 0) {
+    status = GSSK_ERR_UNKNOWN;
+    goto cleanup;
+  }
+  for (size_t o = 0; o < outputs; o++) {
+    res->nodes[o] = opts->nodes ? opts->nodes[o] : o;
+    if (res->nodes[o] >= node_count) {
+      status = GSSK_ERR_UNKNOWN;
+      goto cleanup;
+    }
+  }
+  for (size_t t = 0; t < times; t++) {
+    double step = opts->times ? floor((opts->times[t] - t_start) / dt + 0.5)
+                              : (double)t;
+    if (!(step >= 0.0 && step < (double)step_count)) {
+      status = GSSK_ERR_UNKNOWN;
+      goto cleanup;
+    }
+    steps[t] = (size_t)step;
+    res->times[t] = t_start + step * dt;
+    size_t k = t;
+    for (; k > 0 && steps[order[k - 1]] > steps[t]; k--)
+      order[k] = order[k - 1];
+    order[k] = t;
+  }
+  for (size_t e = 0; e < GSSK_GetEdgeCount(inst); e++)
+    base_k[e] = GSSK_GetEdgeK(inst, e);
+
+  uint64_t seed = gssk_resolve_seed(opts->seed);
+  gssk_rng rng;
+  gssk_rng_seed(&rng, seed);
+
+  // Unit design: Saltelli's A, B and A-with-column-i-from-B blocks from
+  // one scrambled Sobol sequence of dimension 2p, or Morris trajectories
+  if (opts->method == GSSK_GSA_SOBOL) {
+    double *ab = malloc(2 * p * sizeof(double));
+    gssk_sampler sampler;
+    status = ab ? gssk_sampler_init(&sampler, GSSK_SAMPLING_SOBOL, 2 * p,
+                                    samples, seed, NULL)
+                : GSSK_ERR_MALLOC_FAILED;
+    if (status != GSSK_SUCCESS) {
+      free(ab);
+      goto cleanup;
+    }
+    for (size_t j = 0; j < samples; j++) {
+      gssk_sampler_next(&sampler, ab);
+      double *row = &u[j * (p + 2) * p];
+      memcpy(row, ab, p * sizeof(double));
+      memcpy(&row[p], &ab[p], p * sizeof(double));
+      for (size_t i = 0; i < p; i++) {
+        memcpy(&row[(2 + i) * p], ab, p * sizeof(double));
+        row[(2 + i) * p + i] = ab[p + i];
+      }
+    }
+    gssk_sampler_free(&sampler);
+    free(ab);
+  } else {
+    moved = malloc(samples * p * sizeof(size_t));
+    delta = malloc(samples * p * sizeof(double));
+    perm = malloc(p * sizeof(size_t));
+    if (!moved || !delta || !perm) {
+      status = GSSK_ERR_MALLOC_FAILED;
+      goto cleanup;
+    }
+    morris_design(&rng, samples, p, opts->levels, u, moved, delta, perm);
+  }
+  for (size_t run = 0; run < runs; run++) {
+    for (size_t i = 0; i < p; i++)
+      design[run * p + i] =
+          base_k[res->edges[i]] *
+          gssk_perturbation_factor(opts->distribution, opts->perturbation,
+                                   u[run * p + i]);
+  }
+  for (size_t b = 0; b < B * samples; b++)
+    picks[b] = gssk_rng_next(&rng) % samples;
+
+  // Simulate the design in lockstep blocks
+  size_t blocks = (runs + GSA_LANES - 1) / GSA_LANES;
+  workers = gssk_worker_count(opts->threads, blocks);
+  batches = calloc(workers, sizeof(gssk_batch));
+  if (!batches) {
+    status = GSSK_ERR_MALLOC_FAILED;
+    goto cleanup;
+  }
+  for (; batch_count < workers; batch_count++) {
+    status = gssk_batch_init(&batches[batch_count], inst, GSA_LANES, NULL);
+    if (status != GSSK_SUCCESS)
+      goto cleanup;
+  }
+  GSADesign sim_design = {inst, res,   base_k, design, steps,
+                          order, runs, cells,  sim,    batches};
+  gssk_parallel_for(blocks, workers, gsa_design_task, &sim_design);
+  res->evaluations = runs;
+  for (size_t i = 0; i < runs * cells; i++) {
+    if (!isfinite(sim[i])) {
+      status = GSSK_ERR_DIVERGENCE;
+      goto cleanup;
+    }
+  }
+
+  // Indices per output cell, in parallel
+  size_t idx = cells * p;
+  size_t scratch_size;
+  if (opts->method == GSSK_GSA_SOBOL) {
+    res->first = malloc(idx * sizeof(double));
+    res->total = malloc(idx * sizeof(double));
+    res->variance = malloc(cells * sizeof(double));
+    if (B > 0) {
+      res->first_lo = malloc(idx * sizeof(double));
+      res->first_hi = malloc(idx * sizeof(double));
+      res->total_lo = malloc(idx * sizeof(double));
+      res->total_hi = malloc(idx * sizeof(double));
+    }
+    scratch_size = 2 * p + 2 * B * p + B;
+    if (!res->first || !res->total || !res->variance ||
+        (B > 0 && (!res->first_lo || !res->first_hi || !res->total_lo ||
+                   !res->total_hi))) {
+      status = GSSK_ERR_MALLOC_FAILED;
+      goto cleanup;
+    }
+  } else {
+    res->mu_star = malloc(idx * sizeof(double));
+    res->mu = malloc(idx * sizeof(double));
+    res->sigma = malloc(idx * sizeof(double));
+    if (B > 0) {
+      res->mu_star_lo = malloc(idx * sizeof(double));
+      res->mu_star_hi = malloc(idx * sizeof(double));
+    }
+    scratch_size = samples * p + B * p + B;
+    if (!res->mu_star || !res->mu || !res->sigma ||
+        (B > 0 && (!res->mu_star_lo || !res->mu_star_hi))) {
+      status = GSSK_ERR_MALLOC_FAILED;
+      goto cleanup;
+    }
+  }
+  res->peak = calloc(p, sizeof(double));
+  workers = gssk_worker_count(opts->threads, cells);
+  scratch = calloc(workers, sizeof(double *));
+  if (!res->peak || !scratch) {
+    status = GSSK_ERR_MALLOC_FAILED;
+    goto cleanup;
+  }
+  for (size_t w = 0; w < workers; w++) {
+    scratch[w] = malloc(scratch_size * sizeof(double));
+    if (!scratch[w]) {
+      status = GSSK_ERR_MALLOC_FAILED;
+      goto cleanup;
+    }
+  }
+  GSAAnalysis analysis = {res,    sim, cells, samples,
+                          moved,  delta, picks, B,
+                          0.5 * (1.0 - opts->confidence), scratch};
+  gssk_parallel_for(cells, workers,
+                    opts->method == GSSK_GSA_SOBOL ? sobol_task : morris_task,
+                    &analysis);
+  const double *rank = opts->method == GSSK_GSA_SOBOL ? res->total
+                                                      : res->mu_star;
+  for (size_t c = 0; c < cells; c++) {
+    for (size_t i = 0; i < p; i++) {
+      if (rank[c * p + i] > res->peak[i])
+        res->peak[i] = rank[c * p + i];
+    }
+  }
+
+cleanup:
+  for (size_t w = 0; w < batch_count; w++)
+    gssk_batch_free(&batches[w]);
+  if (scratch) {
+    for (size_t w = 0; w < workers; w++)
+      free(scratch[w]);
+  }
+  free(scratch);
+  free(batches);
+  free(steps);
+  free(order);
+  free(base_k);
+  free(u);
+  free(design);
+  free(sim);
+  free(picks);
+  free(moved);
+  free(delta);
+  free(perm);
+  if (status != GSSK_SUCCESS) {
+    GSSK_FreeGlobalSensitivityResult(res);
+    return status;
+  }
+  *out_res = res;
+  return GSSK_SUCCESS;
+}
@@ -0,0 +1,891 @@
+#include "gssk.h"
+#include "gssk_internal.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --- Shared Helpers ---
+
+// Resolve the perturbed edge subset: NULL selects every edge in order.
+GSSK_Status gssk_resolve_edges(GSSK_Instance *inst, const size_t *edges,
+                               size_t *count, size_t **out_edges) {
+  size_t edge_count = GSSK_GetEdgeCount(inst);
+  size_t n = edges ? *count : edge_count;
+  *out_edges = NULL;
+  if (n == 0)
+    return GSSK_ERR_UNKNOWN;
+  for (size_t i = 0; edges && i < n; i++) {
+    if (edges[i] >= edge_count)
+      return GSSK_ERR_UNKNOWN;
+  }
+  size_t *out = malloc(n * sizeof(size_t));
+  if (!out)
+    return GSSK_ERR_MALLOC_FAILED;
+  for (size_t i = 0; i < n; i++)
+    out[i] = edges ? edges[i] : i;
+  *count = n;
+  *out_edges = out;
+  return GSSK_SUCCESS;
+}
+
+// In-place Cholesky factorization of a symmetric positive definite matrix
+// (lower triangle). Returns 0 if the matrix is not positive definite.
+int gssk_cholesky(double *a, size_t n) {
+  for (size_t j = 0; j < n; j++) {
+    double d = a[j * n + j];
+    for (size_t k = 0; k < j; k++)
+      d -= a[j * n + k] * a[j * n + k];
+    if (d <= 0.0)
+      return 0;
+    d = sqrt(d);
+    a[j * n + j] = d;
+    for (size_t i = j + 1; i < n; i++) {
+      double v = a[i * n + j];
+      for (size_t k = 0; k < j; k++)
+        v -= a[i * n + k] * a[j * n + k];
+      a[i * n + j] = v / d;
+    }
+  }
+  return 1;
+}
+
+// Solve L L^T x = b in place given the factor from gssk_cholesky()
+void gssk_cholesky_solve(const double *l, size_t n, double *b) {
+  for (size_t i = 0; i < n; i++) {
+    double v = b[i];
+    for (size_t k = 0; k < i; k++)
+      v -= l[i * n + k] * b[k];
+    b[i] = v / l[i * n + i];
+  }
+  for (size_t i = n; i-- > 0;) {
+    double v = b[i];
+    for (size_t k = i + 1; k < n; k++)
+      v -= l[k * n + i] * b[k];
+    b[i] = v / l[i * n + i];
+  }
+}
+
+void gssk_symmetric_eigen(double *a, size_t n, double *values,
+                          double *vectors) {
+  for (size_t i = 0; i < n * n; i++)
+    vectors[i] = 0.0;
+  for (size_t i = 0; i < n; i++)
+    vectors[i * n + i] = 1.0;
+
+  for (int sweep = 0; sweep < 64; sweep++) {
+    double off = 0.0, diag = 0.0;
+    for (size_t p = 0; p < n; p++) {
+      diag += a[p * n + p] * a[p * n + p];
+      for (size_t q = p + 1; q < n; q++)
+        off += a[p * n + q] * a[p * n + q];
+    }
+    if (off <= 1e-30 * diag || off == 0.0)
+      break;
+
+    for (size_t p = 0; p < n; p++) {
+      for (size_t q = p + 1; q < n; q++) {
+        double apq = a[p * n + q];
+        if (apq == 0.0)
+          continue;
+        // Rotation that zeroes a[p][q], taking the smaller angle
+        double theta = (a[q * n + q] - a[p * n + p]) / (2.0 * apq);
+        double t = 1.0 / (fabs(theta) + sqrt(theta * theta + 1.0));
+        if (theta < 0.0)
+          t = -t;
+        double c = 1.0 / sqrt(t * t + 1.0);
+        double s = t * c;
+        for (size_t k = 0; k < n; k++) {
+          double akp = a[k * n + p], akq = a[k * n + q];
+          a[k * n + p] = c * akp - s * akq;
+          a[k * n + q] = s * akp + c * akq;
+        }
+        for (size_t k = 0; k < n; k++) {
+          double apk = a[p * n + k], aqk = a[q * n + k];
+          a[p * n + k] = c * apk - s * aqk;
+          a[q * n + k] = s * apk + c * aqk;
+        }
+        for (size_t k = 0; k < n; k++) {
+          double vkp = vectors[k * n + p], vkq = vectors[k * n + q];
+          vectors[k * n + p] = c * vkp - s * vkq;
+          vectors[k * n + q] = s * vkp + c * vkq;
+        }
+      }
+    }
+  }
+  for (size_t i = 0; i < n; i++)
+    values[i] = a[i * n + i];
+}
+
+// --- Polynomial Chaos Expansion ---
+
+void GSSK_InitPCEOptions(GSSK_PCEOptions *opts) {
+  if (!opts)
+    return;
+  opts->edges = NULL;
+  opts->param_count = 0;
+  opts->distribution = GSSK_DIST_UNIFORM;
+  opts->perturbation = 0.1;
+  opts->order = 3;
+  opts->q_norm = 1.0;
+  opts->samples = 0;
+  opts->seed = 1;
+  opts->threads = 0;
+}
+
+void GSSK_FreePCEResult(GSSK_PCEResult *pce) {
+  if (pce) {
+    free(pce->edges);
+    free(pce->nominal_k);
+    free(pce->multi_indices);
+    free(pce->coefficients);
+    free(pce->mean);
+    free(pce->variance);
+    free(pce->sobol_first);
+    free(pce->sobol_total);
+    free(pce);
+  }
+}
+
+// Germ variable for a unit-interval draw: Legendre germs live on [-1, 1],
+// Hermite germs are standard normal.
+static double pce_germ(GSSK_Distribution dist, double u) {
+  if (dist == GSSK_DIST_UNIFORM)
+    return 2.0 * u - 1.0;
+  return gssk_inv_normal_cdf(u);
+}
+
+static double pce_factor(GSSK_Distribution dist, double spread, double xi) {
+  if (dist == GSSK_DIST_LOGNORMAL)
+    return exp(spread * xi - 0.5 * spread * spread);
+  return 1.0 + spread * xi;
+}
+
+static double pce_germ_from_factor(GSSK_Distribution dist, double spread,
+                                   double f) {
+  if (spread <= 0.0)
+    return 0.0;
+  if (dist == GSSK_DIST_LOGNORMAL)
+    return f > 0.0 ? (log(f) + 0.5 * spread * spread) / spread : -INFINITY;
+  return (f - 1.0) / spread;
+}
+
+// Orthonormal univariate polynomials psi_0..psi_order at xi
+static void pce_univariate(GSSK_Distribution dist, unsigned order, double xi,
+                           double *psi) {
+  psi[0] = 1.0;
+  if (order == 0)
+    return;
+  psi[1] = xi;
+  if (dist == GSSK_DIST_UNIFORM) {
+    // Legendre recurrence, normalized by sqrt(2n + 1)
+    for (unsigned n = 1; n < order; n++)
+      psi[n + 1] = ((2.0 * n + 1.0) * xi * psi[n] - n * psi[n - 1]) / (n + 1.0);
+    for (unsigned n = 1; n <= order; n++)
+      psi[n] *= sqrt(2.0 * n + 1.0);
+  } else {
+    // Probabilists' Hermite recurrence, normalized by sqrt(n!)
+    for (unsigned n = 1; n < order; n++)
+      psi[n + 1] = xi * psi[n] - n * psi[n - 1];
+    double fact = 1.0;
+    for (unsigned n = 1; n <= order; n++) {
+      fact *= n;
+      psi[n] /= sqrt(fact);
+    }
+  }
+}
+
+// Multivariate basis values for one germ vector
+static void pce_basis(const GSSK_PCEResult *pce, const double *xi,
+                      double *psi_tab, double *out) {
+  size_t p = pce->param_count;
+  unsigned order = pce->order;
+  for (size_t i = 0; i < p; i++)
+    pce_univariate(pce->distribution, order, xi[i], &psi_tab[i * (order + 1)]);
+  for (size_t t = 0; t < pce->term_count; t++) {
+    double v = 1.0;
+    for (size_t i = 0; i < p; i++)
+      v *= psi_tab[i * (order + 1) + pce->multi_indices[t * p + i]];
+    out[t] = v;
+  }
+}
+
+// Append every multi-index of total degree 'remaining' over dims [i, p)
+static size_t pce_enumerate(unsigned *alpha, size_t i, size_t p,
+                            unsigned remaining, double q, unsigned order,
+                            unsigned *out, size_t count, size_t capacity) {
+  if (i == p - 1) {
+    alpha[i] = remaining;
+    // Hyperbolic truncation keeps low-interaction terms
+    double norm = 0.0;
+    for (size_t j = 0; j < p; j++)
+      if (alpha[j] > 0)
+        norm += pow((double)alpha[j], q);
+    if (pow(norm, 1.0 / q) <= order + 1e-9) {
+      if (out && count < capacity)
+        memcpy(&out[count * p], alpha, p * sizeof(unsigned));
+      count++;
+    }
+    return count;
+  }
+  for (unsigned a = remaining + 1; a-- > 0;) {
+    alpha[i] = a;
+    count = pce_enumerate(alpha, i + 1, p, remaining - a, q, order, out, count,
+                          capacity);
+  }
+  return count;
+}
+
+typedef struct {
+  GSSK_Instance **workers;
+  const GSSK_PCEResult *pce;
+  const double *germs; /**< samples * param_count */
+  double *outputs;     /**< samples * cells */
+  size_t cells;
+} PCECollocation;
+
+static void pce_collocation_task(void *arg, size_t s, size_t worker) {
+  PCECollocation *c = arg;
+  const GSSK_PCEResult *pce = c->pce;
+  GSSK_Instance *inst = c->workers[worker];
+  for (size_t i = 0; i < pce->param_count; i++) {
+    double f = pce_factor(pce->distribution, pce->perturbation,
+                          c->germs[s * pce->param_count + i]);
+    GSSK_SetEdgeK(inst, pce->edges[i], pce->nominal_k[i] * f);
+  }
+  // Divergence leaves non-finite values in the trajectory, checked later
+  gssk_simulate_trajectory(inst, pce->step_count, &c->outputs[s * c->cells]);
+}
+
+GSSK_Status GSSK_PCEBuild(GSSK_Instance *inst, const GSSK_PCEOptions *opts,
+                          GSSK_PCEResult **out_pce) {
+  if (!out_pce)
+    return GSSK_ERR_UNKNOWN;
+  *out_pce = NULL;
+  if (!inst || !opts || opts->q_norm <= 0.0 || opts->q_norm > 1.0)
+    return GSSK_ERR_UNKNOWN;
+
+  GSSK_PCEResult *pce = calloc(1, sizeof(GSSK_PCEResult));
+  if (!pce)
+    return GSSK_ERR_MALLOC_FAILED;
+
+  size_t p = opts->param_count;
+  GSSK_Status status = gssk_resolve_edges(inst, opts->edges, &p, &pce->edges);
+  if (status != GSSK_SUCCESS) {
+    GSSK_FreePCEResult(pce);
+    return status;
+  }
+  pce->param_count = p;
+  pce->order = opts->order;
+  pce->distribution = opts->distribution;
+  pce->perturbation = opts->perturbation;
+  pce->node_count = GSSK_GetStateSize(inst);
+  pce->step_count = gssk_output_steps(inst);
+  size_t cells = pce->node_count * pce->step_count;
+
+  pce->nominal_k = malloc(p * sizeof(double));
+  unsigned *alpha = calloc(p, sizeof(unsigned));
+  if (!pce->nominal_k || !alpha) {
+    free(alpha);
+    GSSK_FreePCEResult(pce);
+    return GSSK_ERR_MALLOC_FAILED;
+  }
+  for (size_t i = 0; i < p; i++)
+    pce->nominal_k[i] = GSSK_GetEdgeK(inst, pce->edges[i]);
+
+  // Graded basis: count first, then fill
+  size_t terms = 0;
+  for (unsigned d = 0; d <= opts->order; d++)
+    terms = pce_enumerate(alpha, 0, p, d, opts->q_norm, opts->order, NULL,
+                          terms, 0);
+  pce->multi_indices = malloc(terms * p * sizeof(unsigned));
+  if (!pce->multi_indices) {
+    free(alpha);
+    GSSK_FreePCEResult(pce);
+    return GSSK_ERR_MALLOC_FAILED;
+  }
+  size_t filled = 0;
+  for (unsigned d = 0; d <= opts->order; d++)
+    filled = pce_enumerate(alpha, 0, p, d, opts->q_norm, opts->order,
+                           pce->multi_indices, filled, terms);
+  free(alpha);
+  pce->term_count = terms;
+
+  // Least-squares regression needs more collocation runs than terms
+  size_t samples = opts->samples > 0 ? opts->samples : 2 * terms;
+  if (samples < terms) {
+    GSSK_FreePCEResult(pce);
+    return GSSK_ERR_UNKNOWN;
+  }
+
+  double *germs = malloc(samples * p * sizeof(double));
+  double *outputs = malloc(samples * cells * sizeof(double));
+  double *design = malloc(samples * terms * sizeof(double));
+  double *gram = calloc(terms * terms, sizeof(double));
+  double *rhs = malloc(terms * sizeof(double));
+  double *psi_tab = malloc(p * (opts->order + 1) * sizeof(double));
+  double *u = malloc(p * sizeof(double));
+  pce->coefficients = malloc(cells * terms * sizeof(double));
+  pce->mean = malloc(cells * sizeof(double));
+  pce->variance = malloc(cells * sizeof(double));
+  pce->sobol_first = calloc(cells * p, sizeof(double));
+  pce->sobol_total = calloc(cells * p, sizeof(double));
+
+  if (!germs || !outputs || !design || !gram || !rhs || !psi_tab || !u ||
+      !pce->coefficients || !pce->mean || !pce->variance ||
+      !pce->sobol_first || !pce->sobol_total) {
+    status = GSSK_ERR_MALLOC_FAILED;
+    goto cleanup;
+  }
+
+  // Collocation points from a scrambled Sobol design in the germ space
+  gssk_sampler sampler;
+  status = gssk_sampler_init(&sampler, GSSK_SAMPLING_SOBOL, p, samples,
+                             opts->seed ? opts->seed : 1, NULL);
+  if (status != GSSK_SUCCESS)
+    goto cleanup;
+  for (size_t s = 0; s < samples; s++) {
+    gssk_sampler_next(&sampler, u);
+    for (size_t i = 0; i < p; i++)
+      germs[s * p + i] = pce_germ(opts->distribution, u[i]);
+    pce_basis(pce, &germs[s * p], psi_tab, &design[s * terms]);
+  }
+  gssk_sampler_free(&sampler);
+
+  // Run the collocation simulations on private clones
+  size_t workers = gssk_worker_count(opts->threads, samples);
+  PCECollocation colloc = {NULL, pce, germs, outputs, cells};
+  colloc.workers = gssk_clone_workers(inst, workers);
+  if (!colloc.workers) {
+    status = GSSK_ERR_MALLOC_FAILED;
+    goto cleanup;
+  }
+  gssk_parallel_for(samples, workers, pce_collocation_task, &colloc);
+  gssk_free_workers(colloc.workers, workers);
+  for (size_t i = 0; i < samples * cells; i++) {
+    if (!isfinite(outputs[i])) {
+      status = GSSK_ERR_DIVERGENCE;
+      goto cleanup;
+    }
+  }
+
+  // Normal equations (Psi^T Psi) c = Psi^T y, shared by every output cell
+  for (size_t s = 0; s < samples; s++) {
+    const double *row = &design[s * terms];
+    for (size_t a = 0; a < terms; a++)
+      for (size_t b = 0; b <= a; b++)
+        gram[a * terms + b] += row[a] * row[b];
+  }
+  for (size_t a = 0; a < terms; a++)
+    for (size_t b = 0; b < a; b++)
+      gram[b * terms + a] = gram[a * terms + b];
+  if (!gssk_cholesky(gram, terms)) {
+    status = GSSK_ERR_UNKNOWN;
+    goto cleanup;
+  }
+
+  for (size_t cell = 0; cell < cells; cell++) {
+    for (size_t t = 0; t < terms; t++)
+      rhs[t] = 0.0;
+    for (size_t s = 0; s < samples; s++) {
+      double y = outputs[s * cells + cell];
+      const double *row = &design[s * terms];
+      for (size_t t = 0; t < terms; t++)
+        rhs[t] += row[t] * y;
+    }
+    gssk_cholesky_solve(gram, terms, rhs);
+    double *c = &pce->coefficients[cell * terms];
+    memcpy(c, rhs, terms * sizeof(double));
+
+    // Orthonormal basis: moments and Sobol indices follow from coefficients
+    double var = 0.0;
+    for (size_t t = 1; t < terms; t++)
+      var += c[t] * c[t];
+    pce->mean[cell] = c[0];
+    pce->variance[cell] = var;
+    if (var <= 0.0)
+      continue;
+    for (size_t t = 1; t < terms; t++) {
+      const unsigned *a = &pce->multi_indices[t * p];
+      size_t active = 0, last = 0;
+      for (size_t i = 0; i < p; i++) {
+        if (a[i] > 0) {
+          active++;
+          last = i;
+          pce->sobol_total[cell * p + i] += c[t] * c[t] / var;
+        }
+      }
+      if (active == 1)
+        pce->sobol_first[cell * p + last] += c[t] * c[t] / var;
+    }
+  }
+
+cleanup:
+  free(germs);
+  free(outputs);
+  free(design);
+  free(gram);
+  free(rhs);
+  free(psi_tab);
+  free(u);
+  if (status != GSSK_SUCCESS) {
+    GSSK_FreePCEResult(pce);
+    return status;
+  }
+  *out_pce = pce;
+  return GSSK_SUCCESS;
+}
+
+GSSK_Status GSSK_PCEEvaluate(const GSSK_PCEResult *pce, const double *k_values,
+                             double *out) {
+  if (!pce || !k_values || !out)
+    return GSSK_ERR_UNKNOWN;
+
+  size_t p = pce->param_count;
+  size_t terms = pce->term_count;
+  double *xi = malloc(p * sizeof(double));
+  double *psi_tab = malloc(p * (pce->order + 1) * sizeof(double));
+  double *basis = malloc(terms * sizeof(double));
+  if (!xi || !psi_tab || !basis) {
+    free(xi);
+    free(psi_tab);
+    free(basis);
+    return GSSK_ERR_MALLOC_FAILED;
+  }
+
+  for (size_t i = 0; i < p; i++) {
+    double f = pce->nominal_k[i] != 0.0 ? k_values[i] / pce->nominal_k[i] : 1.0;
+    xi[i] = pce_germ_from_factor(pce->distribution, pce->perturbation, f);
+  }
+  pce_basis(pce, xi, psi_tab, basis);
+
+  size_t cells = pce->node_count * pce->step_count;
+  for (size_t cell = 0; cell < cells; cell++) {
+    const double *c = &pce->coefficients[cell * terms];
+    double v = 0.0;
+    for (size_t t = 0; t < terms; t++)
+      v += c[t] * basis[t];
+    out[cell] = v;
+  }
+
+  free(xi);
+  free(psi_tab);
+  free(basis);
+  return GSSK_SUCCESS;
+}
+
+// --- Unscented Transform ---
+
+void GSSK_InitUnscentedOptions(GSSK_UnscentedOptions *opts) {
+  if (!opts)
+    return;
+  opts->edges = NULL;
+  opts->param_count = 0;
+  opts->distribution = GSSK_DIST_UNIFORM;
+  opts->perturbation = 0.1;
+  opts->alpha = 1.0;
+  opts->beta = 0.0;
+  opts->kappa = 0.0;
+  opts->sigma_scale = 1.0;
+  opts->covariance = false;
+  opts->threads = 0;
+}
+
+// Factor for a unit-variance germ value, matching the ensemble distributions
+static double unscented_factor(GSSK_Distribution dist, double spread,
+                               double xi) {
+  switch (dist) {
+  case GSSK_DIST_NORMAL:
+    return 1.0 + spread * xi;
+  case GSSK_DIST_LOGNORMAL:
+    return exp(spread * xi - 0.5 * spread * spread);
+  case GSSK_DIST_UNIFORM:
+  default:
+    // U[1 - p, 1 + p] has standard deviation p / sqrt(3)
+    return 1.0 + spread * xi / sqrt(3.0);
+  }
+}
+
+typedef struct {
+  GSSK_Instance **workers;
+  const size_t *edges;
+  const double *nominal_k;
+  size_t param_count;
+  GSSK_Distribution distribution;
+  double perturbation;
+  double spread;    /**< sqrt(n + lambda) */
+  size_t step_count;
+  size_t cells;
+  double *outputs;  /**< (2n + 1) * cells */
+} UnscentedBatch;
+
+static void unscented_task(void *arg, size_t point, size_t worker) {
+  UnscentedBatch *b = arg;
+  GSSK_Instance *inst = b->workers[worker];
+
+  // Point 0 is the centre, 2i + 1 and 2i + 2 straddle parameter i
+  for (size_t i = 0; i < b->param_count; i++) {
+    double xi = 0.0;
+    if (point > 0 && (point - 1) / 2 == i)
+      xi = (point & 1) ? b->spread : -b->spread;
+    double f = unscented_factor(b->distribution, b->perturbation, xi);
+    GSSK_SetEdgeK(inst, b->edges[i], b->nominal_k[i] * (f > 0.0 ? f : 0.0));
+  }
+  gssk_simulate_trajectory(inst, b->step_count, &b->outputs[point * b->cells]);
+}
+
+GSSK_EnsembleResult *GSSK_UnscentedForecast(GSSK_Instance *inst,
+                                            const GSSK_UnscentedOptions *opts) {
+  if (!inst || !opts || opts->alpha <= 0.0)
+    return NULL;
+
+  size_t n = opts->param_count;
+  size_t *edges = NULL;
+  if (gssk_resolve_edges(inst, opts->edges, &n, &edges) != GSSK_SUCCESS)
+    return NULL;
+
+  // Scaled unscented transform weights
+  double lambda = opts->alpha * opts->alpha * ((double)n + opts->kappa) -
+                  (double)n;
+  if ((double)n + lambda <= 0.0) {
+    free(edges);
+    return NULL;
+  }
+  double wm0 = lambda / ((double)n + lambda);
+  double wc0 = wm0 + (1.0 - opts->alpha * opts->alpha + opts->beta);
+  double wi = 1.0 / (2.0 * ((double)n + lambda));
+
+  size_t node_count = GSSK_GetStateSize(inst);
+  size_t step_count = gssk_output_steps(inst);
+  size_t cells = node_count * step_count;
+  size_t points = 2 * n + 1;
+
+  GSSK_EnsembleResult *res = calloc(1, sizeof(GSSK_EnsembleResult));
+  double *nominal_k = malloc(n * sizeof(double));
+  double *outputs = malloc(points * cells * sizeof(double));
+  if (!res || !nominal_k || !outputs) {
+    free(res);
+    free(edges);
+    free(nominal_k);
+    free(outputs);
+    return NULL;
+  }
+  res->node_count = node_count;
+  res->step_count = step_count;
+  res->runs = points;
+  res->min_envelope = malloc(cells * sizeof(double));
+  res->max_envelope = malloc(cells * sizeof(double));
+  res->mean_envelope = malloc(cells * sizeof(double));
+  res->std_envelope = malloc(cells * sizeof(double));
+  if (opts->covariance)
+    res->covariance = calloc(step_count * node_count * node_count,
+                             sizeof(double));
+
+  bool ok = res->min_envelope && res->max_envelope && res->mean_envelope &&
+            res->std_envelope && (!opts->covariance || res->covariance);
+  for (size_t i = 0; i < n; i++)
+    nominal_k[i] = GSSK_GetEdgeK(inst, edges[i]);
+
+  // Integrate every sigma point in one parallel batch
+  UnscentedBatch batch = {NULL,
+                          edges,
+                          nominal_k,
+                          n,
+                          opts->distribution,
+                          opts->perturbation,
+                          sqrt((double)n + lambda),
+                          step_count,
+                          cells,
+                          outputs};
+  size_t workers = gssk_worker_count(opts->threads, points);
+  if (ok)
+    batch.workers = gssk_clone_workers(inst, workers);
+  ok = ok && batch.workers;
+  if (ok)
+    gssk_parallel_for(points, workers, unscented_task, &batch);
+  gssk_free_workers(batch.workers, workers);
+
+  for (size_t c = 0; ok && c < cells; c++) {
+    double mean = wm0 * outputs[c];
+    for (size_t pt = 1; pt < points; pt++)
+      mean += wi * outputs[pt * cells + c];
+
+    double d0 = outputs[c] - mean;
+    double var = wc0 * d0 * d0;
+    for (size_t pt = 1; pt < points; pt++) {
+      double d = outputs[pt * cells + c] - mean;
+      var += wi * d * d;
+    }
+    double sd = var > 0.0 ? sqrt(var) : 0.0;
+    res->mean_envelope[c] = mean;
+    res->std_envelope[c] = sd;
+    res->min_envelope[c] = mean - opts->sigma_scale * sd;
+    res->max_envelope[c] = mean + opts->sigma_scale * sd;
+  }
+
+  if (ok && opts->covariance) {
+    for (size_t s = 0; s < step_count; s++) {
+      double *cov = &res->covariance[s * node_count * node_count];
+      for (size_t pt = 0; pt < points; pt++) {
+        const double *y = &outputs[pt * cells + s * node_count];
+        double w = pt == 0 ? wc0 : wi;
+        for (size_t a = 0; a < node_count; a++) {
+          double da = y[a] - res->mean_envelope[s * node_count + a];
+          for (size_t b = 0; b < node_count; b++)
+            cov[a * node_count + b] +=
+                w * da * (y[b] - res->mean_envelope[s * node_count + b]);
+        }
+      }
+    }
+  }
+
+  free(edges);
+  free(nominal_k);
+  free(outputs);
+  if (!ok) {
+    GSSK_FreeEnsembleResult(res);
+    return NULL;
+  }
+  return res;
+}
+
+// --- Interval Bounds ---
+
+void GSSK_InitIntervalOptions(GSSK_IntervalOptions *opts) {
+  if (!opts)
+    return;
+  opts->edges = NULL;
+  opts->param_count = 0;
+  opts->perturbation = 0.1;
+  opts->k_lower = NULL;
+  opts->k_upper = NULL;
+}
+
+// Interval product [a_lo, a_hi] * [b_lo, b_hi]
+static void interval_mul(double a_lo, double a_hi, double b_lo, double b_hi,
+                         double *lo, double *hi) {
+  double p[4] = {a_lo * b_lo, a_lo * b_hi, a_hi * b_lo, a_hi * b_hi};
+  *lo = *hi = p[0];
+  for (int i = 1; i < 4; i++) {
+    if (p[i] < *lo)
+      *lo = p[i];
+    if (p[i] > *hi)
+      *hi = p[i];
+  }
+}
+
+// Saturating factor Q / (1 + Q / C) of the limit flow, including the
+// solver's C <= 1e-9 cut-off. Non-decreasing in both Q and C for Q, C >= 0.
+static double limit_factor(double q, double c) {
+  if (c <= 1e-9)
+    return 0.0;
+  return q / (1.0 + q / c);
+}
+
+typedef struct {
+  const double *k_lo; /**< Per-edge coefficient bounds, edge_count */
+  const double *k_hi;
+} IntervalParams;
+
+// Enclose the flow of edge e over the state box [lo, hi] with node 'pin'
+// held at 'pin_value'. Every primitive is k times a factor that is monotone
+// in the node quantities, so the factor range comes from two corner
+// evaluations and the product with the k interval from interval_mul.
+static void flow_bounds(const GSSK_EdgeInternal *e, double k_lo, double k_hi,
+                        const double *lo, const double *hi, int pin,
+                        double pin_value, double *f_lo, double *f_hi) {
+  int o = e->origin_idx;
+  int c = e->control_idx;
+  double q_lo = o == pin ? pin_value : lo[o];
+  double q_hi = o == pin ? pin_value : hi[o];
+  double g_lo = 0.0, g_hi = 0.0;
+
+  switch (e->logic) {
+  case GSSK_LOGIC_CONSTANT:
+    g_lo = g_hi = 1.0;
+    break;
+  case GSSK_LOGIC_LINEAR:
+    g_lo = q_lo;
+    g_hi = q_hi;
+    break;
+  case GSSK_LOGIC_INTERACTION:
+    if (c != -1) {
+      double c_lo = c == pin ? pin_value : lo[c];
+      double c_hi = c == pin ? pin_value : hi[c];
+      interval_mul(q_lo, q_hi, c_lo, c_hi, &g_lo, &g_hi);
+    }
+    break;
+  case GSSK_LOGIC_LIMIT:
+    if (c != -1) {
+      double c_lo = c == pin ? pin_value : lo[c];
+      double c_hi = c == pin ? pin_value : hi[c];
+      g_lo = limit_factor(q_lo, c_lo);
+      g_hi = limit_factor(q_hi, c_hi);
+    }
+    break;
+  case GSSK_LOGIC_THRESHOLD:
+    g_lo = q_lo > e->threshold ? 1.0 : 0.0;
+    g_hi = q_hi > e->threshold ? 1.0 : 0.0;
+    break;
+  }
+  interval_mul(k_lo, k_hi, g_lo, g_hi, f_lo, f_hi);
+}
+
+// Right-hand side of the bounding system. The lower bound of node i moves
+// with the smallest net flow possible on the face of the box where node i
+// sits at its own lower bound (and conversely for the upper bound), which
+// is the Muller/Kamke condition for the pair to enclose every trajectory.
+static void interval_derivatives(GSSK_Instance *inst, const IntervalParams *p,
+                                 const double *lo, const double *hi,
+                                 double *d_lo, double *d_hi) {
+  size_t n = inst->node_count;
+  memset(d_lo, 0, n * sizeof(double));
+  memset(d_hi, 0, n * sizeof(double));
+
+  for (size_t i = 0; i < inst->edge_count; i++) {
+    const GSSK_EdgeInternal *e = &inst->edges[i];
+    int o = e->origin_idx;
+    int t = e->target_idx;
+    if (o == t)
+      continue;
+    double f_lo, f_hi, unused;
+
+    flow_bounds(e, p->k_lo[i], p->k_hi[i], lo, hi, t, lo[t], &f_lo, &unused);
+    d_lo[t] += f_lo;
+    flow_bounds(e, p->k_lo[i], p->k_hi[i], lo, hi, t, hi[t], &unused, &f_hi);
+    d_hi[t] += f_hi;
+    flow_bounds(e, p->k_lo[i], p->k_hi[i], lo, hi, o, lo[o], &unused, &f_hi);
+    d_lo[o] -= f_hi;
+    flow_bounds(e, p->k_lo[i], p->k_hi[i], lo, hi, o, hi[o], &f_lo, &unused);
+    d_hi[o] -= f_lo;
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    if (inst->nodes[i].type == NODE_SOURCE ||
+        inst->nodes[i].type == NODE_CONSTANT) {
+      d_lo[i] = 0.0;
+      d_hi[i] = 0.0;
+    }
+  }
+}
+
+// One step of the bounding system with the instance's integration method.
+// 'scratch' holds 10 * node_count doubles.
+static GSSK_Status interval_step(GSSK_Instance *inst, const IntervalParams *p,
+                                 double *lo, double *hi, double dt,
+                                 double *scratch) {
+  size_t n = inst->node_count;
+  double *k1 = scratch;         // lo/hi derivative pairs, 2n each
+  double *k2 = scratch + 2 * n;
+  double *k3 = scratch + 4 * n;
+  double *k4 = scratch + 6 * n;
+  double *tmp = scratch + 8 * n;
+
+  interval_derivatives(inst, p, lo, hi, k1, k1 + n);
+  if (inst->config.method == GSSK_METHOD_RK4) {
+    for (size_t i = 0; i < n; i++) {
+      tmp[i] = lo[i] + 0.5 * dt * k1[i];
+      tmp[n + i] = hi[i] + 0.5 * dt * k1[n + i];
+    }
+    interval_derivatives(inst, p, tmp, tmp + n, k2, k2 + n);
+    for (size_t i = 0; i < n; i++) {
+      tmp[i] = lo[i] + 0.5 * dt * k2[i];
+      tmp[n + i] = hi[i] + 0.5 * dt * k2[n + i];
+    }
+    interval_derivatives(inst, p, tmp, tmp + n, k3, k3 + n);
+    for (size_t i = 0; i < n; i++) {
+      tmp[i] = lo[i] + dt * k3[i];
+      tmp[n + i] = hi[i] + dt * k3[n + i];
+    }
+    interval_derivatives(inst, p, tmp, tmp + n, k4, k4 + n);
+    for (size_t i = 0; i < 2 * n; i++)
+      k1[i] = (k1[i] + 2.0 * k2[i] + 2.0 * k3[i] + k4[i]) / 6.0;
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    lo[i] += dt * k1[i];
+    hi[i] += dt * k1[n + i];
+    if (!isfinite(lo[i]) || !isfinite(hi[i]))
+      return GSSK_ERR_DIVERGENCE;
+    // Same non-negativity clamp as GSSK_Step (monotone, so it preserves the
+    // enclosure)
+    if (lo[i] < 0.0)
+      lo[i] = 0.0;
+    if (hi[i] < 0.0)
+      hi[i] = 0.0;
+  }
+  return GSSK_SUCCESS;
+}
+
+GSSK_EnsembleResult *GSSK_IntervalForecast(GSSK_Instance *inst,
+                                           const GSSK_IntervalOptions *opts) {
+  if (!inst || !opts || opts->perturbation < 0.0)
+    return NULL;
+
+  size_t n = opts->param_count;
+  size_t *edges = NULL;
+  if (gssk_resolve_edges(inst, opts->edges, &n, &edges) != GSSK_SUCCESS)
+    return NULL;
+
+  size_t node_count = inst->node_count;
+  size_t edge_count = inst->edge_count;
+  size_t step_count = gssk_output_steps(inst);
+  size_t cells = node_count * step_count;
+
+  GSSK_EnsembleResult *res = calloc(1, sizeof(GSSK_EnsembleResult));
+  double *k_lo = malloc(2 * edge_count * sizeof(double));
+  double *scratch = malloc(12 * node_count * sizeof(double));
+  bool ok = res && k_lo && scratch;
+  if (res) {
+    res->node_count = node_count;
+    res->step_count = step_count;
+    res->min_envelope = malloc(cells * sizeof(double));
+    res->max_envelope = malloc(cells * sizeof(double));
+    res->mean_envelope = malloc(cells * sizeof(double));
+    ok = ok && res->min_envelope && res->max_envelope && res->mean_envelope;
+  }
+
+  if (ok) {
+    // Unperturbed edges get a degenerate interval at their nominal k
+    double *k_hi = k_lo + edge_count;
+    for (size_t i = 0; i < edge_count; i++)
+      k_lo[i] = k_hi[i] = inst->edges[i].k;
+    for (size_t i = 0; i < n; i++) {
+      double k = inst->edges[edges[i]].k;
+      double a = opts->k_lower ? opts->k_lower[i]
+                               : k * (1.0 - opts->perturbation);
+      double b = opts->k_upper ? opts->k_upper[i]
+                               : k * (1.0 + opts->perturbation);
+      k_lo[edges[i]] = a < b ? a : b;
+      k_hi[edges[i]] = a < b ? b : a;
+    }
+
+    // Nominal trajectory for reference, then the bounding pair
+    ok = gssk_simulate_trajectory(inst, step_count, res->mean_envelope) ==
+         GSSK_SUCCESS;
+
+    IntervalParams params = {k_lo, k_hi};
+    double *lo = scratch + 10 * node_count;
+    double *hi = lo + node_count;
+    double dt = inst->config.dt;
+    for (size_t i = 0; i < node_count; i++)
+      lo[i] = hi[i] = inst->nodes[i].initial_value;
+    for (size_t s = 0; ok && s < step_count; s++) {
+      memcpy(&res->min_envelope[s * node_count], lo,
+             node_count * sizeof(double));
+      memcpy(&res->max_envelope[s * node_count], hi,
+             node_count * sizeof(double));
+      if (s + 1 < step_count)
+        ok = interval_step(inst, &params, lo, hi, dt, scratch) ==
+             GSSK_SUCCESS;
+    }
+  }
+
+  free(edges);
+  free(k_lo);
+  free(scratch);
+  if (!ok) {
+    GSSK_FreeEnsembleResult(res);
+    return NULL;
+  }
+  return res;
+}
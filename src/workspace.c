@@ -0,0 +1,129 @@
+// Reusable scratch memory for the long-running entry points. A workspace is
+// a chain of blocks handed out by bump allocation; callers take a mark before
+// allocating and release back to it when done, keeping the blocks. Calls that
+// repeat the same allocation sequence therefore reuse the same memory and
+// never reach malloc once the workspace has grown to fit them.
+#include "gssk_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define WORKSPACE_ALIGN 64
+#define WORKSPACE_MAX_BLOCKS 48
+#define WORKSPACE_MIN_BLOCK 4096
+
+typedef struct {
+  unsigned char *data;
+  size_t size;
+} WorkspaceBlock;
+
+struct GSSK_Workspace {
+  WorkspaceBlock blocks[WORKSPACE_MAX_BLOCKS];
+  size_t block_count;
+  gssk_ws_mark top; /**< Next free byte */
+};
+
+static bool workspace_add_block(GSSK_Workspace *ws, size_t index,
+                                size_t size) {
+  // Blocks from WORKSPACE_ALIGN-aligned storage (C99 has no aligned_alloc)
+  unsigned char *raw = malloc(size + WORKSPACE_ALIGN);
+  if (!raw)
+    return false;
+  free(ws->blocks[index].data);
+  ws->blocks[index].data = raw;
+  ws->blocks[index].size = size;
+  if (index >= ws->block_count)
+    ws->block_count = index + 1;
+  return true;
+}
+
+static unsigned char *block_base(const WorkspaceBlock *b) {
+  uintptr_t p = (uintptr_t)b->data;
+  return (unsigned char *)((p + WORKSPACE_ALIGN - 1) &
+                           ~(uintptr_t)(WORKSPACE_ALIGN - 1));
+}
+
+GSSK_Workspace *GSSK_WorkspaceCreate(GSSK_Instance *inst) {
+  GSSK_Workspace *ws = calloc(1, sizeof(GSSK_Workspace));
+  if (!ws)
+    return NULL;
+
+  // First block: an ensemble's per-cell accumulators plus per-node and
+  // per-edge scratch for a few lockstep batches. Larger requests add blocks.
+  size_t size = WORKSPACE_MIN_BLOCK;
+  if (inst) {
+    size_t cells = GSSK_GetStateSize(inst) * gssk_output_steps(inst);
+    size_t per_model = GSSK_GetStateSize(inst) + GSSK_GetEdgeCount(inst);
+    size += (cells * 8 + per_model * 256) * sizeof(double);
+  }
+  if (!workspace_add_block(ws, 0, size)) {
+    free(ws);
+    return NULL;
+  }
+  return ws;
+}
+
+void GSSK_WorkspaceFree(GSSK_Workspace *ws) {
+  if (!ws)
+    return;
+  for (size_t i = 0; i < ws->block_count; i++)
+    free(ws->blocks[i].data);
+  free(ws);
+}
+
+void *gssk_ws_alloc(GSSK_Workspace *ws, size_t bytes) {
+  if (!ws)
+    return malloc(bytes > 0 ? bytes : 1);
+
+  bytes = (bytes + WORKSPACE_ALIGN - 1) & ~(size_t)(WORKSPACE_ALIGN - 1);
+  if (bytes == 0)
+    bytes = WORKSPACE_ALIGN;
+
+  // Take from the current block, else move on to (or create) the next
+  while (ws->top.block < WORKSPACE_MAX_BLOCKS) {
+    size_t b = ws->top.block;
+    if (b >= ws->block_count) {
+      size_t prev = b > 0 ? ws->blocks[b - 1].size : WORKSPACE_MIN_BLOCK;
+      if (!workspace_add_block(ws, b, bytes > 2 * prev ? bytes : 2 * prev))
+        return NULL;
+    } else if (ws->top.offset == 0 && ws->blocks[b].size < bytes) {
+      // An empty block too small for this request: replace it
+      if (!workspace_add_block(ws, b, bytes > 2 * ws->blocks[b].size
+                                          ? bytes
+                                          : 2 * ws->blocks[b].size))
+        return NULL;
+    }
+    if (ws->top.offset + bytes <= ws->blocks[b].size) {
+      void *p = block_base(&ws->blocks[b]) + ws->top.offset;
+      ws->top.offset += bytes;
+      return p;
+    }
+    ws->top.block++;
+    ws->top.offset = 0;
+  }
+  return NULL;
+}
+
+void *gssk_ws_calloc(GSSK_Workspace *ws, size_t count, size_t size) {
+  if (!ws)
+    return calloc(count > 0 ? count : 1, size);
+  void *p = gssk_ws_alloc(ws, count * size);
+  if (p)
+    memset(p, 0, count * size);
+  return p;
+}
+
+void gssk_ws_free(GSSK_Workspace *ws, void *p) {
+  // Workspace memory is reclaimed by gssk_ws_release
+  if (!ws)
+    free(p);
+}
+
+gssk_ws_mark gssk_ws_get_mark(const GSSK_Workspace *ws) {
+  gssk_ws_mark none = {0, 0};
+  return ws ? ws->top : none;
+}
+
+void gssk_ws_release(GSSK_Workspace *ws, gssk_ws_mark mark) {
+  if (ws)
+    ws->top = mark;
+}
@@ -4,6 +4,23 @@
 #include <math.h>
 #include <string.h>
 #include <assert.h>
+#include <time.h>
+
+// Heap allocation counter. The Makefile links the test binary with
+// --wrap=malloc etc. where the linker supports it; elsewhere the count
+// stays at zero and the allocation checks are skipped.
+static size_t alloc_count = 0;
+#ifdef GSSK_TEST_WRAP
+static const int alloc_counted = 1;
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void *__wrap_malloc(size_t size) { alloc_count++; return __real_malloc(size); }
+void *__wrap_calloc(size_t count, size_t size) { alloc_count++; return __real_calloc(count, size); }
+void *__wrap_realloc(void *ptr, size_t size) { alloc_count++; return __real_realloc(ptr, size); }
+#else
+static const int alloc_counted = 0;
+#endif
 
 void test_calibration() {
     printf("Testing Parameter Calibration...\n");
@@ -52,6 +69,1071 @@ void test_calibration() {
     printf("  Calibration test PASSED\n");
 }
 
+void test_calibration_parallel() {
+    printf("Testing Parallel Calibration...\n");
+
+    const char *model_json = "{"
+        "\"nodes\": ["
+        "  {\"id\": \"A\", \"type\": \"source\", \"value\": 10.0},"
+        "  {\"id\": \"B\", \"type\": \"storage\", \"value\": 0.0},"
+        "  {\"id\": \"C\", \"type\": \"sink\", \"value\": 0.0}"
+        "],"
+        "\"edges\": ["
+        "  {\"origin\": \"A\", \"target\": \"B\", \"logic\": \"linear\", \"params\": {\"k\": 0.8}},"
+        "  {\"origin\": \"B\", \"target\": \"C\", \"logic\": \"linear\", \"params\": {\"k\": 0.3}}"
+        "],"
+        "\"config\": {\"t_start\": 0, \"t_end\": 10, \"dt\": 0.1, \"method\": \"rk4\"}"
+        "}";
+
+    GSSK_Instance *inst = NULL;
+    assert(GSSK_Init(model_json, &inst) == GSSK_SUCCESS);
+
+    // Synthetic observations of B from the true k's
+    GSSK_Observation obs_data[10];
+    GSSK_Reset(inst);
+    for (int s = 1; s <= 100; s++) {
+        GSSK_Step(inst, 0.1);
+        if (s % 10 == 5)
+            obs_data[s / 10] = (GSSK_Observation){s * 0.1, GSSK_GetState(inst)[1]};
+    }
+    GSSK_NodeObservations node_obs = {.node_id = "B", .data = obs_data, .count = 10};
+
+    GSSK_CalibrationOptions opts;
+    GSSK_InitCalibrationOptions(&opts);
+    opts.iterations = 60;
+    opts.k_max = 2.0;
+    opts.seed = 32;
+    opts.threads = 1;
+    GSSK_CalibrationReport serial, parallel;
+    assert(GSSK_CalibrateEx(inst, &node_obs, 1, &opts, &serial) == GSSK_SUCCESS);
+    double k0 = GSSK_GetEdgeK(inst, 0), k1 = GSSK_GetEdgeK(inst, 1);
+    assert(serial.evaluations == 20 * 61 && serial.generations == 60);
+    // Late generations reject most trials before the end of the horizon
+    assert(serial.early_aborts > serial.evaluations / 4);
+
+    // Same seed on four threads: identical trajectory through the optimizer
+    opts.threads = 4;
+    assert(GSSK_CalibrateEx(inst, &node_obs, 1, &opts, &parallel) == GSSK_SUCCESS);
+    assert(GSSK_GetEdgeK(inst, 0) == k0 && GSSK_GetEdgeK(inst, 1) == k1);
+    assert(parallel.best_fitness == serial.best_fitness);
+    assert(parallel.early_aborts == serial.early_aborts);
+
+    // The batched evaluator reproduces the scalar integration of the winner
+    double sse = 0.0;
+    GSSK_Reset(inst);
+    for (int s = 1; s <= 100; s++) {
+        GSSK_Step(inst, 0.1);
+        if (s % 10 == 5) {
+            double diff = GSSK_GetState(inst)[1] - obs_data[s / 10].value;
+            sse += diff * diff;
+        }
+    }
+    assert(fabs(sse / 10 - serial.best_fitness) < 1e-12);
+
+    // Observations outside the horizon or on unknown nodes are not scheduled
+    GSSK_Observation late_data[11];
+    memcpy(late_data, obs_data, sizeof(obs_data));
+    late_data[10] = (GSSK_Observation){25.0, 1.0};
+    GSSK_Observation ghost_data[] = {{2.0, 5.0}};
+    GSSK_NodeObservations noisy_obs[] = {
+        {.node_id = "B", .data = late_data, .count = 11},
+        {.node_id = "Ghost", .data = ghost_data, .count = 1}};
+    GSSK_CalibrationReport noisy;
+    assert(GSSK_CalibrateEx(inst, noisy_obs, 2, &opts, &noisy) == GSSK_SUCCESS);
+    assert(noisy.best_fitness == serial.best_fitness);
+    assert(GSSK_GetEdgeK(inst, 0) == k0 && GSSK_GetEdgeK(inst, 1) == k1);
+
+    printf("  k = (%f, %f), MSE %g, %zu of %zu evaluations aborted\n", k0, k1,
+           serial.best_fitness, serial.early_aborts, serial.evaluations);
+    assert(fabs(k0 - 0.8) < 0.05 && fabs(k1 - 0.3) < 0.05);
+
+    GSSK_Free(inst);
+    printf("  Parallel calibration test PASSED\n");
+}
+
+void test_calibration_optimizers() {
+    printf("Testing CMA-ES, SHADE and Bayesian Calibration...\n");
+
+    // B drains to C and D in parallel, so its observations only pin down
+    // the sum of those two k's: a correlated, ill-conditioned landscape
+    const char *model_json = "{"
+        "\"nodes\": ["
+        "  {\"id\": \"A\", \"type\": \"source\", \"value\": 10.0},"
+        "  {\"id\": \"B\", \"type\": \"storage\", \"value\": 0.0},"
+        "  {\"id\": \"C\", \"type\": \"storage\", \"value\": 0.0},"
+        "  {\"id\": \"D\", \"type\": \"sink\", \"value\": 0.0}"
+        "],"
+        "\"edges\": ["
+        "  {\"origin\": \"A\", \"target\": \"B\", \"logic\": \"linear\", \"params\": {\"k\": 0.8}},"
+        "  {\"origin\": \"B\", \"target\": \"C\", \"logic\": \"linear\", \"params\": {\"k\": 0.3}},"
+        "  {\"origin\": \"B\", \"target\": \"D\", \"logic\": \"linear\", \"params\": {\"k\": 0.2}},"
+        "  {\"origin\": \"C\", \"target\": \"D\", \"logic\": \"linear\", \"params\": {\"k\": 0.1}}"
+        "],"
+        "\"config\": {\"t_start\": 0, \"t_end\": 10, \"dt\": 0.1, \"method\": \"rk4\"}"
+        "}";
+
+    GSSK_Instance *inst = NULL;
+    assert(GSSK_Init(model_json, &inst) == GSSK_SUCCESS);
+    GSSK_Observation b_data[10], c_data[10];
+    GSSK_Reset(inst);
+    for (int s = 1; s <= 100; s++) {
+        GSSK_Step(inst, 0.1);
+        if (s % 10 == 5) {
+            b_data[s / 10] = (GSSK_Observation){s * 0.1, GSSK_GetState(inst)[1]};
+            c_data[s / 10] = (GSSK_Observation){s * 0.1, GSSK_GetState(inst)[2]};
+        }
+    }
+    GSSK_NodeObservations node_obs[] = {
+        {.node_id = "B", .data = b_data, .count = 10},
+        {.node_id = "C", .data = c_data, .count = 10}};
+
+    GSSK_CalibrationOptions opts;
+    GSSK_InitCalibrationOptions(&opts);
+    opts.k_max = 2.0;
+    opts.seed = 40;
+    GSSK_CalibrationReport de, cma, parallel;
+    assert(GSSK_CalibrateEx(inst, node_obs, 2, &opts, &de) == GSSK_SUCCESS);
+
+    // CMA-ES beats the DE misfit on about half the simulations
+    opts.optimizer = GSSK_OPTIMIZER_CMAES;
+    opts.iterations = 50;
+    opts.threads = 1;
+    assert(GSSK_CalibrateEx(inst, node_obs, 2, &opts, &cma) == GSSK_SUCCESS);
+    printf("  DE: MSE %g after %zu evaluations, CMA-ES: MSE %g after %zu\n",
+           de.best_fitness, de.evaluations, cma.best_fitness, cma.evaluations);
+    assert(de.evaluations == 20 * 101 && cma.evaluations <= 20 * 51);
+    assert(cma.best_fitness < de.best_fitness);
+    double k[4];
+    for (int e = 0; e < 4; e++)
+        k[e] = GSSK_GetEdgeK(inst, e);
+    assert(fabs(k[0] - 0.8) < 1e-2 && fabs(k[1] - 0.3) < 1e-2);
+    assert(fabs(k[2] - 0.2) < 1e-2 && fabs(k[3] - 0.1) < 1e-2);
+
+    // Each generation is one batch: the thread count changes nothing
+    opts.threads = 4;
+    assert(GSSK_CalibrateEx(inst, node_obs, 2, &opts, &parallel) == GSSK_SUCCESS);
+    assert(parallel.best_fitness == cma.best_fitness);
+    assert(parallel.evaluations == cma.evaluations);
+    for (int e = 0; e < 4; e++)
+        assert(GSSK_GetEdgeK(inst, e) == k[e]);
+
+    // SHADE adapts F and CR instead, and also needs about half the budget
+    GSSK_CalibrationReport shade, shade_parallel;
+    opts.optimizer = GSSK_OPTIMIZER_SHADE;
+    opts.threads = 1;
+    assert(GSSK_CalibrateEx(inst, node_obs, 2, &opts, &shade) == GSSK_SUCCESS);
+    printf("  SHADE: MSE %g after %zu evaluations, %zu aborted\n",
+           shade.best_fitness, shade.evaluations, shade.early_aborts);
+    assert(shade.evaluations <= 20 * 51);
+    assert(shade.best_fitness < de.best_fitness);
+    assert(shade.early_aborts > 0);
+    for (int e = 0; e < 4; e++)
+        k[e] = GSSK_GetEdgeK(inst, e);
+    opts.threads = 4;
+    assert(GSSK_CalibrateEx(inst, node_obs, 2, &opts, &shade_parallel) == GSSK_SUCCESS);
+    assert(shade_parallel.best_fitness == shade.best_fitness);
+    assert(shade_parallel.early_aborts == shade.early_aborts);
+    for (int e = 0; e < 4; e++)
+        assert(GSSK_GetEdgeK(inst, e) == k[e]);
+
+    // On the full budget it closes in on the true k's
+    opts.iterations = 100;
+    assert(GSSK_CalibrateEx(inst, node_obs, 2, &opts, &shade) == GSSK_SUCCESS);
+    assert(shade.evaluations <= 20 * 101 && shade.best_fitness < 1e-6);
+    assert(fabs(GSSK_GetEdgeK(inst, 1) - 0.3) < 1e-4);
+    assert(fabs(GSSK_GetEdgeK(inst, 2) - 0.2) < 1e-4);
+
+    // Bayesian optimization on a budget of 200 simulations, in batches of 8:
+    // well ahead of DE on the same budget, whatever the thread count
+    GSSK_CalibrationReport bayes, bayes_parallel;
+    opts.population = 8;
+    opts.iterations = 24;
+    opts.optimizer = GSSK_OPTIMIZER_DE;
+    assert(GSSK_CalibrateEx(inst, node_obs, 2, &opts, &de) == GSSK_SUCCESS);
+    opts.optimizer = GSSK_OPTIMIZER_BAYES;
+    opts.threads = 1;
+    assert(GSSK_CalibrateEx(inst, node_obs, 2, &opts, &bayes) == GSSK_SUCCESS);
+    printf("  200 simulations: DE MSE %g, Bayesian optimization MSE %g\n",
+           de.best_fitness, bayes.best_fitness);
+    assert(bayes.evaluations <= 8 * 25 && bayes.generations > 0);
+    assert(bayes.best_fitness < 0.5 * de.best_fitness);
+    for (int e = 0; e < 4; e++)
+        k[e] = GSSK_GetEdgeK(inst, e);
+    opts.threads = 4;
+    assert(GSSK_CalibrateEx(inst, node_obs, 2, &opts, &bayes_parallel) == GSSK_SUCCESS);
+    assert(bayes_parallel.best_fitness == bayes.best_fitness);
+    assert(bayes_parallel.evaluations == bayes.evaluations);
+    for (int e = 0; e < 4; e++)
+        assert(GSSK_GetEdgeK(inst, e) == k[e]);
+    GSSK_Free(inst);
+
+    // A single k converges long before the budget is spent; without
+    // restarts the run just ends, with them the budget goes to larger
+    // populations
+    const char *single_json = "{"
+        "\"nodes\": ["
+        "  {\"id\": \"A\", \"type\": \"source\", \"value\": 10.0},"
+        "  {\"id\": \"B\", \"type\": \"storage\", \"value\": 0.0}"
+        "],"
+        "\"edges\": ["
+        "  {\"origin\": \"A\", \"target\": \"B\", \"logic\": \"linear\", \"params\": {\"k\": 0.5}}"
+        "],"
+        "\"config\": {\"t_start\": 0, \"t_end\": 10, \"dt\": 1.0}"
+        "}";
+    assert(GSSK_Init(single_json, &inst) == GSSK_SUCCESS);
+    GSSK_Observation obs_data[] = {{5.0, 40.0}, {10.0, 80.0}};
+    GSSK_NodeObservations single_obs = {.node_id = "B", .data = obs_data, .count = 2};
+    GSSK_InitCalibrationOptions(&opts);
+    opts.optimizer = GSSK_OPTIMIZER_CMAES;
+    opts.seed = 40;
+    opts.restarts = 0;
+    GSSK_CalibrationReport once, restarted;
+    assert(GSSK_CalibrateEx(inst, &single_obs, 1, &opts, &once) == GSSK_SUCCESS);
+    assert(fabs(GSSK_GetEdgeK(inst, 0) - 0.8) < 1e-6);
+    opts.restarts = 9;
+    assert(GSSK_CalibrateEx(inst, &single_obs, 1, &opts, &restarted) == GSSK_SUCCESS);
+    printf("  Single k: %zu evaluations in one run, %zu with restarts\n",
+           once.evaluations, restarted.evaluations);
+    assert(once.evaluations < restarted.evaluations);
+    assert(restarted.evaluations <= 20 * 101);
+    assert(restarted.best_fitness <= once.best_fitness);
+    assert(fabs(GSSK_GetEdgeK(inst, 0) - 0.8) < 1e-6);
+
+    // Unknown optimizers are rejected
+    opts.optimizer = (GSSK_Optimizer)7;
+    assert(GSSK_CalibrateEx(inst, &single_obs, 1, &opts, NULL) == GSSK_ERR_UNKNOWN);
+    GSSK_Free(inst);
+    printf("  CMA-ES, SHADE and Bayesian calibration test PASSED\n");
+}
+
+void test_calibration_screening() {
+    printf("Testing Multi-Fidelity Calibration...\n");
+
+    // A fine-dt RK4 model: screening with Euler at 10 dt is ~40x cheaper
+    const char *model_json = "{"
+        "\"nodes\": ["
+        "  {\"id\": \"A\", \"type\": \"source\", \"value\": 10.0},"
+        "  {\"id\": \"B\", \"type\": \"storage\", \"value\": 0.0},"
+        "  {\"id\": \"C\", \"type\": \"storage\", \"value\": 0.0},"
+        "  {\"id\": \"D\", \"type\": \"sink\", \"value\": 0.0}"
+        "],"
+        "\"edges\": ["
+        "  {\"origin\": \"A\", \"target\": \"B\", \"logic\": \"linear\", \"params\": {\"k\": 0.8}},"
+        "  {\"origin\": \"B\", \"target\": \"C\", \"logic\": \"linear\", \"params\": {\"k\": 0.3}},"
+        "  {\"origin\": \"B\", \"target\": \"D\", \"logic\": \"linear\", \"params\": {\"k\": 0.2}},"
+        "  {\"origin\": \"C\", \"target\": \"D\", \"logic\": \"linear\", \"params\": {\"k\": 0.1}}"
+        "],"
+        "\"config\": {\"t_start\": 0, \"t_end\": 10, \"dt\": 0.01, \"method\": \"rk4\"}"
+        "}";
+
+    GSSK_Instance *inst = NULL;
+    assert(GSSK_Init(model_json, &inst) == GSSK_SUCCESS);
+    GSSK_Observation b_data[10], c_data[10];
+    GSSK_Reset(inst);
+    for (int s = 1; s <= 1000; s++) {
+        GSSK_Step(inst, 0.01);
+        if (s % 100 == 50) {
+            b_data[s / 100] = (GSSK_Observation){s * 0.01, GSSK_GetState(inst)[1]};
+            c_data[s / 100] = (GSSK_Observation){s * 0.01, GSSK_GetState(inst)[2]};
+        }
+    }
+    GSSK_NodeObservations node_obs[] = {
+        {.node_id = "B", .data = b_data, .count = 10},
+        {.node_id = "C", .data = c_data, .count = 10}};
+
+    GSSK_CalibrationOptions opts;
+    GSSK_InitCalibrationOptions(&opts);
+    opts.k_max = 2.0;
+    opts.seed = 42;
+    opts.iterations = 150;
+    GSSK_CalibrationReport full, screened;
+    assert(GSSK_CalibrateEx(inst, node_obs, 2, &opts, &full) == GSSK_SUCCESS);
+    assert(full.screened == 0 && full.screen_dropped == 0);
+
+    // Most trials are rejected on the screen alone, until the population
+    // is too close to the optimum for the coarse model to rank it
+    opts.screen_factor = 5;
+    assert(GSSK_CalibrateEx(inst, node_obs, 2, &opts, &screened) == GSSK_SUCCESS);
+    printf("  Full: MSE %g after %zu evaluations; screened: MSE %g after %zu "
+           "(+%zu screens, dropped in generation %zu)\n", full.best_fitness,
+           full.evaluations, screened.best_fitness, screened.evaluations,
+           screened.screened, screened.screen_dropped);
+    assert(screened.generations == 150 && screened.screened > 0);
+    assert(screened.screen_dropped > 1 && screened.screen_dropped < 150);
+    assert(screened.evaluations * 2 < full.evaluations);
+    assert(screened.best_fitness < full.best_fitness);
+    assert(fabs(GSSK_GetEdgeK(inst, 0) - 0.8) < 0.01);
+
+    // Same outcome on any number of threads
+    GSSK_CalibrationReport parallel;
+    double k1 = GSSK_GetEdgeK(inst, 1);
+    opts.threads = 4;
+    assert(GSSK_CalibrateEx(inst, node_obs, 2, &opts, &parallel) == GSSK_SUCCESS);
+    assert(parallel.best_fitness == screened.best_fitness);
+    assert(parallel.evaluations == screened.evaluations);
+    assert(GSSK_GetEdgeK(inst, 1) == k1);
+
+    // Demanding perfect rank agreement drops screening after the first
+    // generation; the rest run at full fidelity
+    opts.screen_correlation = 1.5;
+    assert(GSSK_CalibrateEx(inst, node_obs, 2, &opts, &screened) == GSSK_SUCCESS);
+    assert(screened.screen_dropped == 1 && screened.screened == 40);
+    assert(screened.evaluations > 20 * 150);
+
+    // SHADE charges the screens against its budget
+    opts.screen_correlation = 0.3;
+    opts.optimizer = GSSK_OPTIMIZER_SHADE;
+    assert(GSSK_CalibrateEx(inst, node_obs, 2, &opts, &screened) == GSSK_SUCCESS);
+    printf("  SHADE screened: MSE %g after %zu evaluations (+%zu screens)\n",
+           screened.best_fitness, screened.evaluations, screened.screened);
+    assert(screened.evaluations < 20 * 151 && screened.screened > 0);
+
+    opts.screen_horizon = 0.0;
+    assert(GSSK_CalibrateEx(inst, node_obs, 2, &opts, NULL) == GSSK_ERR_UNKNOWN);
+    GSSK_Free(inst);
+    printf("  Multi-fidelity calibration test PASSED\n");
+}
+
+void test_calibration_cache() {
+    printf("Testing Calibration Fitness Memo...\n");
+
+    // The best fit puts k(B->C) on its lower bound, where clipped trials
+    // keep repeating vectors already scored
+    const char *model_json = "{"
+        "\"nodes\": ["
+        "  {\"id\": \"A\", \"type\": \"source\", \"value\": 10.0},"
+        "  {\"id\": \"B\", \"type\": \"storage\", \"value\": 0.0},"
+        "  {\"id\": \"C\", \"type\": \"sink\", \"value\": 0.0}"
+        "],"
+        "\"edges\": ["
+        "  {\"origin\": \"A\", \"target\": \"B\", \"logic\": \"linear\", \"params\": {\"k\": 0.8}},"
+        "  {\"origin\": \"B\", \"target\": \"C\", \"logic\": \"linear\", \"params\": {\"k\": 0.0}}"
+        "],"
+        "\"config\": {\"t_start\": 0, \"t_end\": 10, \"dt\": 0.1, \"method\": \"rk4\"}"
+        "}";
+
+    GSSK_Instance *inst = NULL;
+    assert(GSSK_Init(model_json, &inst) == GSSK_SUCCESS);
+    GSSK_Observation obs_data[10];
+    GSSK_Reset(inst);
+    for (int s = 1; s <= 100; s++) {
+        GSSK_Step(inst, 0.1);
+        if (s % 10 == 5)
+            obs_data[s / 10] = (GSSK_Observation){s * 0.1, GSSK_GetState(inst)[1]};
+    }
+    GSSK_NodeObservations node_obs = {.node_id = "B", .data = obs_data, .count = 10};
+
+    GSSK_CalibrationOptions opts;
+    GSSK_InitCalibrationOptions(&opts);
+    opts.iterations = 60;
+    opts.k_max = 2.0;
+    opts.seed = 32;
+    opts.threads = 1;
+    GSSK_CalibrationReport plain, exact, coarse, parallel;
+    assert(GSSK_CalibrateEx(inst, &node_obs, 1, &opts, &plain) == GSSK_SUCCESS);
+    double k0 = GSSK_GetEdgeK(inst, 0), k1 = GSSK_GetEdgeK(inst, 1);
+    assert(plain.cache_hits == 0);
+
+    // Exact repeats cost nothing and change nothing
+    opts.cache_size = 1024;
+    assert(GSSK_CalibrateEx(inst, &node_obs, 1, &opts, &exact) == GSSK_SUCCESS);
+    assert(exact.cache_hits > 0 && exact.evaluations == plain.evaluations);
+    assert(exact.best_fitness == plain.best_fitness);
+    assert(GSSK_GetEdgeK(inst, 0) == k0 && GSSK_GetEdgeK(inst, 1) == k1);
+
+    // A key resolution below the precision sought catches near repeats too
+    opts.cache_tolerance = 1e-6;
+    assert(GSSK_CalibrateEx(inst, &node_obs, 1, &opts, &coarse) == GSSK_SUCCESS);
+    printf("  %zu evaluations: %zu exact repeats, %zu within 1e-6 (MSE %g)\n",
+           plain.evaluations, exact.cache_hits, coarse.cache_hits,
+           coarse.best_fitness);
+    assert(coarse.cache_hits > exact.cache_hits);
+    assert(fabs(GSSK_GetEdgeK(inst, 0) - 0.8) < 1e-3);
+    assert(GSSK_GetEdgeK(inst, 1) < 1e-3);
+
+    // The memo sits outside the workers: same hits on any thread count
+    k0 = GSSK_GetEdgeK(inst, 0);
+    opts.threads = 4;
+    assert(GSSK_CalibrateEx(inst, &node_obs, 1, &opts, &parallel) == GSSK_SUCCESS);
+    assert(parallel.cache_hits == coarse.cache_hits);
+    assert(parallel.best_fitness == coarse.best_fitness);
+    assert(GSSK_GetEdgeK(inst, 0) == k0);
+
+    // A memo smaller than the population still only returns true repeats
+    opts.cache_size = 4;
+    opts.cache_tolerance = 0.0;
+    assert(GSSK_CalibrateEx(inst, &node_obs, 1, &opts, &exact) == GSSK_SUCCESS);
+    assert(exact.best_fitness == plain.best_fitness);
+
+    opts.cache_tolerance = -1.0;
+    assert(GSSK_CalibrateEx(inst, &node_obs, 1, &opts, NULL) == GSSK_ERR_UNKNOWN);
+    GSSK_Free(inst);
+    printf("  Fitness memo test PASSED\n");
+}
+
+// A model with nothing to calibrate
+static GSSK_Instance *init_edgeless(void) {
+    GSSK_Instance *inst = NULL;
+    assert(GSSK_Init("{\"nodes\": [{\"id\": \"B\", \"type\": \"storage\", \"value\": 1.0}],"
+                     "\"edges\": [], \"config\": {\"t_start\": 0, \"t_end\": 10, \"dt\": 0.1}}",
+                     &inst) == GSSK_SUCCESS);
+    return inst;
+}
+
+void test_calibration_experiments() {
+    printf("Testing Multi-Experiment Calibration...\n");
+
+    // B drains to C and D in parallel. One plant observes B, which only
+    // pins down the sum of those two k's; another, started from different
+    // stocks, observes C. Only together do they identify every k.
+    const char *model_json = "{"
+        "\"nodes\": ["
+        "  {\"id\": \"A\", \"type\": \"source\", \"value\": 10.0},"
+        "  {\"id\": \"B\", \"type\": \"storage\", \"value\": 0.0},"
+        "  {\"id\": \"C\", \"type\": \"storage\", \"value\": 0.0},"
+        "  {\"id\": \"D\", \"type\": \"sink\", \"value\": 0.0}"
+        "],"
+        "\"edges\": ["
+        "  {\"origin\": \"A\", \"target\": \"B\", \"logic\": \"linear\", \"params\": {\"k\": 0.8}},"
+        "  {\"origin\": \"B\", \"target\": \"C\", \"logic\": \"linear\", \"params\": {\"k\": 0.3}},"
+        "  {\"origin\": \"B\", \"target\": \"D\", \"logic\": \"linear\", \"params\": {\"k\": 0.2}}"
+        "],"
+        "\"config\": {\"t_start\": 0, \"t_end\": 10, \"dt\": 0.1, \"method\": \"rk4\"}"
+        "}";
+
+    GSSK_Instance *inst = NULL;
+    assert(GSSK_Init(model_json, &inst) == GSSK_SUCCESS);
+    const char *ids[] = {"A", "B"};
+    const double plant2[] = {5.0, 2.0};
+    GSSK_Observation b_data[10], c_data[10];
+    GSSK_Reset(inst);
+    for (int s = 1; s <= 100; s++) {
+        GSSK_Step(inst, 0.1);
+        if (s % 10 == 5)
+            b_data[s / 10] = (GSSK_Observation){s * 0.1, GSSK_GetState(inst)[1]};
+    }
+    GSSK_SetInitialValue(inst, 0, plant2[0]);
+    GSSK_SetInitialValue(inst, 1, plant2[1]);
+    GSSK_Reset(inst);
+    for (int s = 1; s <= 100; s++) {
+        GSSK_Step(inst, 0.1);
+        if (s % 10 == 5)
+            c_data[s / 10] = (GSSK_Observation){s * 0.1, GSSK_GetState(inst)[2]};
+    }
+    GSSK_SetInitialValue(inst, 0, 10.0);
+    GSSK_SetInitialValue(inst, 1, 0.0);
+    GSSK_NodeObservations b_obs = {.node_id = "B", .data = b_data, .count = 10};
+    GSSK_NodeObservations c_obs = {.node_id = "C", .data = c_data, .count = 10};
+    GSSK_Experiment experiments[] = {
+        {NULL, NULL, 0, &b_obs, 1},
+        {ids, plant2, 2, &c_obs, 1}};
+
+    GSSK_CalibrationOptions opts;
+    GSSK_InitCalibrationOptions(&opts);
+    opts.k_max = 2.0;
+    opts.seed = 45;
+    opts.threads = 1;
+    GSSK_CalibrationReport report, parallel;
+    assert(GSSK_CalibrateExperiments(inst, experiments, 2, &opts, &report) == GSSK_SUCCESS);
+    double k[3];
+    for (int e = 0; e < 3; e++)
+        k[e] = GSSK_GetEdgeK(inst, e);
+    printf("  k = (%f, %f, %f), MSE %g over both plants\n", k[0], k[1], k[2],
+           report.best_fitness);
+    assert(fabs(k[0] - 0.8) < 1e-2 && fabs(k[1] - 0.3) < 1e-2 && fabs(k[2] - 0.2) < 1e-2);
+    assert(GSSK_GetInitialValue(inst, 0) == 10.0 && GSSK_GetInitialValue(inst, 1) == 0.0);
+
+    // The reported misfit pools the residuals of both plants
+    double sse = 0.0;
+    for (int plant = 0; plant < 2; plant++) {
+        GSSK_SetInitialValue(inst, 0, plant ? plant2[0] : 10.0);
+        GSSK_SetInitialValue(inst, 1, plant ? plant2[1] : 0.0);
+        GSSK_Reset(inst);
+        const GSSK_Observation *data = plant ? c_data : b_data;
+        for (int s = 1; s <= 100; s++) {
+            GSSK_Step(inst, 0.1);
+            if (s % 10 == 5) {
+                double diff = GSSK_GetState(inst)[plant ? 2 : 1] - data[s / 10].value;
+                sse += diff * diff;
+            }
+        }
+    }
+    GSSK_SetInitialValue(inst, 0, 10.0);
+    GSSK_SetInitialValue(inst, 1, 0.0);
+    assert(fabs(sse / 20 - report.best_fitness) <= 1e-9 * (1.0 + sse));
+
+    // Experiments run concurrently, with the same result
+    opts.threads = 4;
+    assert(GSSK_CalibrateExperiments(inst, experiments, 2, &opts, &parallel) == GSSK_SUCCESS);
+    assert(parallel.best_fitness == report.best_fitness);
+    assert(parallel.early_aborts == report.early_aborts);
+    for (int e = 0; e < 3; e++)
+        assert(GSSK_GetEdgeK(inst, e) == k[e]);
+
+    // Plant 1 alone cannot tell the two drains apart
+    GSSK_CalibrationReport alone;
+    assert(GSSK_CalibrateExperiments(inst, experiments, 1, &opts, &alone) == GSSK_SUCCESS);
+    printf("  Plant 1 alone: k = (%f, %f, %f)\n", GSSK_GetEdgeK(inst, 0),
+           GSSK_GetEdgeK(inst, 1), GSSK_GetEdgeK(inst, 2));
+    assert(fabs(GSSK_GetEdgeK(inst, 1) + GSSK_GetEdgeK(inst, 2) - 0.5) < 1e-2);
+
+    // Overrides must name model nodes
+    const char *bad_ids[] = {"A", "Z"};
+    experiments[1].node_ids = bad_ids;
+    assert(GSSK_CalibrateExperiments(inst, experiments, 2, &opts, NULL) == GSSK_ERR_UNKNOWN);
+    GSSK_Free(inst);
+
+    // Without edges there is nothing to fit, and the report says so
+    GSSK_Instance *fixed = init_edgeless();
+    memset(&alone, 0xff, sizeof(alone));
+    assert(GSSK_CalibrateExperiments(fixed, experiments, 1, &opts, &alone) == GSSK_SUCCESS);
+    assert(isinf(alone.best_fitness) && alone.evaluations == 0 &&
+           alone.generations == 0 && alone.cache_hits == 0);
+    GSSK_Free(fixed);
+    printf("  Multi-experiment calibration test PASSED\n");
+}
+
+// Mean squared error of B against observations at steps s % 10 == 5
+static double session_mse(GSSK_Instance *inst, const GSSK_Observation *data,
+                          int first, int last) {
+    double sse = 0.0;
+    GSSK_Reset(inst);
+    for (int s = 1; s <= last * 10; s++) {
+        GSSK_Step(inst, 0.1);
+        if (s % 10 == 5 && s / 10 >= first) {
+            double diff = GSSK_GetState(inst)[1] - data[s / 10].value;
+            sse += diff * diff;
+        }
+    }
+    return sse / (last - first);
+}
+
+void test_calibration_session() {
+    printf("Testing Calibration Sessions...\n");
+
+    const char *model_json = "{"
+        "\"nodes\": ["
+        "  {\"id\": \"A\", \"type\": \"source\", \"value\": 10.0},"
+        "  {\"id\": \"B\", \"type\": \"storage\", \"value\": 0.0},"
+        "  {\"id\": \"C\", \"type\": \"sink\", \"value\": 0.0}"
+        "],"
+        "\"edges\": ["
+        "  {\"origin\": \"A\", \"target\": \"B\", \"logic\": \"linear\", \"params\": {\"k\": 0.8}},"
+        "  {\"origin\": \"B\", \"target\": \"C\", \"logic\": \"linear\", \"params\": {\"k\": 0.3}}"
+        "],"
+        "\"config\": {\"t_start\": 0, \"t_end\": 20, \"dt\": 0.1, \"method\": \"rk4\"}"
+        "}";
+
+    // A day of hourly readings of B, with a little sensor noise
+    GSSK_Instance *inst = NULL;
+    assert(GSSK_Init(model_json, &inst) == GSSK_SUCCESS);
+    GSSK_Observation data[20];
+    GSSK_Reset(inst);
+    for (int s = 1; s <= 200; s++) {
+        GSSK_Step(inst, 0.1);
+        if (s % 10 == 5)
+            data[s / 10] = (GSSK_Observation){s * 0.1, GSSK_GetState(inst)[1] + 0.01 * ((s / 10) % 3 - 1)};
+    }
+
+    GSSK_CalibrationOptions opts;
+    GSSK_InitCalibrationOptions(&opts);
+    opts.k_max = 2.0;
+    opts.seed = 46;
+    GSSK_CalibrationSession *session = GSSK_CalibrationSessionCreate(inst, &opts);
+    assert(session != NULL);
+    GSSK_CalibrationReport report;
+    assert(GSSK_CalibrationSessionRun(session, 10, &report) == GSSK_ERR_UNKNOWN);
+
+    // The first half of the data
+    GSSK_NodeObservations first = {.node_id = "B", .data = data, .count = 10};
+    assert(GSSK_CalibrationSessionAddObservations(session, &first, 1) == GSSK_SUCCESS);
+    assert(GSSK_CalibrationSessionRun(session, 40, &report) == GSSK_SUCCESS);
+    assert(report.evaluations == 20 * 41 && report.generations == 40);
+    assert(fabs(session_mse(inst, data, 0, 10) - report.best_fitness) <= 1e-9 * report.best_fitness);
+
+    // Appending the second half only simulates the new window from the
+    // saved states; the scores are those of full runs
+    GSSK_NodeObservations second = {.node_id = "B", .data = &data[10], .count = 10};
+    assert(GSSK_CalibrationSessionAddObservations(session, &second, 1) == GSSK_SUCCESS);
+    assert(GSSK_CalibrationSessionRun(session, 0, &report) == GSSK_SUCCESS);
+    assert(report.evaluations == 20 && report.generations == 0);
+    double rescored = report.best_fitness;
+    assert(fabs(session_mse(inst, data, 0, 20) - rescored) <= 1e-9 * rescored);
+
+    // A few warm generations beat a cold start given the same effort
+    assert(GSSK_CalibrationSessionRun(session, 10, &report) == GSSK_SUCCESS);
+    assert(report.evaluations == 20 * 10 && report.best_fitness <= rescored);
+    double warm = report.best_fitness;
+    double k0 = GSSK_GetEdgeK(inst, 0), k1 = GSSK_GetEdgeK(inst, 1);
+    GSSK_NodeObservations all = {.node_id = "B", .data = data, .count = 20};
+    GSSK_CalibrationReport cold;
+    opts.iterations = 10;
+    assert(GSSK_CalibrateEx(inst, &all, 1, &opts, &cold) == GSSK_SUCCESS);
+    printf("  Warm: k = (%f, %f), MSE %g after 10 generations; cold start: MSE %g\n",
+           k0, k1, warm, cold.best_fitness);
+    assert(warm < cold.best_fitness);
+    assert(fabs(k0 - 0.8) < 1e-2 && fabs(k1 - 0.3) < 1e-2);
+
+    // A late reading inside the covered window (a repeat of the fourth)
+    // forces full rescoring
+    GSSK_NodeObservations late = {.node_id = "B", .data = &data[3], .count = 1};
+    assert(GSSK_CalibrationSessionAddObservations(session, &late, 1) == GSSK_SUCCESS);
+    assert(GSSK_CalibrationSessionRun(session, 0, &report) == GSSK_SUCCESS);
+    double r3 = session_mse(inst, data, 3, 4);
+    double expected = (session_mse(inst, data, 0, 20) * 20 + r3) / 21;
+    assert(report.evaluations == 20);
+    assert(fabs(report.best_fitness - expected) <= 1e-9 * expected);
+
+    GSSK_NodeObservations unknown = {.node_id = "Z", .data = data, .count = 1};
+    assert(GSSK_CalibrationSessionAddObservations(session, &unknown, 1) == GSSK_ERR_UNKNOWN);
+    GSSK_CalibrationSessionFree(session);
+    opts.optimizer = GSSK_OPTIMIZER_CMAES;
+    assert(GSSK_CalibrationSessionCreate(inst, &opts) == NULL);
+    opts.optimizer = GSSK_OPTIMIZER_DE;
+    opts.screen_factor = 4;
+    assert(GSSK_CalibrationSessionCreate(inst, &opts) == NULL);
+    GSSK_Free(inst);
+    printf("  Calibration session test PASSED\n");
+}
+
+void test_sensitivity_lm() {
+    printf("Testing Forward Sensitivities and Levenberg-Marquardt...\n");
+
+    // One edge of every primitive with a smooth derivative
+    const char *model_json = "{"
+        "\"nodes\": ["
+        "  {\"id\": \"A\", \"type\": \"source\", \"value\": 10.0},"
+        "  {\"id\": \"B\", \"type\": \"storage\", \"value\": 1.0},"
+        "  {\"id\": \"C\", \"type\": \"storage\", \"value\": 2.0},"
+        "  {\"id\": \"D\", \"type\": \"sink\", \"value\": 0.0}"
+        "],"
+        "\"edges\": ["
+        "  {\"origin\": \"A\", \"target\": \"B\", \"logic\": \"linear\", \"params\": {\"k\": 0.2}},"
+        "  {\"origin\": \"B\", \"target\": \"C\", \"logic\": \"limit\", \"params\": {\"k\": 0.5, \"control_node\": \"C\"}},"
+        "  {\"origin\": \"C\", \"target\": \"D\", \"logic\": \"interaction\", \"params\": {\"k\": 0.03, \"control_node\": \"B\"}},"
+        "  {\"origin\": \"A\", \"target\": \"D\", \"logic\": \"constant\", \"params\": {\"k\": 0.1}}"
+        "],"
+        "\"config\": {\"t_start\": 0, \"t_end\": 5, \"dt\": 0.05, \"method\": \"rk4\"}"
+        "}";
+
+    GSSK_Instance *inst = NULL;
+    assert(GSSK_Init(model_json, &inst) == GSSK_SUCCESS);
+
+    GSSK_SensitivityResult *sens = NULL;
+    assert(GSSK_Sensitivities(inst, NULL, 0, &sens) == GSSK_SUCCESS);
+    assert(sens->param_count == 4 && sens->node_count == 4 && sens->step_count == 101);
+
+    // The state matches the plain simulation bit for bit
+    GSSK_Reset(inst);
+    for (size_t s = 1; s < sens->step_count; s++)
+        GSSK_Step(inst, 0.05);
+    for (size_t i = 0; i < 4; i++)
+        assert(sens->state[100 * 4 + i] == GSSK_GetState(inst)[i]);
+
+    // Central differences of the final state agree with the tangent
+    double max_err = 0.0;
+    for (size_t p = 0; p < 4; p++) {
+        double k = GSSK_GetEdgeK(inst, p), h = 1e-6 * k;
+        double plus[4], minus[4];
+        GSSK_SetEdgeK(inst, p, k + h);
+        GSSK_Reset(inst);
+        for (int s = 0; s < 100; s++)
+            GSSK_Step(inst, 0.05);
+        memcpy(plus, GSSK_GetState(inst), sizeof(plus));
+        GSSK_SetEdgeK(inst, p, k - h);
+        GSSK_Reset(inst);
+        for (int s = 0; s < 100; s++)
+            GSSK_Step(inst, 0.05);
+        memcpy(minus, GSSK_GetState(inst), sizeof(minus));
+        GSSK_SetEdgeK(inst, p, k);
+        for (size_t i = 0; i < 4; i++) {
+            double fd = (plus[i] - minus[i]) / (2.0 * h);
+            double an = sens->sensitivity[(100 * 4 + i) * 4 + p];
+            double err = fabs(fd - an) / (fabs(fd) + 1e-6);
+            if (err > max_err)
+                max_err = err;
+        }
+    }
+    printf("  Max relative error vs finite differences: %g\n", max_err);
+    assert(max_err < 1e-6);
+    GSSK_FreeSensitivityResult(sens);
+
+    // A subset and invalid indices
+    size_t subset[] = {2};
+    assert(GSSK_Sensitivities(inst, subset, 1, &sens) == GSSK_SUCCESS);
+    assert(sens->param_count == 1 && sens->edges[0] == 2);
+    GSSK_FreeSensitivityResult(sens);
+    size_t bad[] = {7};
+    assert(GSSK_Sensitivities(inst, bad, 1, &sens) != GSSK_SUCCESS && !sens);
+
+    // Fit the first three k's back from observations of B and C
+    GSSK_Observation b_data[10], c_data[10];
+    GSSK_Reset(inst);
+    for (int s = 1; s <= 100; s++) {
+        GSSK_Step(inst, 0.05);
+        if (s % 10 == 5) {
+            b_data[s / 10] = (GSSK_Observation){s * 0.05, GSSK_GetState(inst)[1]};
+            c_data[s / 10] = (GSSK_Observation){s * 0.05, GSSK_GetState(inst)[2]};
+        }
+    }
+    GSSK_NodeObservations node_obs[] = {
+        {.node_id = "B", .data = b_data, .count = 10},
+        {.node_id = "C", .data = c_data, .count = 10}};
+    GSSK_SetEdgeK(inst, 0, 0.5);
+    GSSK_SetEdgeK(inst, 1, 0.2);
+    GSSK_SetEdgeK(inst, 2, 0.1);
+
+    GSSK_LMOptions opts;
+    GSSK_InitLMOptions(&opts);
+    size_t fitted[] = {0, 1, 2};
+    opts.edges = fitted;
+    opts.param_count = 3;
+    GSSK_CalibrationReport report;
+    assert(GSSK_CalibrateLM(inst, node_obs, 2, &opts, &report) == GSSK_SUCCESS);
+    printf("  k = (%f, %f, %f) after %zu steps, %zu integrations, MSE %g\n",
+           GSSK_GetEdgeK(inst, 0), GSSK_GetEdgeK(inst, 1), GSSK_GetEdgeK(inst, 2),
+           report.generations, report.evaluations, report.best_fitness);
+    assert(fabs(GSSK_GetEdgeK(inst, 0) - 0.2) < 1e-6);
+    assert(fabs(GSSK_GetEdgeK(inst, 1) - 0.5) < 1e-6);
+    assert(fabs(GSSK_GetEdgeK(inst, 2) - 0.03) < 1e-6);
+    assert(GSSK_GetEdgeK(inst, 3) == 0.1);
+    assert(report.generations < 30 && report.best_fitness < 1e-16);
+
+    // A one-step budget is reported as such, keeping the best k's
+    GSSK_SetEdgeK(inst, 0, 0.5);
+    opts.iterations = 1;
+    assert(GSSK_CalibrateLM(inst, node_obs, 2, &opts, &report) == GSSK_ERR_NOT_CONVERGED);
+    assert(report.generations == 1);
+    GSSK_Free(inst);
+
+    // Without edges there is nothing to fit, and the report says so
+    inst = init_edgeless();
+    memset(&report, 0xff, sizeof(report));
+    assert(GSSK_CalibrateLM(inst, node_obs, 2, &opts, &report) == GSSK_SUCCESS);
+    assert(isinf(report.best_fitness) && report.evaluations == 0 &&
+           report.generations == 0 && report.cache_hits == 0);
+    GSSK_Free(inst);
+    printf("  Sensitivity and LM test PASSED\n");
+}
+
+void test_adjoint_lbfgs() {
+    printf("Testing Adjoint Gradients and L-BFGS...\n");
+
+    // Observations at every other step of the RK4 model from the LM test
+    const char *model_json = "{"
+        "\"nodes\": ["
+        "  {\"id\": \"A\", \"type\": \"source\", \"value\": 10.0},"
+        "  {\"id\": \"B\", \"type\": \"storage\", \"value\": 1.0},"
+        "  {\"id\": \"C\", \"type\": \"storage\", \"value\": 2.0},"
+        "  {\"id\": \"D\", \"type\": \"sink\", \"value\": 0.0}"
+        "],"
+        "\"edges\": ["
+        "  {\"origin\": \"A\", \"target\": \"B\", \"logic\": \"linear\", \"params\": {\"k\": 0.2}},"
+        "  {\"origin\": \"B\", \"target\": \"C\", \"logic\": \"limit\", \"params\": {\"k\": 0.5, \"control_node\": \"C\"}},"
+        "  {\"origin\": \"C\", \"target\": \"D\", \"logic\": \"interaction\", \"params\": {\"k\": 0.03, \"control_node\": \"B\"}},"
+        "  {\"origin\": \"A\", \"target\": \"D\", \"logic\": \"constant\", \"params\": {\"k\": 0.1}}"
+        "],"
+        "\"config\": {\"t_start\": 0, \"t_end\": 5, \"dt\": 0.05, \"method\": \"rk4\"}"
+        "}";
+
+    GSSK_Instance *inst = NULL;
+    assert(GSSK_Init(model_json, &inst) == GSSK_SUCCESS);
+    GSSK_Observation b_data[33], c_data[33];
+    GSSK_Reset(inst);
+    for (int s = 1, j = 0; s <= 99; s++) {
+        GSSK_Step(inst, 0.05);
+        if (s % 3 == 0) {
+            // Midway through the next step, as the fit interpolates
+            b_data[j] = (GSSK_Observation){(s + 0.5) * 0.05, 1.1 * GSSK_GetState(inst)[1]};
+            c_data[j] = (GSSK_Observation){(s + 0.5) * 0.05, 0.9 * GSSK_GetState(inst)[2]};
+            j++;
+        }
+    }
+    GSSK_NodeObservations node_obs[] = {
+        {.node_id = "B", .data = b_data, .count = 33},
+        {.node_id = "C", .data = c_data, .count = 33}};
+
+    // Adjoint gradient of the MSE against one built from forward sensitivities
+    double mse, grad[4];
+    assert(GSSK_Gradient(inst, node_obs, 2, NULL, &mse, grad) == GSSK_SUCCESS);
+    GSSK_SensitivityResult *sens = NULL;
+    assert(GSSK_Sensitivities(inst, NULL, 0, &sens) == GSSK_SUCCESS);
+    double ref[4] = {0}, ref_mse = 0.0;
+    for (int j = 0; j < 33; j++) {
+        for (int o = 0; o < 2; o++) {
+            size_t node = 1 + o, s = 3 * (j + 1);
+            const GSSK_Observation *ob = o == 0 ? &b_data[j] : &c_data[j];
+            double y0 = sens->state[s * 4 + node], y1 = sens->state[(s + 1) * 4 + node];
+            double r = 0.5 * (y0 + y1) - ob->value;
+            ref_mse += r * r / 66;
+            for (size_t p = 0; p < 4; p++)
+                ref[p] += 2.0 * r / 66 * 0.5 *
+                          (sens->sensitivity[(s * 4 + node) * 4 + p] +
+                           sens->sensitivity[((s + 1) * 4 + node) * 4 + p]);
+        }
+    }
+    GSSK_FreeSensitivityResult(sens);
+    assert(fabs(mse - ref_mse) < 1e-12 * ref_mse);
+    for (size_t p = 0; p < 4; p++) {
+        printf("  dMSE/dk%zu: adjoint %.10g, forward %.10g\n", p, grad[p], ref[p]);
+        assert(fabs(grad[p] - ref[p]) < 1e-9 * (fabs(ref[p]) + 1e-9));
+    }
+
+    // The checkpoint spacing changes memory, not the result
+    GSSK_GradientOptions gopts;
+    GSSK_InitGradientOptions(&gopts);
+    size_t spacings[] = {1, 7, 1000};
+    for (int c = 0; c < 3; c++) {
+        double other_mse, other[4];
+        gopts.checkpoints = spacings[c];
+        assert(GSSK_Gradient(inst, node_obs, 2, &gopts, &other_mse, other) == GSSK_SUCCESS);
+        assert(other_mse == mse && memcmp(other, grad, sizeof(grad)) == 0);
+    }
+
+    // Euler, with a node drained to the clamp, against central differences
+    const char *drain_json = "{"
+        "\"nodes\": ["
+        "  {\"id\": \"A\", \"type\": \"storage\", \"value\": 5.0},"
+        "  {\"id\": \"B\", \"type\": \"storage\", \"value\": 0.0}"
+        "],"
+        "\"edges\": ["
+        "  {\"origin\": \"A\", \"target\": \"B\", \"logic\": \"constant\", \"params\": {\"k\": 1.3}},"
+        "  {\"origin\": \"B\", \"target\": \"A\", \"logic\": \"linear\", \"params\": {\"k\": 0.1}}"
+        "],"
+        "\"config\": {\"t_start\": 0, \"t_end\": 8, \"dt\": 0.1}"
+        "}";
+    GSSK_Instance *drain = NULL;
+    assert(GSSK_Init(drain_json, &drain) == GSSK_SUCCESS);
+    GSSK_Observation drain_data[] = {{2.05, 3.0}, {6.05, 1.0}, {7.95, 0.5}};
+    GSSK_NodeObservations drain_obs = {.node_id = "A", .data = drain_data, .count = 3};
+    double dgrad[2];
+    assert(GSSK_Gradient(drain, &drain_obs, 1, NULL, &mse, dgrad) == GSSK_SUCCESS);
+    for (size_t p = 0; p < 2; p++) {
+        double k = GSSK_GetEdgeK(drain, p), h = 1e-7, plus, minus, unused[2];
+        GSSK_SetEdgeK(drain, p, k + h);
+        GSSK_Gradient(drain, &drain_obs, 1, NULL, &plus, unused);
+        GSSK_SetEdgeK(drain, p, k - h);
+        GSSK_Gradient(drain, &drain_obs, 1, NULL, &minus, unused);
+        GSSK_SetEdgeK(drain, p, k);
+        assert(fabs((plus - minus) / (2 * h) - dgrad[p]) < 1e-5 * fabs(dgrad[p]));
+    }
+    GSSK_Free(drain);
+
+    // Projected L-BFGS from a poor start recovers the least-squares fit that
+    // LM finds; the unobserved constant edge has no gradient and keeps its k
+    GSSK_LMOptions lm;
+    GSSK_InitLMOptions(&lm);
+    assert(GSSK_CalibrateLM(inst, node_obs, 2, &lm, NULL) == GSSK_SUCCESS);
+    double best[4];
+    for (size_t p = 0; p < 4; p++) {
+        best[p] = GSSK_GetEdgeK(inst, p);
+        GSSK_SetEdgeK(inst, p, p == 3 ? 0.1 : 0.3);
+    }
+    GSSK_LBFGSOptions opts;
+    GSSK_InitLBFGSOptions(&opts);
+    GSSK_CalibrationReport report;
+    assert(GSSK_CalibrateLBFGS(inst, node_obs, 2, &opts, &report) == GSSK_SUCCESS);
+    printf("  L-BFGS: k = (%f, %f, %f, %f) after %zu iterations, %zu gradients\n",
+           GSSK_GetEdgeK(inst, 0), GSSK_GetEdgeK(inst, 1), GSSK_GetEdgeK(inst, 2),
+           GSSK_GetEdgeK(inst, 3), report.generations, report.evaluations);
+    for (size_t p = 0; p < 4; p++)
+        assert(fabs(GSSK_GetEdgeK(inst, p) - best[p]) < 1e-4 * (best[p] + 1e-3));
+    GSSK_Free(inst);
+
+    // Without edges there is nothing to fit, and the report says so
+    inst = init_edgeless();
+    memset(&report, 0xff, sizeof(report));
+    assert(GSSK_CalibrateLBFGS(inst, node_obs, 2, &opts, &report) == GSSK_SUCCESS);
+    assert(isinf(report.best_fitness) && report.evaluations == 0 &&
+           report.generations == 0 && report.screened == 0);
+    GSSK_Free(inst);
+    printf("  Adjoint and L-BFGS test PASSED\n");
+}
+
+void test_calibration_ranges() {
+    printf("Testing Calibration Ranges...\n");
+
+    // Only the first two edges are calibratable; the third is known
+    const char *model_json = "{"
+        "\"nodes\": ["
+        "  {\"id\": \"A\", \"type\": \"source\", \"value\": 10.0},"
+        "  {\"id\": \"B\", \"type\": \"storage\", \"value\": 0.0},"
+        "  {\"id\": \"C\", \"type\": \"storage\", \"value\": 0.0},"
+        "  {\"id\": \"D\", \"type\": \"sink\", \"value\": 0.0}"
+        "],"
+        "\"edges\": ["
+        "  {\"origin\": \"A\", \"target\": \"B\", \"logic\": \"linear\", \"params\": {\"k\": 0.8,"
+        "   \"calibrate\": {\"min\": 0.01, \"max\": 10, \"scale\": \"log\"}}},"
+        "  {\"origin\": \"B\", \"target\": \"C\", \"logic\": \"linear\", \"params\": {\"k\": 0.3,"
+        "   \"calibrate\": {\"min\": 0.1, \"max\": 1}}},"
+        "  {\"origin\": \"C\", \"target\": \"D\", \"logic\": \"linear\", \"params\": {\"k\": 0.05}}"
+        "],"
+        "\"config\": {\"t_start\": 0, \"t_end\": 10, \"dt\": 0.1, \"method\": \"rk4\"}"
+        "}";
+
+    GSSK_Instance *inst = NULL;
+    assert(GSSK_Init(model_json, &inst) == GSSK_SUCCESS);
+    double lo, hi;
+    GSSK_ParamScale scale;
+    assert(GSSK_GetEdgeCalibration(inst, 0, &lo, &hi, &scale));
+    assert(lo == 0.01 && hi == 10 && scale == GSSK_SCALE_LOG);
+    assert(GSSK_GetEdgeCalibration(inst, 1, &lo, &hi, &scale));
+    assert(lo == 0.1 && hi == 1 && scale == GSSK_SCALE_LINEAR);
+    assert(!GSSK_GetEdgeCalibration(inst, 2, NULL, NULL, NULL));
+
+    GSSK_Observation b_data[10], c_data[10];
+    GSSK_Reset(inst);
+    for (int s = 1; s <= 100; s++) {
+        GSSK_Step(inst, 0.1);
+        if (s % 10 == 5) {
+            b_data[s / 10] = (GSSK_Observation){s * 0.1, GSSK_GetState(inst)[1]};
+            c_data[s / 10] = (GSSK_Observation){s * 0.1, GSSK_GetState(inst)[2]};
+        }
+    }
+    GSSK_NodeObservations node_obs[] = {
+        {.node_id = "B", .data = b_data, .count = 10},
+        {.node_id = "C", .data = c_data, .count = 10}};
+
+    // DE searches the two ranges; the known k is left alone
+    GSSK_SetEdgeK(inst, 0, 5.0);
+    GSSK_SetEdgeK(inst, 1, 0.9);
+    GSSK_CalibrationOptions opts;
+    GSSK_InitCalibrationOptions(&opts);
+    opts.iterations = 40;
+    opts.seed = 39;
+    GSSK_CalibrationReport report;
+    assert(GSSK_CalibrateEx(inst, node_obs, 2, &opts, &report) == GSSK_SUCCESS);
+    printf("  DE: k = (%f, %f), MSE %g\n", GSSK_GetEdgeK(inst, 0),
+           GSSK_GetEdgeK(inst, 1), report.best_fitness);
+    assert(fabs(GSSK_GetEdgeK(inst, 0) - 0.8) < 0.02);
+    assert(fabs(GSSK_GetEdgeK(inst, 1) - 0.3) < 0.02);
+    assert(GSSK_GetEdgeK(inst, 2) == 0.05);
+
+    // LM and L-BFGS stay inside the ranges, starting from outside them
+    GSSK_SetEdgeK(inst, 0, 50.0);
+    GSSK_SetEdgeK(inst, 1, 0.0);
+    GSSK_LMOptions lm;
+    GSSK_InitLMOptions(&lm);
+    assert(GSSK_CalibrateLM(inst, node_obs, 2, &lm, &report) == GSSK_SUCCESS);
+    assert(fabs(GSSK_GetEdgeK(inst, 0) - 0.8) < 1e-6);
+    assert(fabs(GSSK_GetEdgeK(inst, 1) - 0.3) < 1e-6);
+    assert(GSSK_GetEdgeK(inst, 2) == 0.05);
+
+    GSSK_SetEdgeK(inst, 0, 0.05);
+    GSSK_SetEdgeK(inst, 1, 1.0);
+    GSSK_LBFGSOptions lb;
+    GSSK_InitLBFGSOptions(&lb);
+    assert(GSSK_CalibrateLBFGS(inst, node_obs, 2, &lb, &report) == GSSK_SUCCESS);
+    printf("  L-BFGS: k = (%f, %f) after %zu iterations\n", GSSK_GetEdgeK(inst, 0),
+           GSSK_GetEdgeK(inst, 1), report.generations);
+    assert(fabs(GSSK_GetEdgeK(inst, 0) - 0.8) < 1e-3);
+    assert(fabs(GSSK_GetEdgeK(inst, 1) - 0.3) < 1e-3);
+    GSSK_Free(inst);
+
+    // Malformed ranges are schema violations
+    const char *bad[] = {
+        "{\"min\": 0, \"max\": 1, \"scale\": \"log\"}",
+        "{\"min\": 2, \"max\": 1}",
+        "{\"min\": 0.1, \"max\": 1, \"scale\": \"cubic\"}",
+        "{\"max\": 1}"};
+    for (int i = 0; i < 4; i++) {
+        char json[512];
+        snprintf(json, sizeof(json), "{\"nodes\": [{\"id\": \"A\", \"type\": \"storage\", \"value\": 1}],"
+                 "\"edges\": [{\"origin\": \"A\", \"target\": \"A\", \"logic\": \"linear\","
+                 "\"params\": {\"k\": 0.5, \"calibrate\": %s}}]}", bad[i]);
+        GSSK_Instance *b = NULL;
+        assert(GSSK_Init(json, &b) == GSSK_ERR_SCHEMA_VIOLATION);
+        GSSK_Free(b);
+    }
+    printf("  Calibration ranges test PASSED\n");
+}
+
+void test_calibration_mcmc() {
+    printf("Testing Parallel-Tempering MCMC...\n");
+
+    const char *model_json = "{"
+        "\"nodes\": ["
+        "  {\"id\": \"A\", \"type\": \"source\", \"value\": 10.0},"
+        "  {\"id\": \"B\", \"type\": \"storage\", \"value\": 0.0},"
+        "  {\"id\": \"C\", \"type\": \"sink\", \"value\": 0.0}"
+        "],"
+        "\"edges\": ["
+        "  {\"origin\": \"A\", \"target\": \"B\", \"logic\": \"linear\", \"params\": {\"k\": 0.8}},"
+        "  {\"origin\": \"B\", \"target\": \"C\", \"logic\": \"linear\", \"params\": {\"k\": 0.3}}"
+        "],"
+        "\"config\": {\"t_start\": 0, \"t_end\": 10, \"dt\": 0.1, \"method\": \"rk4\"}"
+        "}";
+
+    // Observations of B with fixed errors of about 0.5
+    static const double error[10] = {0.3, -0.5, 0.1, 0.8, -0.2, -0.6, 0.4, 0.0, -0.3, 0.5};
+    GSSK_Instance *inst = NULL;
+    assert(GSSK_Init(model_json, &inst) == GSSK_SUCCESS);
+    GSSK_Observation obs_data[10];
+    GSSK_Reset(inst);
+    for (int s = 1; s <= 100; s++) {
+        GSSK_Step(inst, 0.1);
+        if (s % 10 == 5)
+            obs_data[s / 10] = (GSSK_Observation){s * 0.1, GSSK_GetState(inst)[1] + error[s / 10]};
+    }
+    GSSK_NodeObservations node_obs = {.node_id = "B", .data = obs_data, .count = 10};
+    GSSK_SetEdgeK(inst, 0, 0.5);
+    GSSK_SetEdgeK(inst, 1, 0.5);
+
+    GSSK_MCMCOptions opts;
+    GSSK_InitMCMCOptions(&opts);
+    opts.noise = 0.5;
+    opts.seed = 44;
+    opts.threads = 1;
+    enum { N = 4000 };
+    static double samples[N * 2], parallel[N * 2];
+    GSSK_MCMCReport report;
+    assert(GSSK_CalibrateMCMC(inst, &node_obs, 1, &opts, samples, N, &report) == GSSK_SUCCESS);
+    assert(report.samples == N);
+    double mean[2] = {0.0, 0.0}, sd[2] = {0.0, 0.0};
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < 2; j++)
+            mean[j] += samples[i * 2 + j] / N;
+    }
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < 2; j++)
+            sd[j] += (samples[i * 2 + j] - mean[j]) * (samples[i * 2 + j] - mean[j]) / N;
+    }
+    sd[0] = sqrt(sd[0]);
+    sd[1] = sqrt(sd[1]);
+    printf("  k0 %f +/- %f, k1 %f +/- %f; acceptance %.2f, swaps %.2f, %zu of %zu evaluations aborted\n",
+           mean[0], sd[0], mean[1], sd[1], report.acceptance, report.swap_rate,
+           report.early_aborts, report.evaluations);
+
+    // The posterior covers the true k's and is much tighter than the start
+    assert(fabs(mean[0] - 0.8) < 3 * sd[0] && fabs(mean[1] - 0.3) < 3 * sd[1]);
+    assert(sd[0] > 0.005 && sd[0] < 0.1 && sd[1] > 0.002 && sd[1] < 0.05);
+    assert(report.acceptance > 0.1 && report.acceptance < 0.5);
+    assert(report.swap_rate > 0.0 && report.early_aborts > 0);
+    assert(report.best_fitness < 0.5);
+    assert(GSSK_GetEdgeK(inst, 0) == 0.5 && GSSK_GetEdgeK(inst, 1) == 0.5);
+
+    // Each chain owns its generator: the thread count changes nothing
+    opts.threads = 4;
+    GSSK_MCMCReport parallel_report;
+    assert(GSSK_CalibrateMCMC(inst, &node_obs, 1, &opts, parallel, N, &parallel_report) == GSSK_SUCCESS);
+    assert(memcmp(samples, parallel, sizeof(samples)) == 0);
+    assert(parallel_report.evaluations == report.evaluations);
+
+    opts.noise = 0.0;
+    assert(GSSK_CalibrateMCMC(inst, &node_obs, 1, &opts, samples, N, NULL) == GSSK_ERR_UNKNOWN);
+    GSSK_Free(inst);
+
+    // An edgeless model follows the calibrators: success, nothing sampled
+    inst = init_edgeless();
+    opts.noise = 1.0;
+    memset(&report, 0xff, sizeof(report));
+    assert(GSSK_CalibrateMCMC(inst, &node_obs, 1, &opts, samples, N, &report) == GSSK_SUCCESS);
+    assert(report.samples == 0 && report.evaluations == 0 &&
+           isinf(report.best_fitness));
+    GSSK_Free(inst);
+    printf("  MCMC test PASSED\n");
+}
+
 void test_ensemble() {
     printf("Testing Ensemble Forecasting...\n");
 
@@ -90,8 +1172,896 @@ void test_ensemble() {
     printf("  Ensemble test PASSED\n");
 }
 
+void test_ensemble_sampling() {
+    printf("Testing Ensemble Sampling Strategies...\n");
+
+    const char *model_json = "{"
+        "\"nodes\": ["
+        "  {\"id\": \"Source\", \"type\": \"source\", \"value\": 10.0},"
+        "  {\"id\": \"Stock\", \"type\": \"storage\", \"value\": 0.0}"
+        "],"
+        "\"edges\": ["
+        "  {\"origin\": \"Source\", \"target\": \"Stock\", \"logic\": \"linear\", \"params\": {\"k\": 1.0}}"
+        "],"
+        "\"config\": {\"t_start\": 0, \"t_end\": 10, \"dt\": 1.0}"
+        "}";
+
+    GSSK_Instance *inst = NULL;
+    assert(GSSK_Init(model_json, &inst) == GSSK_SUCCESS);
+
+    // Stock(10) = 100 * factor, so the exact ensemble mean is 100
+    size_t final_idx = 10 * 2 + 1;
+    GSSK_Sampling designs[] = {GSSK_SAMPLING_LHS, GSSK_SAMPLING_SOBOL};
+    const char *names[] = {"LHS", "Sobol"};
+
+    for (int d = 0; d < 2; d++) {
+        GSSK_EnsembleOptions opts;
+        GSSK_InitEnsembleOptions(&opts);
+        opts.runs = 64;
+        opts.perturbation = 0.2;
+        opts.sampling = designs[d];
+        opts.seed = 7;
+
+        GSSK_EnsembleResult *res = GSSK_EnsembleForecastEx(inst, &opts);
+        assert(res != NULL);
+        printf("  %s t=10 Mean: %f, Min: %f, Max: %f\n", names[d],
+               res->mean_envelope[final_idx], res->min_envelope[final_idx],
+               res->max_envelope[final_idx]);
+        assert(fabs(res->mean_envelope[final_idx] - 100.0) < 0.5);
+        assert(res->min_envelope[final_idx] < 82.0);
+        assert(res->max_envelope[final_idx] > 118.0);
+        GSSK_FreeEnsembleResult(res);
+    }
+
+    // Same seed reproduces the same ensemble
+    GSSK_EnsembleOptions opts;
+    GSSK_InitEnsembleOptions(&opts);
+    opts.runs = 32;
+    opts.sampling = GSSK_SAMPLING_SOBOL;
+    opts.distribution = GSSK_DIST_LOGNORMAL;
+    opts.seed = 11;
+    GSSK_EnsembleResult *a = GSSK_EnsembleForecastEx(inst, &opts);
+    GSSK_EnsembleResult *b = GSSK_EnsembleForecastEx(inst, &opts);
+    assert(a && b);
+    assert(a->mean_envelope[final_idx] == b->mean_envelope[final_idx]);
+    assert(fabs(a->mean_envelope[final_idx] - 100.0) < 2.0);
+    GSSK_FreeEnsembleResult(a);
+    GSSK_FreeEnsembleResult(b);
+
+    // Initial value perturbation only: k stays fixed, Source value varies
+    opts.perturbation = 0.0;
+    opts.value_perturbation = 0.1;
+    opts.distribution = GSSK_DIST_UNIFORM;
+    GSSK_EnsembleResult *v = GSSK_EnsembleForecastEx(inst, &opts);
+    assert(v != NULL);
+    assert(v->max_envelope[final_idx] - v->min_envelope[final_idx] > 10.0);
+    assert(v->min_envelope[final_idx] >= 90.0 - 1e-9);
+    assert(v->max_envelope[final_idx] <= 110.0 + 1e-9);
+    GSSK_FreeEnsembleResult(v);
+
+    // Parameters are restored afterwards
+    assert(GSSK_GetEdgeK(inst, 0) == 1.0);
+    assert(GSSK_GetInitialValue(inst, 0) == 10.0);
+
+    GSSK_Free(inst);
+    printf("  Ensemble sampling test PASSED\n");
+}
+
+void test_ensemble_compare() {
+    printf("Testing Scenario Comparison (CRN / Antithetic)...\n");
+
+    const char *base_json = "{"
+        "\"nodes\": ["
+        "  {\"id\": \"Source\", \"type\": \"source\", \"value\": 10.0},"
+        "  {\"id\": \"Stock\", \"type\": \"storage\", \"value\": 0.0},"
+        "  {\"id\": \"Sink\", \"type\": \"sink\", \"value\": 0.0}"
+        "],"
+        "\"edges\": ["
+        "  {\"origin\": \"Source\", \"target\": \"Stock\", \"logic\": \"linear\", \"params\": {\"k\": 1.0}},"
+        "  {\"origin\": \"Stock\", \"target\": \"Sink\", \"logic\": \"linear\", \"params\": {\"k\": 0.1}}"
+        "],"
+        "\"config\": {\"t_start\": 0, \"t_end\": 10, \"dt\": 0.5}"
+        "}";
+
+    GSSK_Instance *base = NULL, *policy = NULL;
+    assert(GSSK_Init(base_json, &base) == GSSK_SUCCESS);
+    assert(GSSK_Init(base_json, &policy) == GSSK_SUCCESS);
+    GSSK_SetEdgeK(policy, 1, 0.12); // Policy: slightly faster drawdown
+
+    GSSK_EnsembleOptions opts;
+    GSSK_InitEnsembleOptions(&opts);
+    opts.runs = 40;
+    opts.perturbation = 0.2;
+    opts.seed = 3;
+
+    GSSK_ScenarioDelta *crn = GSSK_EnsembleCompare(base, policy, &opts);
+    assert(crn != NULL);
+    assert(crn->node_count == 3 && crn->step_count == 21);
+    size_t idx = 20 * crn->node_count + 1; // Stock at t=10
+    printf("  CRN delta: %f +/- %f, variance reduction %.1fx\n",
+           crn->mean_delta[idx], crn->stderr_delta[idx],
+           crn->variance_reduction);
+    assert(crn->mean_delta[idx] < 0.0);
+    assert(crn->variance_reduction > 10.0);
+
+    opts.antithetic = true;
+    GSSK_ScenarioDelta *anti = GSSK_EnsembleCompare(base, policy, &opts);
+    assert(anti != NULL);
+    printf("  CRN+antithetic delta: %f +/- %f, variance reduction %.1fx\n",
+           anti->mean_delta[idx], anti->stderr_delta[idx],
+           anti->variance_reduction);
+    assert(anti->variance_reduction > crn->variance_reduction);
+    assert(fabs(anti->mean_delta[idx] - crn->mean_delta[idx]) <
+           4.0 * crn->stderr_delta[idx] + 1e-9);
+
+    // Instances are left untouched
+    assert(GSSK_GetEdgeK(base, 1) == 0.1);
+    assert(GSSK_GetEdgeK(policy, 1) == 0.12);
+
+    GSSK_FreeScenarioDelta(crn);
+    GSSK_FreeScenarioDelta(anti);
+    GSSK_Free(base);
+    GSSK_Free(policy);
+    printf("  Scenario comparison test PASSED\n");
+}
+
+void test_ensemble_session() {
+    printf("Testing Ensemble Sessions...\n");
+
+    const char *model_json = "{"
+        "\"nodes\": ["
+        "  {\"id\": \"Source\", \"type\": \"source\", \"value\": 10.0},"
+        "  {\"id\": \"Stock\", \"type\": \"storage\", \"value\": 0.0}"
+        "],"
+        "\"edges\": ["
+        "  {\"origin\": \"Source\", \"target\": \"Stock\", \"logic\": \"linear\", \"params\": {\"k\": 1.0}}"
+        "],"
+        "\"config\": {\"t_start\": 0, \"t_end\": 10, \"dt\": 1.0}"
+        "}";
+
+    GSSK_Instance *inst = NULL;
+    assert(GSSK_Init(model_json, &inst) == GSSK_SUCCESS);
+
+    GSSK_EnsembleOptions opts;
+    GSSK_InitEnsembleOptions(&opts);
+    opts.runs = 50;
+    opts.perturbation = 0.2;
+    opts.sampling = GSSK_SAMPLING_SOBOL;
+    opts.band_quantile = 0.05;
+    opts.seed = 5;
+
+    // Two batches of 50 match a single forecast of 100 with the same seed
+    GSSK_EnsembleSession *session = GSSK_EnsembleSessionCreate(inst, &opts);
+    assert(session != NULL);
+    assert(GSSK_EnsembleSessionAdd(session, 50) == GSSK_SUCCESS);
+    assert(GSSK_EnsembleSessionAdd(session, 50) == GSSK_SUCCESS);
+    assert(GSSK_EnsembleSessionGetMembers(session) == 100);
+    GSSK_EnsembleResult *inc = GSSK_EnsembleSessionGetResult(session);
+
+    opts.runs = 100;
+    GSSK_EnsembleResult *once = GSSK_EnsembleForecastEx(inst, &opts);
+    assert(inc && once);
+    size_t idx = 10 * 2 + 1;
+    assert(inc->runs == 100 && once->runs == 100);
+    assert(fabs(inc->mean_envelope[idx] - once->mean_envelope[idx]) < 1e-9);
+    assert(inc->lower_band && inc->upper_band);
+    printf("  t=10 90%% band: [%f, %f]\n", inc->lower_band[idx],
+           inc->upper_band[idx]);
+    // Factor ~ U[0.8, 1.2]: the 5%/95% quantiles are 82 and 118
+    assert(fabs(inc->lower_band[idx] - 82.0) < 1.5);
+    assert(fabs(inc->upper_band[idx] - 118.0) < 1.5);
+    GSSK_FreeEnsembleResult(inc);
+    GSSK_FreeEnsembleResult(once);
+    GSSK_EnsembleSessionFree(session);
+
+    // Auto mode stops on tolerance, or reports the exhausted budget
+    opts.runs = 32;
+    session = GSSK_EnsembleSessionCreate(inst, &opts);
+    double err = 0.0;
+    GSSK_Status status =
+        GSSK_EnsembleSessionRunUntilConverged(session, 0.01, 0, 10.0, &err);
+    printf("  Converged after %zu members (error %g)\n",
+           GSSK_EnsembleSessionGetMembers(session), err);
+    assert(status == GSSK_SUCCESS && err <= 0.01);
+    GSSK_EnsembleSessionFree(session);
+
+    session = GSSK_EnsembleSessionCreate(inst, &opts);
+    status = GSSK_EnsembleSessionRunUntilConverged(session, 1e-9, 64, 0.0, &err);
+    assert(status == GSSK_ERR_NOT_CONVERGED);
+    assert(GSSK_EnsembleSessionGetMembers(session) == 64);
+    GSSK_EnsembleSessionFree(session);
+
+    // One batch already pins the mean, but the bands have nothing to be
+    // compared with yet, so convergence needs a second batch
+    opts.runs = 200;
+    opts.band_quantile = 0.0;
+    session = GSSK_EnsembleSessionCreate(inst, &opts);
+    status = GSSK_EnsembleSessionRunUntilConverged(session, 0.02, 0, 0.0, &err);
+    assert(status == GSSK_SUCCESS);
+    assert(GSSK_EnsembleSessionGetMembers(session) == 200);
+    GSSK_EnsembleSessionFree(session);
+
+    opts.band_quantile = 0.05;
+    session = GSSK_EnsembleSessionCreate(inst, &opts);
+    status =
+        GSSK_EnsembleSessionRunUntilConverged(session, 0.02, 200, 0.0, &err);
+    assert(status == GSSK_ERR_NOT_CONVERGED && isinf(err));
+    status = GSSK_EnsembleSessionRunUntilConverged(session, 0.02, 0, 0.0, &err);
+    printf("  With bands: converged after %zu members (error %g)\n",
+           GSSK_EnsembleSessionGetMembers(session), err);
+    assert(status == GSSK_SUCCESS && err <= 0.02);
+    assert(GSSK_EnsembleSessionGetMembers(session) > 200);
+    GSSK_EnsembleSessionFree(session);
+
+    // Five members are still raw samples: the 5%/95% bands are their extremes
+    session = GSSK_EnsembleSessionCreate(inst, &opts);
+    assert(GSSK_EnsembleSessionAdd(session, 5) == GSSK_SUCCESS);
+    GSSK_EnsembleResult *five = GSSK_EnsembleSessionGetResult(session);
+    assert(five && five->runs == 5);
+    assert(five->lower_band[idx] == five->min_envelope[idx]);
+    assert(five->upper_band[idx] == five->max_envelope[idx]);
+    assert(five->lower_band[idx] < five->upper_band[idx]);
+    GSSK_FreeEnsembleResult(five);
+    GSSK_EnsembleSessionFree(session);
+
+    GSSK_Free(inst);
+    printf("  Ensemble session test PASSED\n");
+}
+
+typedef struct {
+    size_t calls;
+    size_t last_done;
+    double last_best;
+    double best_k[2];
+    size_t cancel_at;
+    int cancel;
+} ControlProbe;
+
+static void control_progress(const GSSK_Progress *p, void *user_data) {
+    ControlProbe *probe = user_data;
+    assert(p->done > probe->last_done && p->done <= p->total);
+    assert(!(p->best_fitness > probe->last_best));
+    probe->calls++;
+    probe->last_done = p->done;
+    probe->last_best = p->best_fitness;
+    if (p->best_k)
+        memcpy(probe->best_k, p->best_k, sizeof(probe->best_k));
+    if (probe->cancel_at > 0 && p->done >= probe->cancel_at)
+        probe->cancel = 1;
+}
+
+void test_control() {
+    printf("Testing Progress and Cancellation...\n");
+
+    const char *model_json = "{"
+        "\"nodes\": ["
+        "  {\"id\": \"A\", \"type\": \"source\", \"value\": 10.0},"
+        "  {\"id\": \"B\", \"type\": \"storage\", \"value\": 0.0},"
+        "  {\"id\": \"C\", \"type\": \"sink\", \"value\": 0.0}"
+        "],"
+        "\"edges\": ["
+        "  {\"origin\": \"A\", \"target\": \"B\", \"logic\": \"linear\", \"params\": {\"k\": 0.8}},"
+        "  {\"origin\": \"B\", \"target\": \"C\", \"logic\": \"linear\", \"params\": {\"k\": 0.3}}"
+        "],"
+        "\"config\": {\"t_start\": 0, \"t_end\": 10, \"dt\": 0.1, \"method\": \"rk4\"}"
+        "}";
+
+    GSSK_Instance *inst = NULL;
+    assert(GSSK_Init(model_json, &inst) == GSSK_SUCCESS);
+    GSSK_Observation obs_data[10];
+    GSSK_Reset(inst);
+    for (int s = 1; s <= 100; s++) {
+        GSSK_Step(inst, 0.1);
+        if (s % 10 == 5)
+            obs_data[s / 10] = (GSSK_Observation){s * 0.1, GSSK_GetState(inst)[1]};
+    }
+    GSSK_NodeObservations node_obs = {.node_id = "B", .data = obs_data, .count = 10};
+
+    // Progress every 100 evaluations of a 1220-evaluation run, without
+    // changing its outcome
+    ControlProbe probe = {0, 0, INFINITY, {0, 0}, 0, 0};
+    GSSK_Control control = {control_progress, &probe, 100, &probe.cancel, 0.0};
+    GSSK_CalibrationOptions opts;
+    GSSK_InitCalibrationOptions(&opts);
+    opts.iterations = 60;
+    opts.k_max = 2.0;
+    opts.seed = 32;
+    opts.threads = 4;
+    GSSK_CalibrationReport plain, report;
+    assert(GSSK_CalibrateEx(inst, &node_obs, 1, &opts, &plain) == GSSK_SUCCESS);
+    opts.control = &control;
+    assert(GSSK_CalibrateEx(inst, &node_obs, 1, &opts, &report) == GSSK_SUCCESS);
+    assert(probe.calls == 12 && probe.last_done == 1200);
+    assert(report.best_fitness == plain.best_fitness);
+
+    // Cancelling from the callback keeps the best k's reported so far
+    probe = (ControlProbe){0, 0, INFINITY, {0, 0}, 300, 0};
+    assert(GSSK_CalibrateEx(inst, &node_obs, 1, &opts, &report) ==
+           GSSK_ERR_CANCELLED);
+    printf("  Cancelled after %zu evaluations: MSE %g, k = (%f, %f)\n",
+           report.evaluations, report.best_fitness, GSSK_GetEdgeK(inst, 0),
+           GSSK_GetEdgeK(inst, 1));
+    assert(report.evaluations == 300 && report.generations == 14);
+    assert(report.best_fitness == probe.last_best);
+    assert(GSSK_GetEdgeK(inst, 0) == probe.best_k[0]);
+    assert(GSSK_GetEdgeK(inst, 1) == probe.best_k[1]);
+
+    // Every optimizer honours a spent time budget, leaving the k's alone
+    GSSK_Optimizer optimizers[] = {GSSK_OPTIMIZER_DE, GSSK_OPTIMIZER_SHADE,
+                                   GSSK_OPTIMIZER_CMAES, GSSK_OPTIMIZER_BAYES};
+    control = (GSSK_Control){NULL, NULL, 0, NULL, 1e-12};
+    GSSK_SetEdgeK(inst, 0, 0.5);
+    for (int o = 0; o < 4; o++) {
+        opts.optimizer = optimizers[o];
+        assert(GSSK_CalibrateEx(inst, &node_obs, 1, &opts, &report) ==
+               GSSK_ERR_CANCELLED);
+        assert(report.evaluations == 0 && isinf(report.best_fitness));
+        assert(GSSK_GetEdgeK(inst, 0) == 0.5);
+    }
+
+    // A cancelled ensemble returns the members it completed
+    probe = (ControlProbe){0, 0, INFINITY, {0, 0}, 30, 0};
+    control = (GSSK_Control){control_progress, &probe, 10, &probe.cancel, 0.0};
+    GSSK_EnsembleOptions ens;
+    GSSK_InitEnsembleOptions(&ens);
+    ens.runs = 100;
+    ens.seed = 9;
+    ens.control = &control;
+    GSSK_EnsembleResult *res = GSSK_EnsembleForecastEx(inst, &ens);
+    assert(res && res->runs == 30 && probe.calls == 3);
+    GSSK_FreeEnsembleResult(res);
+
+    // Nothing to return once the budget is spent before the first member
+    control = (GSSK_Control){NULL, NULL, 0, NULL, 1e-12};
+    assert(GSSK_EnsembleForecastEx(inst, &ens) == NULL);
+    GSSK_Free(inst);
+    printf("  Control test PASSED\n");
+}
+
+// Twin experiment: observations of the true model stream in one time unit
+// at a time, and the filter starts from a wrong outflow k
+static GSSK_EnKF *run_enkf(GSSK_Instance *inst, const double *truth,
+                           size_t threads, double *cycle_ms) {
+    size_t edges[1] = {1};
+    GSSK_EnKFOptions opts;
+    GSSK_InitEnKFOptions(&opts);
+    opts.ensemble.perturbation = 0.5;
+    opts.ensemble.seed = 21;
+    opts.estimate_k = true;
+    opts.edges = edges;
+    opts.param_count = 1;
+    opts.obs_relative_error = 0.02;
+    opts.threads = threads;
+    GSSK_EnKF *filter = GSSK_EnKFCreate(inst, &opts);
+    assert(filter != NULL);
+
+    double slowest = 0.0;
+    for (int t = 1; t <= 10; t++) {
+        GSSK_Observation stock = {(double)t, truth[2 * t]};
+        GSSK_Observation sink = {(double)t, truth[2 * t + 1]};
+        GSSK_NodeObservations obs[2] = {{"Stock", &stock, 1},
+                                        {"Sink", &sink, 1}};
+        clock_t start = clock();
+        assert(GSSK_EnKFAssimilate(filter, obs, 2) == GSSK_SUCCESS);
+        double ms = 1000.0 * (double)(clock() - start) / CLOCKS_PER_SEC;
+        if (ms > slowest)
+            slowest = ms;
+    }
+    if (cycle_ms)
+        *cycle_ms = slowest;
+    return filter;
+}
+
+void test_enkf() {
+    printf("Testing Ensemble Kalman Filter...\n");
+
+    const char *model_json = "{"
+        "\"nodes\": ["
+        "  {\"id\": \"Source\", \"type\": \"source\", \"value\": 10.0},"
+        "  {\"id\": \"Stock\", \"type\": \"storage\", \"value\": 0.0},"
+        "  {\"id\": \"Sink\", \"type\": \"sink\", \"value\": 0.0}"
+        "],"
+        "\"edges\": ["
+        "  {\"origin\": \"Source\", \"target\": \"Stock\", \"logic\": \"linear\", \"params\": {\"k\": 1.0}},"
+        "  {\"origin\": \"Stock\", \"target\": \"Sink\", \"logic\": \"linear\", \"params\": {\"k\": 0.2}}"
+        "],"
+        "\"config\": {\"t_start\": 0, \"t_end\": 10, \"dt\": 0.1, \"method\": \"rk4\"}"
+        "}";
+
+    GSSK_Instance *inst = NULL;
+    assert(GSSK_Init(model_json, &inst) == GSSK_SUCCESS);
+
+    // Stock and Sink of the true model at t = 0, 1, ..., 10
+    double truth[22];
+    for (int t = 0; t <= 10; t++) {
+        truth[2 * t] = GSSK_GetState(inst)[1];
+        truth[2 * t + 1] = GSSK_GetState(inst)[2];
+        for (int s = 0; s < 10; s++)
+            GSSK_Step(inst, 0.1);
+    }
+    GSSK_SetEdgeK(inst, 1, 0.3);
+
+    double cycle_ms = 0.0;
+    GSSK_EnKF *filter = run_enkf(inst, truth, 0, &cycle_ms);
+    assert(fabs(GSSK_EnKFGetTime(filter) - 10.0) < 1e-9);
+    double mean[3], sd[3], k[2], k_sd[2];
+    GSSK_EnKFGetState(filter, mean, sd);
+    GSSK_EnKFGetK(filter, k, k_sd);
+    printf("  100 members, slowest cycle %.3f ms\n", cycle_ms);
+    printf("  Stock(10) %f +/- %f (truth %f), k1 %f +/- %f (prior 0.3)\n",
+           mean[1], sd[1], truth[20], k[1], k_sd[1]);
+    assert(fabs(mean[1] - truth[20]) < 0.02 * truth[20]);
+    assert(fabs(k[1] - 0.2) < 0.02);
+    assert(k_sd[1] < 0.05);
+    assert(GSSK_GetEdgeK(inst, 1) == 0.3); // Instance left unchanged
+
+    // The update does not depend on the thread count
+    GSSK_EnKF *serial = run_enkf(inst, truth, 1, NULL);
+    double serial_mean[3], serial_k[2];
+    GSSK_EnKFGetState(serial, serial_mean, NULL);
+    GSSK_EnKFGetK(serial, serial_k, NULL);
+    assert(memcmp(mean, serial_mean, sizeof(mean)) == 0);
+    assert(memcmp(k, serial_k, sizeof(k)) == 0);
+    GSSK_EnKFFree(serial);
+
+    // Forecast past t_end, and reject observations from the past
+    assert(GSSK_EnKFAdvance(filter, 12.0) == GSSK_SUCCESS);
+    GSSK_EnKFGetState(filter, mean, NULL);
+    assert(mean[1] > 0.0 && fabs(GSSK_EnKFGetTime(filter) - 12.0) < 1e-9);
+    GSSK_Observation late = {11.0, 40.0};
+    GSSK_NodeObservations past = {"Stock", &late, 1};
+    assert(GSSK_EnKFAssimilate(filter, &past, 1) == GSSK_ERR_UNKNOWN);
+    past.node_id = "Missing";
+    late.time = 13.0;
+    assert(GSSK_EnKFAssimilate(filter, &past, 1) == GSSK_ERR_UNKNOWN);
+    assert(GSSK_EnKFAdvance(filter, 11.0) == GSSK_ERR_UNKNOWN);
+
+    GSSK_EnKFFree(filter);
+    GSSK_Free(inst);
+    printf("  EnKF test PASSED\n");
+}
+
+void test_pce() {
+    printf("Testing Polynomial Chaos Expansion...\n");
+
+    const char *model_json = "{"
+        "\"nodes\": ["
+        "  {\"id\": \"Source\", \"type\": \"source\", \"value\": 10.0},"
+        "  {\"id\": \"Stock\", \"type\": \"storage\", \"value\": 0.0},"
+        "  {\"id\": \"Sink\", \"type\": \"sink\", \"value\": 0.0}"
+        "],"
+        "\"edges\": ["
+        "  {\"origin\": \"Source\", \"target\": \"Stock\", \"logic\": \"linear\", \"params\": {\"k\": 1.0}},"
+        "  {\"origin\": \"Stock\", \"target\": \"Sink\", \"logic\": \"linear\", \"params\": {\"k\": 0.2}}"
+        "],"
+        "\"config\": {\"t_start\": 0, \"t_end\": 10, \"dt\": 0.1, \"method\": \"rk4\"}"
+        "}";
+
+    GSSK_Instance *inst = NULL;
+    assert(GSSK_Init(model_json, &inst) == GSSK_SUCCESS);
+
+    // Clones are independent of the original
+    GSSK_Instance *copy = NULL;
+    assert(GSSK_Clone(inst, &copy) == GSSK_SUCCESS);
+    GSSK_SetEdgeK(copy, 0, 3.0);
+    GSSK_Step(copy, 0.1);
+    assert(GSSK_GetEdgeK(inst, 0) == 1.0);
+    assert(GSSK_GetState(inst)[1] == 0.0 && GSSK_GetState(copy)[1] > 0.0);
+    GSSK_Free(copy);
+
+    GSSK_PCEOptions opts;
+    GSSK_InitPCEOptions(&opts);
+    opts.perturbation = 0.3;
+    opts.order = 4;
+    opts.threads = 4;
+
+    GSSK_PCEResult *pce = NULL;
+    assert(GSSK_PCEBuild(inst, &opts, &pce) == GSSK_SUCCESS);
+    assert(pce->param_count == 2 && pce->term_count == 15);
+    size_t cells = pce->node_count * pce->step_count;
+    size_t idx = 100 * pce->node_count + 1; // Stock at t=10
+    printf("  %zu terms, Stock(10) mean %f, std %f\n", pce->term_count,
+           pce->mean[idx], sqrt(pce->variance[idx]));
+
+    // Mean agrees with a large quasi-random ensemble
+    GSSK_EnsembleOptions eopts;
+    GSSK_InitEnsembleOptions(&eopts);
+    eopts.runs = 4096;
+    eopts.perturbation = 0.3;
+    eopts.sampling = GSSK_SAMPLING_SOBOL;
+    eopts.seed = 9;
+    GSSK_EnsembleResult *mc = GSSK_EnsembleForecastEx(inst, &eopts);
+    assert(mc != NULL);
+    assert(fabs(pce->mean[idx] - mc->mean_envelope[idx]) <
+           1e-3 * mc->mean_envelope[idx]);
+    GSSK_FreeEnsembleResult(mc);
+
+    // Sobol indices: inflow k dominates, totals bound first-order effects
+    double s0 = pce->sobol_first[idx * 2], s1 = pce->sobol_first[idx * 2 + 1];
+    printf("  Sobol first-order: k0 %f, k1 %f\n", s0, s1);
+    assert(s0 > s1);
+    assert(s0 <= pce->sobol_total[idx * 2] + 1e-12);
+    assert(s0 + s1 <= 1.0 + 1e-9);
+
+    // Surrogate evaluation matches a direct simulation
+    double k_new[2] = {1.15, 0.17};
+    double *surrogate = malloc(cells * sizeof(double));
+    assert(GSSK_PCEEvaluate(pce, k_new, surrogate) == GSSK_SUCCESS);
+    GSSK_SetEdgeK(inst, 0, k_new[0]);
+    GSSK_SetEdgeK(inst, 1, k_new[1]);
+    GSSK_Reset(inst);
+    for (int s = 0; s < 100; s++)
+        GSSK_Step(inst, 0.1);
+    printf("  Surrogate %f vs simulated %f\n", surrogate[idx],
+           GSSK_GetState(inst)[1]);
+    assert(fabs(surrogate[idx] - GSSK_GetState(inst)[1]) < 0.01);
+
+    free(surrogate);
+    GSSK_FreePCEResult(pce);
+    GSSK_Free(inst);
+    printf("  PCE test PASSED\n");
+}
+
+void test_global_sensitivity() {
+    printf("Testing Global Sensitivity Analysis...\n");
+
+    // The third edge drains the sink, so it cannot affect the stock
+    const char *model_json = "{"
+        "\"nodes\": ["
+        "  {\"id\": \"Source\", \"type\": \"source\", \"value\": 10.0},"
+        "  {\"id\": \"Stock\", \"type\": \"storage\", \"value\": 0.0},"
+        "  {\"id\": \"Sink\", \"type\": \"storage\", \"value\": 0.0},"
+        "  {\"id\": \"Waste\", \"type\": \"sink\", \"value\": 0.0}"
+        "],"
+        "\"edges\": ["
+        "  {\"origin\": \"Source\", \"target\": \"Stock\", \"logic\": \"linear\", \"params\": {\"k\": 1.0}},"
+        "  {\"origin\": \"Stock\", \"target\": \"Sink\", \"logic\": \"linear\", \"params\": {\"k\": 0.2}},"
+        "  {\"origin\": \"Sink\", \"target\": \"Waste\", \"logic\": \"linear\", \"params\": {\"k\": 0.5}}"
+        "],"
+        "\"config\": {\"t_start\": 0, \"t_end\": 10, \"dt\": 0.1, \"method\": \"rk4\"}"
+        "}";
+
+    GSSK_Instance *inst = NULL;
+    assert(GSSK_Init(model_json, &inst) == GSSK_SUCCESS);
+
+    size_t nodes[1] = {1};
+    double times[2] = {10.0, 5.0};
+    GSSK_GlobalSensitivityOptions opts;
+    GSSK_InitGlobalSensitivityOptions(&opts);
+    opts.nodes = nodes;
+    opts.node_count = 1;
+    opts.times = times;
+    opts.time_count = 2;
+    opts.perturbation = 0.3;
+    opts.seed = 11;
+    opts.threads = 1;
+
+    // Morris screening separates the irrelevant k
+    GSSK_GlobalSensitivityResult *morris = NULL;
+    assert(GSSK_GlobalSensitivities(inst, &opts, &morris) == GSSK_SUCCESS);
+    assert(morris->param_count == 3 && morris->evaluations == 20 * 4);
+    assert(fabs(morris->times[0] - 10.0) < 1e-9);
+    printf("  Morris mu* at t=10: k0 %f [%f, %f], k1 %f, k2 %f\n",
+           morris->mu_star[0], morris->mu_star_lo[0], morris->mu_star_hi[0],
+           morris->mu_star[1], morris->mu_star[2]);
+    assert(morris->mu_star[0] > morris->mu_star[1]);
+    assert(morris->mu_star[1] > 0.0 && morris->mu[1] < 0.0);
+    assert(morris->peak[2] == 0.0 && morris->sigma[2] == 0.0);
+    assert(morris->mu_star_lo[0] <= morris->mu_star[0] &&
+           morris->mu_star[0] <= morris->mu_star_hi[0]);
+    assert(morris->first == NULL && morris->total == NULL);
+
+    // Sobol indices agree with the PCE decomposition of the same model
+    opts.method = GSSK_GSA_SOBOL;
+    opts.samples = 1024;
+    GSSK_GlobalSensitivityResult *sobol = NULL;
+    assert(GSSK_GlobalSensitivities(inst, &opts, &sobol) == GSSK_SUCCESS);
+    assert(sobol->evaluations == 1024 * 5 && sobol->mu_star == NULL);
+    printf("  Sobol at t=10: first k0 %f [%f, %f], k1 %f, total k2 %f\n",
+           sobol->first[0], sobol->first_lo[0], sobol->first_hi[0],
+           sobol->first[1], sobol->total[2]);
+    assert(sobol->first[0] > sobol->first[1]);
+    assert(sobol->first_lo[0] <= sobol->first[0] &&
+           sobol->first[0] <= sobol->first_hi[0]);
+    assert(sobol->total[2] == 0.0 && sobol->peak[2] == 0.0);
+
+    GSSK_PCEOptions popts;
+    GSSK_InitPCEOptions(&popts);
+    popts.perturbation = 0.3;
+    popts.order = 4;
+    size_t edges[2] = {0, 1};
+    GSSK_PCEResult *pce = NULL;
+    popts.edges = edges;
+    popts.param_count = 2;
+    assert(GSSK_PCEBuild(inst, &popts, &pce) == GSSK_SUCCESS);
+    size_t idx = 100 * pce->node_count + 1;
+    for (size_t i = 0; i < 2; i++) {
+        assert(fabs(sobol->first[i] - pce->sobol_first[idx * 2 + i]) < 0.05);
+        assert(fabs(sobol->total[i] - pce->sobol_total[idx * 2 + i]) < 0.05);
+    }
+    GSSK_FreePCEResult(pce);
+
+    // Results do not depend on the thread count
+    opts.threads = 4;
+    GSSK_GlobalSensitivityResult *parallel = NULL;
+    assert(GSSK_GlobalSensitivities(inst, &opts, &parallel) == GSSK_SUCCESS);
+    for (size_t c = 0; c < 2 * 3; c++) {
+        assert(parallel->first[c] == sobol->first[c]);
+        assert(parallel->total_hi[c] == sobol->total_hi[c]);
+    }
+    GSSK_FreeGlobalSensitivityResult(parallel);
+
+    // Invalid output selections are rejected
+    times[1] = 11.0;
+    assert(GSSK_GlobalSensitivities(inst, &opts, &parallel) == GSSK_ERR_UNKNOWN);
+    assert(parallel == NULL);
+    times[1] = 5.0;
+    nodes[0] = 4;
+    assert(GSSK_GlobalSensitivities(inst, &opts, &parallel) == GSSK_ERR_UNKNOWN);
+
+    GSSK_FreeGlobalSensitivityResult(sobol);
+    GSSK_FreeGlobalSensitivityResult(morris);
+    GSSK_Free(inst);
+    printf("  Global sensitivity test PASSED\n");
+}
+
+void test_unscented() {
+    printf("Testing Unscented Forecast...\n");
+
+    const char *model_json = "{"
+        "\"nodes\": ["
+        "  {\"id\": \"Source\", \"type\": \"source\", \"value\": 10.0},"
+        "  {\"id\": \"Stock\", \"type\": \"storage\", \"value\": 0.0},"
+        "  {\"id\": \"Sink\", \"type\": \"sink\", \"value\": 0.0}"
+        "],"
+        "\"edges\": ["
+        "  {\"origin\": \"Source\", \"target\": \"Stock\", \"logic\": \"linear\", \"params\": {\"k\": 1.0}},"
+        "  {\"origin\": \"Stock\", \"target\": \"Sink\", \"logic\": \"linear\", \"params\": {\"k\": 0.2}}"
+        "],"
+        "\"config\": {\"t_start\": 0, \"t_end\": 10, \"dt\": 0.1, \"method\": \"rk4\"}"
+        "}";
+
+    GSSK_Instance *inst = NULL;
+    assert(GSSK_Init(model_json, &inst) == GSSK_SUCCESS);
+    size_t idx = 100 * 3 + 1; // Stock at t=10
+
+    // Inflow only: Stock(10) is linear in k0, so the transform is exact
+    size_t inflow = 0;
+    GSSK_UnscentedOptions opts;
+    GSSK_InitUnscentedOptions(&opts);
+    opts.edges = &inflow;
+    opts.param_count = 1;
+    opts.perturbation = 0.3;
+    opts.covariance = true;
+    GSSK_EnsembleResult *lin = GSSK_UnscentedForecast(inst, &opts);
+    assert(lin != NULL && lin->runs == 3);
+    GSSK_UnscentedOptions ref_opts = opts;
+    GSSK_PCEOptions popts;
+    GSSK_InitPCEOptions(&popts);
+    popts.edges = &inflow;
+    popts.param_count = 1;
+    popts.perturbation = 0.3;
+    popts.order = 2;
+    GSSK_PCEResult *ref = NULL;
+    assert(GSSK_PCEBuild(inst, &popts, &ref) == GSSK_SUCCESS);
+    assert(fabs(lin->mean_envelope[idx] - ref->mean[idx]) < 1e-6);
+    assert(fabs(lin->std_envelope[idx] - sqrt(ref->variance[idx])) < 1e-6);
+    assert(fabs(lin->max_envelope[idx] - lin->mean_envelope[idx] -
+                lin->std_envelope[idx]) < 1e-9);
+    // Per-step covariance diagonal matches the variance
+    double var = lin->covariance[100 * 9 + 1 * 3 + 1];
+    assert(fabs(var - lin->std_envelope[idx] * lin->std_envelope[idx]) < 1e-6);
+    GSSK_FreePCEResult(ref);
+    GSSK_FreeEnsembleResult(lin);
+
+    // Both edges: 5 runs approximate a high-order PCE reference
+    ref_opts.edges = NULL;
+    ref_opts.covariance = false;
+    GSSK_EnsembleResult *ut = GSSK_UnscentedForecast(inst, &ref_opts);
+    assert(ut != NULL && ut->runs == 5);
+    popts.edges = NULL;
+    popts.order = 5;
+    assert(GSSK_PCEBuild(inst, &popts, &ref) == GSSK_SUCCESS);
+    printf("  Stock(10): UT %f +/- %f, PCE %f +/- %f\n",
+           ut->mean_envelope[idx], ut->std_envelope[idx], ref->mean[idx],
+           sqrt(ref->variance[idx]));
+    assert(fabs(ut->mean_envelope[idx] - ref->mean[idx]) < 0.01 * ref->mean[idx]);
+    assert(fabs(ut->std_envelope[idx] - sqrt(ref->variance[idx])) <
+           0.05 * sqrt(ref->variance[idx]));
+    assert(GSSK_GetEdgeK(inst, 1) == 0.2);
+
+    GSSK_FreePCEResult(ref);
+    GSSK_FreeEnsembleResult(ut);
+    GSSK_Free(inst);
+    printf("  Unscented forecast test PASSED\n");
+}
+
+void test_interval() {
+    printf("Testing Interval Forecast...\n");
+
+    const char *chain_json = "{"
+        "\"nodes\": ["
+        "  {\"id\": \"Source\", \"type\": \"source\", \"value\": 10.0},"
+        "  {\"id\": \"Stock\", \"type\": \"storage\", \"value\": 0.0},"
+        "  {\"id\": \"Sink\", \"type\": \"sink\", \"value\": 0.0}"
+        "],"
+        "\"edges\": ["
+        "  {\"origin\": \"Source\", \"target\": \"Stock\", \"logic\": \"linear\", \"params\": {\"k\": 1.0}},"
+        "  {\"origin\": \"Stock\", \"target\": \"Sink\", \"logic\": \"linear\", \"params\": {\"k\": 0.2}}"
+        "],"
+        "\"config\": {\"t_start\": 0, \"t_end\": 10, \"dt\": 0.1, \"method\": \"rk4\"}"
+        "}";
+
+    GSSK_Instance *inst = NULL;
+    assert(GSSK_Init(chain_json, &inst) == GSSK_SUCCESS);
+    size_t idx = 100 * 3 + 1; // Stock at t=10
+
+    GSSK_IntervalOptions opts;
+    GSSK_InitIntervalOptions(&opts);
+    opts.perturbation = 0.2;
+    GSSK_EnsembleResult *box = GSSK_IntervalForecast(inst, &opts);
+    assert(box != NULL && box->runs == 0);
+
+    // Stock's bounds are the extreme corners (slow inflow / fast outflow)
+    GSSK_SetEdgeK(inst, 0, 0.8);
+    GSSK_SetEdgeK(inst, 1, 0.24);
+    GSSK_Reset(inst);
+    for (int i = 0; i < 100; i++)
+        GSSK_Step(inst, 0.1);
+    assert(fabs(box->min_envelope[idx] - GSSK_GetState(inst)[1]) < 1e-9);
+    GSSK_SetEdgeK(inst, 0, 1.0);
+    GSSK_SetEdgeK(inst, 1, 0.2);
+    printf("  Stock(10): [%f, %f], nominal %f\n", box->min_envelope[idx],
+           box->max_envelope[idx], box->mean_envelope[idx]);
+    GSSK_FreeEnsembleResult(box);
+    GSSK_Free(inst);
+
+    // Nonlinear epidemic: the bounds enclose every sampled trajectory
+    const char *sir_json = "{"
+        "\"nodes\": ["
+        "  {\"id\": \"S\", \"type\": \"storage\", \"value\": 99.0},"
+        "  {\"id\": \"I\", \"type\": \"storage\", \"value\": 1.0},"
+        "  {\"id\": \"R\", \"type\": \"sink\", \"value\": 0.0}"
+        "],"
+        "\"edges\": ["
+        "  {\"origin\": \"S\", \"target\": \"I\", \"logic\": \"interaction\", \"params\": {\"k\": 0.004, \"control_node\": \"I\"}},"
+        "  {\"origin\": \"I\", \"target\": \"R\", \"logic\": \"linear\", \"params\": {\"k\": 0.1}}"
+        "],"
+        "\"config\": {\"t_start\": 0, \"t_end\": 20, \"dt\": 0.05, \"method\": \"rk4\"}"
+        "}";
+    assert(GSSK_Init(sir_json, &inst) == GSSK_SUCCESS);
+    opts.perturbation = 0.1;
+    box = GSSK_IntervalForecast(inst, &opts);
+    assert(box != NULL);
+
+    GSSK_EnsembleOptions eopts;
+    GSSK_InitEnsembleOptions(&eopts);
+    eopts.runs = 200;
+    eopts.perturbation = 0.1;
+    eopts.seed = 31;
+    GSSK_EnsembleResult *ens = GSSK_EnsembleForecastEx(inst, &eopts);
+    assert(ens != NULL);
+    for (size_t c = 0; c < box->node_count * box->step_count; c++) {
+        assert(box->min_envelope[c] <= ens->min_envelope[c] + 1e-9);
+        assert(box->max_envelope[c] >= ens->max_envelope[c] - 1e-9);
+    }
+
+    // Explicit bounds on a single edge; the other k stays fixed
+    size_t infection = 0;
+    double k_lo = 0.004, k_hi = 0.004;
+    opts.edges = &infection;
+    opts.param_count = 1;
+    opts.k_lower = &k_lo;
+    opts.k_upper = &k_hi;
+    GSSK_EnsembleResult *point = GSSK_IntervalForecast(inst, &opts);
+    assert(point != NULL);
+    for (size_t c = 0; c < point->node_count * point->step_count; c++) {
+        assert(fabs(point->min_envelope[c] - point->mean_envelope[c]) < 1e-9);
+        assert(fabs(point->max_envelope[c] - point->mean_envelope[c]) < 1e-9);
+    }
+
+    GSSK_FreeEnsembleResult(point);
+    GSSK_FreeEnsembleResult(ens);
+    GSSK_FreeEnsembleResult(box);
+    GSSK_Free(inst);
+    printf("  Interval forecast test PASSED\n");
+}
+
+void test_workspace() {
+    printf("Testing Workspaces...\n");
+
+    const char *model_json = "{"
+        "\"nodes\": ["
+        "  {\"id\": \"A\", \"type\": \"source\", \"value\": 10.0},"
+        "  {\"id\": \"B\", \"type\": \"storage\", \"value\": 0.0},"
+        "  {\"id\": \"C\", \"type\": \"sink\", \"value\": 0.0}"
+        "],"
+        "\"edges\": ["
+        "  {\"origin\": \"A\", \"target\": \"B\", \"logic\": \"linear\", \"params\": {\"k\": 0.8}},"
+        "  {\"origin\": \"B\", \"target\": \"C\", \"logic\": \"linear\", \"params\": {\"k\": 0.3}}"
+        "],"
+        "\"config\": {\"t_start\": 0, \"t_end\": 10, \"dt\": 0.1, \"method\": \"rk4\"}"
+        "}";
+
+    GSSK_Instance *inst = NULL;
+    assert(GSSK_Init(model_json, &inst) == GSSK_SUCCESS);
+    GSSK_Observation obs_data[] = {{2.5, 12.0}, {5.0, 20.0}, {7.5, 24.0}};
+    GSSK_NodeObservations node_obs = {.node_id = "B", .data = obs_data, .count = 3};
+
+    GSSK_Workspace *ws = GSSK_WorkspaceCreate(inst);
+    assert(ws != NULL);
+
+    // Reference run on the heap
+    GSSK_CalibrationOptions opts;
+    GSSK_InitCalibrationOptions(&opts);
+    opts.iterations = 30;
+    opts.seed = 36;
+    opts.threads = 2;
+    assert(GSSK_CalibrateEx(inst, &node_obs, 1, &opts, NULL) == GSSK_SUCCESS);
+    double k0 = GSSK_GetEdgeK(inst, 0);
+
+    // Warm the workspace, then a full calibration allocates nothing
+    opts.workspace = ws;
+    assert(GSSK_CalibrateEx(inst, &node_obs, 1, &opts, NULL) == GSSK_SUCCESS);
+    size_t before = alloc_count;
+    assert(GSSK_CalibrateEx(inst, &node_obs, 1, &opts, NULL) == GSSK_SUCCESS);
+    size_t calibrate_allocs = alloc_count - before;
+    assert(!alloc_counted || calibrate_allocs == 0);
+    assert(GSSK_GetEdgeK(inst, 0) == k0);
+
+    // Ensembles only allocate their result, however many members they run
+    GSSK_EnsembleOptions eopts;
+    GSSK_InitEnsembleOptions(&eopts);
+    eopts.sampling = GSSK_SAMPLING_SOBOL;
+    eopts.band_quantile = 0.05;
+    eopts.seed = 36;
+    eopts.workspace = ws;
+    GSSK_FreeEnsembleResult(GSSK_EnsembleForecastEx(inst, &eopts));
+    size_t ensemble_allocs[2];
+    size_t runs[2] = {50, 400};
+    for (int i = 0; i < 2; i++) {
+        eopts.runs = runs[i];
+        before = alloc_count;
+        GSSK_EnsembleResult *res = GSSK_EnsembleForecastEx(inst, &eopts);
+        ensemble_allocs[i] = alloc_count - before;
+        assert(res != NULL && res->runs == runs[i]);
+        GSSK_FreeEnsembleResult(res);
+    }
+    assert(ensemble_allocs[0] == ensemble_allocs[1]);
+    assert(ensemble_allocs[0] <= 6);
+
+    if (alloc_counted)
+        printf("  Calibration: %zu allocations, ensemble: %zu (result only)\n",
+               calibrate_allocs, ensemble_allocs[0]);
+    else
+        printf("  Allocations not counted (linker without --wrap)\n");
+    GSSK_WorkspaceFree(ws);
+    GSSK_Free(inst);
+    printf("  Workspace test PASSED\n");
+}
+
 int main() {
     test_calibration();
+    test_calibration_parallel();
+    test_calibration_optimizers();
+    test_calibration_screening();
+    test_calibration_cache();
+    test_calibration_experiments();
+    test_calibration_session();
+    test_sensitivity_lm();
+    test_adjoint_lbfgs();
+    test_calibration_ranges();
+    test_calibration_mcmc();
     test_ensemble();
+    test_ensemble_sampling();
+    test_ensemble_compare();
+    test_ensemble_session();
+    test_control();
+    test_enkf();
+    test_pce();
+    test_global_sensitivity();
+    test_unscented();
+    test_interval();
+    test_workspace();
     return 0;
 }